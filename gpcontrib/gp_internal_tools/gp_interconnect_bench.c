@@ -0,0 +1,222 @@
+/*-------------------------------------------------------------------------
+ *
+ * gp_interconnect_bench.c
+ *    Synthetic source and sink of motion traffic, for benchmarking the
+ *    interconnect without reading or writing any table.
+ *
+ * Copyright (c) 2021-Present VMware, Inc. or its affiliates.
+ *
+ *-------------------------------------------------------------------------
+*/
+#include "postgres.h"
+#include "funcapi.h"
+#include "tablefuncapi.h"
+#include "access/htup_details.h"
+#include "cdb/cdbvars.h"
+#include "portability/instr_time.h"
+#include "utils/builtins.h"
+
+PG_MODULE_MAGIC;
+
+Datum		gp_ic_bench_source(PG_FUNCTION_ARGS);
+Datum		gp_ic_bench_sink(PG_FUNCTION_ARGS);
+
+PG_FUNCTION_INFO_V1(gp_ic_bench_source);
+PG_FUNCTION_INFO_V1(gp_ic_bench_sink);
+
+#define GP_IC_BENCH_SOURCE_NATTR 2
+#define GP_IC_BENCH_SINK_NATTR 4
+
+typedef struct BenchSourceState
+{
+	uint64		rows;			/* number of rows to return */
+	bytea	   *payload;		/* the payload shared by all the rows */
+} BenchSourceState;
+
+/*
+ * Generate synthetic rows to feed a motion
+ *
+ * ---------------------------------------------------------------------
+ * Interface to gp_ic_bench_source function.
+ *
+ * The gp_ic_bench_source function returns "rows" rows of (id, payload) on
+ * every segment it runs on.  The ids count up from 0, the payload is a bytea
+ * of "width" pseudo-random bytes, the same for all the rows, so generating a
+ * row costs next to nothing compared to sending it.  The bytes are random so
+ * that gp_interconnect_compression has nothing to gain.
+ *
+ * CREATE FUNCTION gp_ic_bench_source(rows int8, width int4)
+ *   RETURNS TABLE ( id int8
+ *                  ,payload bytea
+ *                 )
+ *   AS '$libdir/gp_interconnect_bench', 'gp_ic_bench_source'
+ *   LANGUAGE C VOLATILE EXECUTE ON ALL SEGMENTS;
+ */
+Datum
+gp_ic_bench_source(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *funcctx;
+	BenchSourceState *state;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		int64		rows = PG_GETARG_INT64(0);
+		int32		width = PG_GETARG_INT32(1);
+		MemoryContext oldcontext;
+		TupleDesc	tupdesc;
+		uint32		seed = 1;
+		char	   *data;
+
+		if (rows < 0)
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+					 errmsg("number of rows must not be negative")));
+		if (width < 0 || width > MaxAllocSize - VARHDRSZ)
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+					 errmsg("payload width must be between 0 and %d",
+							(int) (MaxAllocSize - VARHDRSZ))));
+
+		funcctx = SRF_FIRSTCALL_INIT();
+		oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+		if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+			elog(ERROR, "return type must be a row type");
+		if (tupdesc->natts != GP_IC_BENCH_SOURCE_NATTR)
+			elog(ERROR, "gp_ic_bench_source must return %d columns",
+				 GP_IC_BENCH_SOURCE_NATTR);
+		funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+
+		state = (BenchSourceState *) palloc(sizeof(BenchSourceState));
+		state->rows = (uint64) rows;
+		state->payload = (bytea *) palloc(VARHDRSZ + width);
+		SET_VARSIZE(state->payload, VARHDRSZ + width);
+
+		data = VARDATA(state->payload);
+		for (int i = 0; i < width; i++)
+		{
+			seed = seed * 1103515245 + 12345;
+			data[i] = (char) (seed >> 16);
+		}
+
+		funcctx->user_fctx = state;
+
+		MemoryContextSwitchTo(oldcontext);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+	state = (BenchSourceState *) funcctx->user_fctx;
+
+	if (funcctx->call_cntr < state->rows)
+	{
+		Datum		values[GP_IC_BENCH_SOURCE_NATTR];
+		bool		nulls[GP_IC_BENCH_SOURCE_NATTR];
+		HeapTuple	tuple;
+
+		values[0] = Int64GetDatum((int64) funcctx->call_cntr);
+		nulls[0] = false;
+		values[1] = PointerGetDatum(state->payload);
+		nulls[1] = false;
+
+		tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+
+		SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+	}
+
+	SRF_RETURN_DONE(funcctx);
+}
+
+/*
+ * Consume the rows coming out of a motion
+ *
+ * ---------------------------------------------------------------------
+ * Interface to gp_ic_bench_sink function.
+ *
+ * The gp_ic_bench_sink function is a table function, it reads all of its
+ * input and returns a single row with the number of tuples and bytes it got,
+ * and the time between the first tuple and the end of the input.  The input
+ * is usually scattered to it through a redistribute motion, e.g.
+ *
+ * SELECT * FROM gp_ic_bench_sink(TABLE(
+ *     SELECT * FROM gp_ic_bench_source(1000000, 100) SCATTER BY id));
+ *
+ * CREATE FUNCTION gp_ic_bench_sink(anytable)
+ *   RETURNS TABLE ( segid int4
+ *                  ,tuples int8
+ *                  ,bytes int8
+ *                  ,elapsed_us int8
+ *                 )
+ *   AS '$libdir/gp_interconnect_bench', 'gp_ic_bench_sink'
+ *   LANGUAGE C VOLATILE;
+ */
+Datum
+gp_ic_bench_sink(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *funcctx;
+	AnyTable	scan;
+	HeapTuple	tuple;
+	instr_time	start;
+	instr_time	elapsed;
+	int64		ntuples = 0;
+	int64		nbytes = 0;
+	Datum		values[GP_IC_BENCH_SINK_NATTR];
+	bool		nulls[GP_IC_BENCH_SINK_NATTR];
+
+	if (PG_NARGS() < 1 || PG_ARGISNULL(0))
+		elog(ERROR, "invalid invocation of gp_ic_bench_sink");
+	scan = PG_GETARG_ANYTABLE(0);
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		MemoryContext oldcontext;
+		TupleDesc	tupdesc;
+
+		funcctx = SRF_FIRSTCALL_INIT();
+		oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+		if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+			elog(ERROR, "return type must be a row type");
+		if (tupdesc->natts != GP_IC_BENCH_SINK_NATTR)
+			elog(ERROR, "gp_ic_bench_sink must return %d columns",
+				 GP_IC_BENCH_SINK_NATTR);
+		funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+
+		MemoryContextSwitchTo(oldcontext);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+
+	/* all the input is consumed on the first call */
+	if (funcctx->call_cntr > 0)
+		SRF_RETURN_DONE(funcctx);
+
+	INSTR_TIME_SET_ZERO(start);
+	INSTR_TIME_SET_ZERO(elapsed);
+
+	while ((tuple = AnyTable_GetNextTuple(scan)) != NULL)
+	{
+		if (ntuples == 0)
+			INSTR_TIME_SET_CURRENT(start);
+
+		ntuples++;
+		nbytes += tuple->t_len;
+
+		heap_freetuple(tuple);
+	}
+
+	if (ntuples > 0)
+	{
+		INSTR_TIME_SET_CURRENT(elapsed);
+		INSTR_TIME_SUBTRACT(elapsed, start);
+	}
+
+	MemSet(nulls, 0, sizeof(nulls));
+	values[0] = Int32GetDatum(GpIdentity.segindex);
+	values[1] = Int64GetDatum(ntuples);
+	values[2] = Int64GetDatum(nbytes);
+	values[3] = Int64GetDatum((int64) INSTR_TIME_GET_MICROSEC(elapsed));
+
+	tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+
+	SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+}
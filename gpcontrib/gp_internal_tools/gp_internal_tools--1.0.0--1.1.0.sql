@@ -0,0 +1,74 @@
+-- complain if script is sourced in psql, rather than via ALTER EXTENSION
+\echo Use "ALTER EXTENSION gp_internal_tools UPDATE TO '1.1.0'" to load this file. \quit
+
+
+--------------------------------------------------------------------------------
+--  Interconnect benchmark functions                                          --
+--------------------------------------------------------------------------------
+
+--------------------------------------------------------------------------------
+-- @function:
+--        gp_ic_bench_source
+--
+-- @in:
+--        int8 - number of rows to return on every segment,
+--        int4 - payload width in bytes
+--
+-- @out:
+--        int8 - row id, counting up from 0 on every segment,
+--        bytea - payload of pseudo-random bytes
+--
+-- @doc:
+--        UDF to generate synthetic rows to feed a motion
+--
+--------------------------------------------------------------------------------
+
+CREATE FUNCTION gp_ic_bench_source(rows int8, width int4)
+RETURNS TABLE (id int8, payload bytea)
+AS '$libdir/gp_interconnect_bench', 'gp_ic_bench_source'
+LANGUAGE C VOLATILE STRICT EXECUTE ON ALL SEGMENTS;
+
+--------------------------------------------------------------------------------
+-- @function:
+--        gp_ic_bench_anchor
+--
+-- @in:
+--
+-- @out:
+--        int8 - row id,
+--        bytea - empty payload
+--
+-- @doc:
+--        UDF returning one row on every segment while the planner expects a
+--        lot of them, so joining it with gp_ic_bench_source() broadcasts the
+--        rows of gp_ic_bench_source()
+--
+--------------------------------------------------------------------------------
+
+CREATE FUNCTION gp_ic_bench_anchor(rows int8 DEFAULT 1, width int4 DEFAULT 0)
+RETURNS TABLE (id int8, payload bytea)
+AS '$libdir/gp_interconnect_bench', 'gp_ic_bench_source'
+LANGUAGE C VOLATILE STRICT ROWS 1000000000 EXECUTE ON ALL SEGMENTS;
+
+--------------------------------------------------------------------------------
+-- @function:
+--        gp_ic_bench_sink
+--
+-- @in:
+--        anytable - the rows to consume
+--
+-- @out:
+--        int4 - segment id,
+--        int8 - number of tuples received,
+--        int8 - number of tuple bytes received,
+--        int8 - microseconds from the first tuple to the end of the input
+--
+-- @doc:
+--        Table function to consume the rows coming out of a motion
+--
+--------------------------------------------------------------------------------
+
+CREATE FUNCTION gp_ic_bench_sink(anytable)
+RETURNS TABLE (segid int4, tuples int8, bytes int8, elapsed_us int8)
+AS '$libdir/gp_interconnect_bench', 'gp_ic_bench_sink'
+LANGUAGE C VOLATILE;
@@ -0,0 +1,237 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2021-Present VMware, Inc. or its affiliates.
+#
+"""
+ic_bench.py - interconnect microbenchmark for a single host cluster
+
+Drives synthetic redistribute, broadcast and gather motions through every
+interconnect type, using gp_ic_bench_source() and gp_ic_bench_sink() from
+the gp_internal_tools extension, and reports for each combination of
+interconnect type, motion, tuple width and fan-out:
+
+  - throughput, in payload MB per second;
+  - p50 and p99 latency of a query moving one row per segment;
+  - share of the UDP packets that had to be retransmitted (udpifc only);
+  - CPU seconds spent by all the postgres processes per GB of payload.
+
+CPU time is read from /proc, so the cluster must run on the local host, and
+the numbers include any other postgres processes of the same user.
+
+Usage:
+
+    CREATE EXTENSION gp_internal_tools;   -- or ALTER EXTENSION ... UPDATE
+    ic_bench.py -d postgres --widths 16,256,4096 --fanouts 1,3
+"""
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+
+# The rows for every motion are counted at the receiving end, as the first
+# column of the result.
+PATTERNS = {
+    'redistribute': (
+        'Redistribute Motion',
+        "SELECT sum(tuples) FROM gp_ic_bench_sink(TABLE("
+        "SELECT id, payload FROM gp_ic_bench_source({rows}, {width}) "
+        "SCATTER BY id % {fanout}))"),
+    'broadcast': (
+        'Broadcast Motion',
+        "SELECT count(*) FROM gp_ic_bench_anchor() a, "
+        "gp_ic_bench_source({rows}, {width}) s "
+        "WHERE octet_length(s.payload) >= 0"),
+    'gather': (
+        'Gather Motion',
+        "SELECT count(*) FROM (SELECT payload FROM "
+        "gp_ic_bench_source({rows}, {width}) "
+        "LIMIT 9223372036854775807) s "
+        "WHERE octet_length(s.payload) >= 0"),
+}
+
+TIMING_RE = re.compile(r'^Time: ([0-9.]+) ms')
+
+
+class BenchError(Exception):
+    pass
+
+
+def psql(args, mode, sql):
+    """Run a script in a new session of the given interconnect type.
+
+    Returns the (non timing) output lines and the timings in ms."""
+    env = dict(os.environ)
+    env['PGOPTIONS'] = '%s -c gp_interconnect_type=%s -c optimizer=off' % (
+        env.get('PGOPTIONS', ''), mode)
+
+    cmd = ['psql', '-X', '-A', '-t', '-v', 'ON_ERROR_STOP=1',
+           '-d', args.dbname]
+    if args.host:
+        cmd += ['-h', args.host]
+    if args.port:
+        cmd += ['-p', str(args.port)]
+
+    proc = subprocess.run(cmd, input='\\timing on\n' + sql, env=env,
+                          stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+                          universal_newlines=True)
+    if proc.returncode != 0:
+        raise BenchError(proc.stderr.strip())
+
+    lines = []
+    timings = []
+    for line in proc.stdout.splitlines():
+        m = TIMING_RE.match(line)
+        if m:
+            timings.append(float(m.group(1)))
+        elif line and line != 'Timing is on.':
+            lines.append(line)
+    return lines, timings
+
+
+def cpu_seconds():
+    """CPU seconds used so far by the postgres processes of this user.
+
+    The exited backends are accounted in the children times of their
+    postmaster, so adding those up keeps the sum monotonic."""
+    ticks = 0
+    uid = os.getuid()
+    for pid in os.listdir('/proc'):
+        if not pid.isdigit():
+            continue
+        try:
+            if os.stat('/proc/' + pid).st_uid != uid:
+                continue
+            with open('/proc/%s/stat' % pid) as f:
+                stat = f.read()
+        except OSError:
+            continue
+        comm = stat[stat.index('(') + 1:stat.rindex(')')]
+        if comm != 'postgres':
+            continue
+        # utime, stime, cutime, cstime are the 14th to 17th fields
+        fields = stat[stat.rindex(')') + 2:].split()
+        ticks += sum(int(x) for x in fields[11:15])
+    return ticks / os.sysconf('SC_CLK_TCK')
+
+
+def udp_retransmits(args):
+    """Number of retransmitted and of all acked UDP packets so far."""
+    lines, _ = psql(args, 'udpifc',
+                    "SELECT coalesce(sum(count) FILTER (WHERE bucket <> '0'), 0), "
+                    "coalesce(sum(count), 0) FROM gp_stat_interconnect_udp "
+                    "WHERE metric = 'retransmits';\n")
+    retransmitted, total = lines[0].split('|')
+    return int(retransmitted), int(total)
+
+
+def percentile(values, pct):
+    values = sorted(values)
+    idx = min(len(values) - 1, int(round(pct / 100.0 * (len(values) - 1))))
+    return values[idx]
+
+
+def run_case(args, mode, pattern, width, fanout, nsegs):
+    motion, template = PATTERNS[pattern]
+    rows = max(1, args.volume_mb * 1024 * 1024 // max(width, 1))
+    query = template.format(rows=rows, width=width, fanout=fanout)
+
+    lines, _ = psql(args, mode, 'EXPLAIN %s;\n' % query)
+    if not any(motion in line for line in lines):
+        print('warning: no %s in the plan of %s' % (motion, pattern),
+              file=sys.stderr)
+
+    if mode == 'udpifc':
+        retrans_before = udp_retransmits(args)
+
+    cpu_before = cpu_seconds()
+    lines, timings = psql(args, mode, (query + ';\n') * args.repeat)
+    cpu = cpu_seconds() - cpu_before
+
+    received = sum(int(line) for line in lines)
+    payload_mb = received * width / (1024.0 * 1024.0)
+    throughput = payload_mb / (sum(timings) / 1000.0) if timings else 0.0
+    cpu_per_gb = cpu / (payload_mb / 1024.0) if payload_mb > 0 else 0.0
+
+    retrans = '-'
+    if mode == 'udpifc':
+        retrans_after = udp_retransmits(args)
+        acked = retrans_after[1] - retrans_before[1]
+        if acked > 0:
+            retrans = '%.3f' % (100.0 * (retrans_after[0] - retrans_before[0])
+                                / acked)
+
+    latency_query = template.format(rows=1, width=width, fanout=fanout)
+    _, latencies = psql(args, mode, (latency_query + ';\n') * args.latency_runs)
+
+    return [mode, pattern, width, fanout,
+            '%.1f' % throughput,
+            '%.2f' % percentile(latencies, 50),
+            '%.2f' % percentile(latencies, 99),
+            retrans,
+            '%.2f' % cpu_per_gb]
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Interconnect microbenchmark for a single host cluster.')
+    parser.add_argument('-d', '--dbname', default='postgres')
+    parser.add_argument('-H', '--host')
+    parser.add_argument('-p', '--port', type=int)
+    parser.add_argument('--modes', default='tcp,udpifc,proxy',
+                        help='interconnect types to run (default: %(default)s)')
+    parser.add_argument('--patterns', default='redistribute,broadcast,gather',
+                        help='motions to run (default: %(default)s)')
+    parser.add_argument('--widths', default='16,256,4096',
+                        help='payload widths in bytes (default: %(default)s)')
+    parser.add_argument('--fanouts',
+                        help='number of receivers of the redistribute motion '
+                             '(default: all the segments)')
+    parser.add_argument('--volume-mb', type=int, default=128,
+                        help='payload MB sent by every segment per query '
+                             '(default: %(default)s)')
+    parser.add_argument('--repeat', type=int, default=3,
+                        help='throughput queries per case (default: %(default)s)')
+    parser.add_argument('--latency-runs', type=int, default=100,
+                        help='latency queries per case (default: %(default)s)')
+    args = parser.parse_args()
+
+    lines, _ = psql(args, 'udpifc',
+                    'SELECT count(*) FROM gp_segment_configuration '
+                    "WHERE role = 'p' AND content >= 0;\n")
+    nsegs = int(lines[0])
+
+    widths = [int(x) for x in args.widths.split(',')]
+    fanouts = [int(x) for x in args.fanouts.split(',')] if args.fanouts \
+        else [nsegs]
+
+    header = ['mode', 'motion', 'width', 'fanout', 'MB/s',
+              'p50 ms', 'p99 ms', 'retrans %', 'cpu s/GB']
+    print('\t'.join(header))
+
+    for mode in args.modes.split(','):
+        try:
+            psql(args, mode, 'SELECT 1;\n')
+        except BenchError as e:
+            print('skipping %s: %s' % (mode, e), file=sys.stderr)
+            continue
+
+        for pattern in args.patterns.split(','):
+            if pattern not in PATTERNS:
+                parser.error('unknown motion "%s"' % pattern)
+            for width in widths:
+                # only a redistribute motion can pick its receivers
+                for fanout in (fanouts if pattern == 'redistribute'
+                               else [nsegs if pattern == 'broadcast' else 1]):
+                    row = run_case(args, mode, pattern, width, fanout, nsegs)
+                    print('\t'.join(str(x) for x in row))
+                    sys.stdout.flush()
+
+
+if __name__ == '__main__':
+    try:
+        main()
+    except BenchError as e:
+        print('error: %s' % e, file=sys.stderr)
+        sys.exit(1)
@@ -0,0 +1,34 @@
+-- The benchmark functions come with version 1.1.0, check the upgrade from
+-- 1.0.0 adds them.
+CREATE EXTENSION gp_internal_tools VERSION '1.0.0';
+select count(*) from pg_proc where proname like 'gp\_ic\_bench\_%';
+ALTER EXTENSION gp_internal_tools UPDATE;
+select extversion from pg_extension where extname = 'gp_internal_tools';
+select proname from pg_proc where proname like 'gp\_ic\_bench\_%' order by 1;
+DROP EXTENSION gp_internal_tools;
+
+CREATE EXTENSION gp_internal_tools;
+
+-- Every segment returns the same rows, with the same payload.
+select count(*) = 10 * (select count(*) from gp_segment_configuration
+                        where role = 'p' and content >= 0) as all_segments,
+       count(distinct id) as ids, min(id), max(id),
+       min(octet_length(payload)) as min_width,
+       max(octet_length(payload)) as max_width,
+       count(distinct payload) as payloads
+from gp_ic_bench_source(10, 8);
+select count(*) from gp_ic_bench_source(0, 8);
+select count(*) from gp_ic_bench_source(-1, 8);
+select count(*) from gp_ic_bench_source(1, -1);
+
+-- The sink counts what it receives through the motion.
+select * from gp_ic_bench_sink(TABLE(
+    select id, payload from gp_ic_bench_source(10, 8) scatter by id % 4)) limit 0;
+select sum(tuples) = 10 * (select count(*) from gp_segment_configuration
+                           where role = 'p' and content >= 0) as all_tuples,
+       sum(bytes) > 0 as bytes,
+       min(elapsed_us) >= 0 as elapsed
+from gp_ic_bench_sink(TABLE(
+    select id, payload from gp_ic_bench_source(10, 8) scatter by id % 4));
+
+DROP EXTENSION gp_internal_tools;
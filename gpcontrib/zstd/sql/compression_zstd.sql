@@ -35,6 +35,15 @@ SELECT * FROM zstdtest_19 ORDER BY (id, t) LIMIT 5;
 SELECT * FROM zstdtest_19 ORDER BY (id, t) DESC LIMIT 5;
 
 
+-- Compress blocks on helper threads. Large blocks are needed for zstd to
+-- split them into more than one job.
+SET gp_appendonly_compress_workers = 2;
+CREATE TABLE zstdtest_workers (id int4, t text) WITH (appendonly=true, compresstype=zstd, compresslevel=3, blocksize=2097152) DISTRIBUTED BY (id);
+INSERT INTO zstdtest_workers SELECT g, md5(g::text) FROM generate_series(1, 100000) g;
+RESET gp_appendonly_compress_workers;
+SELECT count(*), sum(id) FROM zstdtest_workers;
+SELECT count(*) FROM zstdtest_workers WHERE t <> md5(id::text);
+
 -- Test the bounds of compresslevel. None of these are allowed.
 CREATE TABLE zstdtest_invalid (id int4) WITH (appendonly=true, compresstype=zstd, compresslevel=-1);
 CREATE TABLE zstdtest_invalid (id int4) WITH (appendonly=true, compresstype=zstd, compresslevel=0);
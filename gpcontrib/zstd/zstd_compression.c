@@ -15,9 +15,20 @@
 #include "fmgr.h"
 #include "storage/gp_compress.h"
 #include "utils/builtins.h"
+#include "utils/guc.h"
 
 #include <zstd.h>
 #include <zstd_errors.h>
+#include <pthread.h>
+#include <signal.h>
+
+/*
+ * Smallest blocksize that gp_appendonly_compress_workers applies to.  zstd
+ * never makes a job smaller than its minimum job size, 512kB in the versions
+ * that have ZSTD_c_nbWorkers, so a block must hold at least two jobs for a
+ * helper thread to have anything to do.
+ */
+#define ZSTD_MT_MIN_BLOCKSIZE	(1024 * 1024)
 
 Datum		zstd_constructor(PG_FUNCTION_ARGS);
 Datum		zstd_destructor(PG_FUNCTION_ARGS);
@@ -40,6 +51,7 @@ typedef struct zstd_state
 {
 	int			level;			/* Compression level */
 	bool		compress;		/* Compress if true, decompress otherwise */
+	bool		multithreaded;	/* cctx compresses on helper threads */
 
 	zstd_context *ctx;			/* ZSTD compression/decompresion contexts */
 } zstd_state;
@@ -75,6 +87,39 @@ zstd_constructor(PG_FUNCTION_ARGS)
 	if (!state->ctx->dctx)
 		elog(ERROR, "out of memory");
 
+	/*
+	 * With gp_appendonly_compress_workers set, let libzstd compress each
+	 * block on a pool of helper threads, owned by the compression context.
+	 * The threads only run zstd's own code, never anything in the backend.
+	 * zstd splits a block into jobs of at least its minimum job size, so
+	 * smaller blocksizes, the default 32kB included, stay single-threaded.
+	 * So does a library built without thread support, where setting the
+	 * parameter fails.
+	 */
+	state->multithreaded = false;
+#if ZSTD_VERSION_NUMBER >= 10400
+	if (compress && gp_appendonly_compress_workers > 0 &&
+		sa->blocksize >= ZSTD_MT_MIN_BLOCKSIZE)
+	{
+		size_t		rc;
+
+		rc = ZSTD_CCtx_setParameter(state->ctx->cctx, ZSTD_c_nbWorkers,
+									gp_appendonly_compress_workers);
+		if (!ZSTD_isError(rc))
+		{
+			rc = ZSTD_CCtx_setParameter(state->ctx->cctx,
+										ZSTD_c_compressionLevel,
+										state->level);
+			if (ZSTD_isError(rc))
+				elog(ERROR, "%s", ZSTD_getErrorName(rc));
+
+			/* Smallest job size zstd allows, to split blocks as much as possible */
+			(void) ZSTD_CCtx_setParameter(state->ctx->cctx, ZSTD_c_jobSize, 1);
+			state->multithreaded = true;
+		}
+	}
+#endif
+
 	PG_RETURN_POINTER(cs);
 }
 
@@ -114,10 +159,38 @@ zstd_compress(PG_FUNCTION_ARGS)
 
 	unsigned long dst_length_used;
 
-	dst_length_used = ZSTD_compressCCtx(state->ctx->cctx,
-										dst, dst_sz,
-										src, src_sz,
-										state->level);
+#if ZSTD_VERSION_NUMBER >= 10400
+	if (state->multithreaded)
+	{
+		sigset_t	sigs;
+		sigset_t	old_sigs;
+		int			err;
+
+		/*
+		 * zstd starts its helper threads from within the first call that
+		 * needs them, and they inherit our signal mask.  Block everything
+		 * while in zstd, so that the backend's signal handlers never run
+		 * on one of them.
+		 */
+		sigfillset(&sigs);
+		err = pthread_sigmask(SIG_BLOCK, &sigs, &old_sigs);
+		if (err != 0)
+			elog(ERROR, "failed to block signals for zstd helper threads: %d", err);
+
+		dst_length_used = ZSTD_compress2(state->ctx->cctx,
+										 dst, dst_sz,
+										 src, src_sz);
+
+		err = pthread_sigmask(SIG_SETMASK, &old_sigs, NULL);
+		if (err != 0)
+			elog(ERROR, "failed to reset signal mask after zstd compression: %d", err);
+	}
+	else
+#endif
+		dst_length_used = ZSTD_compressCCtx(state->ctx->cctx,
+											dst, dst_sz,
+											src, src_sz,
+											state->level);
 
 	if (ZSTD_isError(dst_length_used))
 	{
@@ -28,9 +28,11 @@
 #include "catalog/pg_appendonly.h"
 #include "cdb/cdbaocsam.h"
 #include "cdb/cdbvars.h"
+#include "commands/progress.h"
 #include "commands/vacuum.h"
 #include "executor/executor.h"
 #include "nodes/execnodes.h"
+#include "pgstat.h"
 #include "storage/lmgr.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
@@ -224,6 +226,12 @@ AOCSSegmentFileFullCompaction(Relation aorel,
 	AOTupleId  *aoTupleId;
 	int64		tupleCount = 0;
 	int64		tuplePerPage = INT_MAX;
+	int64		droppedTupleCount = 0;
+	int64		segeof = 0;
+	BlockNumber	pagesPerDelayPoint;
+	int			col;
+	Relation	clusterIndex;
+	Tuplesortstate *sortstate = NULL;
 
 	Assert(Gp_role == GP_ROLE_EXECUTE || Gp_role == GP_ROLE_UTILITY);
 	Assert(RelationIsAoCols(aorel));
@@ -234,6 +242,12 @@ AOCSSegmentFileFullCompaction(Relation aorel,
 	{
 		tuplePerPage = fsinfo->total_tupcount / fsinfo->varblockcount;
 	}
+	if (tuplePerPage <= 0)
+		tuplePerPage = 1;
+	for (col = 0; col < fsinfo->vpinfo.nEntry; col++)
+		segeof += fsinfo->vpinfo.entry[col].eof;
+	pagesPerDelayPoint = AppendOnlyCompaction_PagesPerDelayPoint(segeof,
+																 fsinfo->varblockcount);
 	relname = RelationGetRelationName(aorel);
 
 	AppendOnlyVisimap_Init(&visiMap,
@@ -270,6 +284,15 @@ AOCSSegmentFileFullCompaction(Relation aorel,
 	estate->es_num_result_relations = 1;
 	estate->es_result_relation_info = resultRelInfo;
 
+	/*
+	 * If the table is marked clustered on an index, move the visible tuples
+	 * in index order. See AppendOnlyCompaction_OpenClusterIndex().
+	 */
+	clusterIndex = AppendOnlyCompaction_OpenClusterIndex(aorel);
+	if (clusterIndex)
+		sortstate = tuplesort_begin_cluster(tupDesc, clusterIndex,
+											maintenance_work_mem, NULL, false);
+
 	while (aocs_getnext(scanDesc, ForwardScanDirection, slot))
 	{
 		CHECK_FOR_INTERRUPTS();
@@ -277,26 +300,52 @@ AOCSSegmentFileFullCompaction(Relation aorel,
 		aoTupleId = (AOTupleId *) &slot->tts_tid;
 		if (AppendOnlyVisimap_IsVisible(&scanDesc->visibilityMap, aoTupleId))
 		{
-			AOCSMoveTuple(slot,
-						  insertDesc,
-						  resultRelInfo,
-						  estate);
+			if (sortstate)
+				AppendOnlyCompaction_SortTuple(sortstate, slot);
+			else
+				AOCSMoveTuple(slot,
+							  insertDesc,
+							  resultRelInfo,
+							  estate);
 			movedTupleCount++;
 		}
 		else
 		{
 			/* Tuple is invisible and needs to be dropped */
 			AppendOnlyThrowAwayTuple(aorel, slot);
+			droppedTupleCount++;
 		}
 
 		/*
 		 * Check for vacuum delay point after approximatly a var block
 		 */
 		tupleCount++;
-		if (VacuumCostActive && tupleCount % tuplePerPage == 0)
+		if (tupleCount % tuplePerPage == 0)
+		{
+			AppendOnlyCompaction_DelayPoint(pagesPerDelayPoint,
+											droppedTupleCount);
+			droppedTupleCount = 0;
+		}
+	}
+	pgstat_progress_incr_param(PROGRESS_VACUUM_NUM_DEAD_TUPLES,
+							   droppedTupleCount);
+
+	if (sortstate)
+	{
+		tuplesort_performsort(sortstate);
+
+		while (AppendOnlyCompaction_FetchSortedTuple(sortstate, slot))
 		{
-			vacuum_delay_point();
+			CHECK_FOR_INTERRUPTS();
+
+			AOCSMoveTuple(slot,
+						  insertDesc,
+						  resultRelInfo,
+						  estate);
 		}
+
+		tuplesort_end(sortstate);
+		index_close(clusterIndex, AccessShareLock);
 	}
 
 	MarkAOCSFileSegInfoAwaitingDrop(aorel, compact_segno);
@@ -49,6 +49,27 @@
 #include "utils/syscache.h"
 
 
+/*
+ * Number of values aocs_getnext() decodes from a column's current block in
+ * one go.
+ */
+#define AOCS_SCAN_BATCH_SIZE 128
+
+/*
+ * Values of one projected column decoded ahead of time by
+ * datumstreamread_get_batch(). A batch never spans datum stream blocks, so
+ * by-reference values keep pointing into a valid block buffer until the
+ * batch is used up.
+ */
+typedef struct AOCSColumnBatch
+{
+	int			count;			/* number of values decoded */
+	int			next;			/* index of the next value to hand out */
+	int			firstNth;		/* position of values[0] within its block */
+	Datum		values[AOCS_SCAN_BATCH_SIZE];
+	bool		isnull[AOCS_SCAN_BATCH_SIZE];
+} AOCSColumnBatch;
+
 static AOCSScanDesc aocs_beginscan_internal(Relation relation,
 						AOCSFileSegInfo **seginfo,
 						int total_seg,
@@ -313,6 +334,10 @@ aocs_initscan(AOCSScanDesc scan)
 			scan->columnScanInfo.proj_atts[attno] = attno;
 	}
 
+	if (scan->columnScanInfo.batch == NULL)
+		scan->columnScanInfo.batch = (AOCSColumnBatch *)
+			palloc0(scan->columnScanInfo.num_proj_atts * sizeof(AOCSColumnBatch));
+
 	open_ds_read(scan->rs_base.rs_rd, scan->columnScanInfo.ds,
 				 scan->columnScanInfo.relationTupleDesc,
 				 scan->columnScanInfo.proj_atts, scan->columnScanInfo.num_proj_atts,
@@ -418,6 +443,12 @@ open_next_scan_seg(AOCSScanDesc scan)
 												  scan->columnScanInfo.num_proj_atts,
 												  scan->blockDirectory);
 
+				for (AttrNumber i = 0; i < scan->columnScanInfo.num_proj_atts; i++)
+				{
+					scan->columnScanInfo.batch[i].count = 0;
+					scan->columnScanInfo.batch[i].next = 0;
+				}
+
 				return scan->cur_seg;
 			}
 		}
@@ -568,6 +599,7 @@ aocs_beginscan_internal(Relation relation,
 	}
 
 	scan->columnScanInfo.ds = NULL;
+	scan->columnScanInfo.batch = NULL;
 
 	GetAppendOnlyEntryAttributes(RelationGetRelid(relation),
 								 NULL,
@@ -624,6 +656,9 @@ aocs_endscan(AOCSScanDesc scan)
 	if (scan->columnScanInfo.proj_atts)
 		pfree(scan->columnScanInfo.proj_atts);
 
+	if (scan->columnScanInfo.batch)
+		pfree(scan->columnScanInfo.batch);
+
 	for (int i = 0; i < scan->total_seg; ++i)
 	{
 		if (scan->seginfo[i])
@@ -769,30 +804,44 @@ ReadNext:
 		for (AttrNumber i = 0; i < scan->columnScanInfo.num_proj_atts; i++)
 		{
 			AttrNumber	attno = scan->columnScanInfo.proj_atts[i];
+			DatumStreamRead *ds = scan->columnScanInfo.ds[attno];
+			AOCSColumnBatch *batch = &scan->columnScanInfo.batch[i];
 
-			err = datumstreamread_advance(scan->columnScanInfo.ds[attno]);
-			Assert(err >= 0);
-			if (err == 0)
+			/*
+			 * Rather than advancing and getting one datum at a time, decode a
+			 * run of values from the column's current block while its data
+			 * structures are hot in CPU data cache memory, and hand them out
+			 * from the batch.
+			 */
+			if (batch->next >= batch->count)
 			{
-				err = datumstreamread_block(scan->columnScanInfo.ds[attno], scan->blockDirectory, attno);
-				if (err < 0)
+				batch->count = datumstreamread_get_batch(ds, batch->values,
+														 batch->isnull,
+														 AOCS_SCAN_BATCH_SIZE);
+				Assert(batch->count >= 0);
+				if (batch->count == 0)
 				{
-					/*
-					 * Ha, cannot read next block, we need to go to next seg
-					 */
-					close_cur_scan_seg(scan);
-					goto ReadNext;
+					err = datumstreamread_block(ds, scan->blockDirectory, attno);
+					if (err < 0)
+					{
+						/*
+						 * Ha, cannot read next block, we need to go to next seg
+						 */
+						close_cur_scan_seg(scan);
+						goto ReadNext;
+					}
+
+					batch->count = datumstreamread_get_batch(ds, batch->values,
+															 batch->isnull,
+															 AOCS_SCAN_BATCH_SIZE);
+					Assert(batch->count > 0);
 				}
-
-				err = datumstreamread_advance(scan->columnScanInfo.ds[attno]);
-				Assert(err > 0);
+				batch->next = 0;
+				batch->firstNth = datumstreamread_nth(ds) - batch->count + 1;
 			}
 
-			/*
-			 * Get the column's datum right here since the data structures
-			 * should still be hot in CPU data cache memory.
-			 */
-			datumstreamread_get(scan->columnScanInfo.ds[attno], &d[attno], &null[attno]);
+			d[attno] = batch->values[batch->next];
+			null[attno] = batch->isnull[batch->next];
 
 			/*
 			 * Perform any required upgrades on the Datum we just fetched.
@@ -804,12 +853,13 @@ ReadNext:
 			}
 
 			if (rowNum == INT64CONST(-1) &&
-				scan->columnScanInfo.ds[attno]->blockFirstRowNum != INT64CONST(-1))
+				ds->blockFirstRowNum != INT64CONST(-1))
 			{
-				Assert(scan->columnScanInfo.ds[attno]->blockFirstRowNum > 0);
-				rowNum = scan->columnScanInfo.ds[attno]->blockFirstRowNum +
-					datumstreamread_nth(scan->columnScanInfo.ds[attno]);
+				Assert(ds->blockFirstRowNum > 0);
+				rowNum = ds->blockFirstRowNum + batch->firstNth + batch->next;
 			}
+
+			batch->next++;
 		}
 
 		scan->cur_seg_row++;
@@ -28,6 +28,7 @@
 #include "catalog/storage.h"
 #include "catalog/storage_xlog.h"
 #include "cdb/cdbaocsam.h"
+#include "cdb/cdbappendonlyblockdirectory.h"
 #include "cdb/cdbvars.h"
 #include "commands/vacuum.h"
 #include "executor/executor.h"
@@ -79,6 +80,43 @@ typedef struct AOCSBitmapScanData
 	int	rs_cindex;	/* current tuple's index tbmres->offset or -1 */
 } *AOCSBitmapScan;
 
+/*
+ * State of an ANALYZE scan that samples rows through the block directory.
+ *
+ * ANALYZE picks "block" numbers that, for AO tables, are ordinals of the
+ * rows in the table (see acquire_sample_rows()). Without a block directory,
+ * aoco_scan_analyze_next_tuple() has to scan and deform every row up to the
+ * sampled one, which makes ANALYZE as expensive as a full table scan. With
+ * a block directory, the minipages tell how many rows each range of row
+ * numbers holds, so an ordinal can be mapped to its row number and the row
+ * fetched directly. Only the varblocks holding the sampled rows are read.
+ *
+ * 'ranges' holds the row counts of all the minipages of 'columnGroupNo',
+ * with 'startOrdinals' the ordinal of the first row of each; the entries of
+ * the minipage 'curRange' are loaded in 'blockDirectory'.
+ */
+typedef struct AOCSAnalyzeSamplerData
+{
+	bool	   *proj;
+	struct AOCSFetchDescData *fetchDesc;
+
+	AppendOnlyBlockDirectory blockDirectory;
+	bool	   *blkdirProj;
+	int			columnGroupNo;
+
+	MinipageRowRange *ranges;
+	int64	   *startOrdinals;
+	int			nranges;
+	int64		totalRows;
+	int			curRange;
+
+	AOTupleId	targetTid;
+	bool		haveTarget;
+} AOCSAnalyzeSamplerData;
+
+static AOCSAnalyzeSamplerData *aoco_analyze_sampler_init(AOCSScanDesc scan);
+static void aoco_analyze_sampler_end(AOCSAnalyzeSamplerData *sampler);
+
 typedef struct AOCODMLState
 {
 	Oid relationOid;
@@ -524,9 +562,164 @@ aoco_beginscan(Relation relation,
 							NULL,
 							flags);
 
+	if (flags & SO_TYPE_ANALYZE)
+		aoscan->sampler = aoco_analyze_sampler_init(aoscan);
+
 	return (TableScanDesc) aoscan;
 }
 
+/*
+ * Set up block directory driven sampling for an ANALYZE scan. Returns NULL
+ * if the relation has no block directory, in which case ANALYZE falls back
+ * to scanning the table.
+ */
+static AOCSAnalyzeSamplerData *
+aoco_analyze_sampler_init(AOCSScanDesc scan)
+{
+	Relation	rel = scan->rs_base.rs_rd;
+	TupleDesc	tupdesc = RelationGetDescr(rel);
+	int			natts = tupdesc->natts;
+	AOCSAnalyzeSamplerData *sampler;
+	Oid			blkdirrelid;
+	int64		ordinal;
+	int			i;
+
+	GetAppendOnlyEntryAuxOids(RelationGetRelid(rel), scan->appendOnlyMetaDataSnapshot,
+							  NULL, &blkdirrelid, NULL, NULL, NULL);
+	if (!OidIsValid(blkdirrelid) || scan->total_seg == 0)
+		return NULL;
+
+	sampler = palloc0(sizeof(AOCSAnalyzeSamplerData));
+
+	/*
+	 * Fetch all the live columns, and map the ordinals using the minipages
+	 * of the first of them. Every column covers the same row numbers.
+	 */
+	sampler->proj = palloc0(natts * sizeof(bool));
+	sampler->columnGroupNo = -1;
+	for (i = 0; i < natts; i++)
+	{
+		if (TupleDescAttr(tupdesc, i)->attisdropped)
+			continue;
+		sampler->proj[i] = true;
+		if (sampler->columnGroupNo == -1)
+			sampler->columnGroupNo = i;
+	}
+	if (sampler->columnGroupNo == -1)
+	{
+		pfree(sampler->proj);
+		pfree(sampler);
+		return NULL;
+	}
+
+	sampler->fetchDesc = aocs_fetch_init(rel,
+										 scan->rs_base.rs_snapshot,
+										 scan->appendOnlyMetaDataSnapshot,
+										 sampler->proj);
+
+	sampler->blkdirProj = palloc0(natts * sizeof(bool));
+	sampler->blkdirProj[sampler->columnGroupNo] = true;
+	AppendOnlyBlockDirectory_Init_forSearch(&sampler->blockDirectory,
+											scan->appendOnlyMetaDataSnapshot,
+											(FileSegInfo **) sampler->fetchDesc->segmentFileInfo,
+											sampler->fetchDesc->totalSegfiles,
+											rel,
+											natts,
+											true,
+											sampler->blkdirProj);
+
+	sampler->ranges =
+		AppendOnlyBlockDirectory_GetMinipageRowRanges(&sampler->blockDirectory,
+													  sampler->columnGroupNo,
+													  &sampler->nranges);
+	sampler->startOrdinals = palloc(Max(sampler->nranges, 1) * sizeof(int64));
+	ordinal = 0;
+	for (i = 0; i < sampler->nranges; i++)
+	{
+		sampler->startOrdinals[i] = ordinal;
+		ordinal += sampler->ranges[i].rowCount;
+	}
+	sampler->totalRows = ordinal;
+	sampler->curRange = -1;
+
+	return sampler;
+}
+
+static void
+aoco_analyze_sampler_end(AOCSAnalyzeSamplerData *sampler)
+{
+	AppendOnlyBlockDirectory_End_forSearch(&sampler->blockDirectory);
+	aocs_fetch_finish(sampler->fetchDesc);
+	pfree(sampler->fetchDesc);
+
+	pfree(sampler->ranges);
+	pfree(sampler->startOrdinals);
+	pfree(sampler->blkdirProj);
+	pfree(sampler->proj);
+	pfree(sampler);
+}
+
+/*
+ * Map the ordinal of a row in the table to its tuple id. Returns false if
+ * the ordinal is past the rows recorded in the block directory.
+ */
+static bool
+aoco_analyze_sampler_get_tid(AOCSAnalyzeSamplerData *sampler, int64 ordinal,
+							 AOTupleId *aoTupleId)
+{
+	MinipageRowRange *range;
+	MinipagePerColumnGroup *minipageInfo;
+	int64		offset;
+	int			low;
+	int			high;
+	uint32		entry_no;
+
+	if (ordinal < 0 || ordinal >= sampler->totalRows)
+		return false;
+
+	/* Find the minipage holding the ordinal */
+	low = 0;
+	high = sampler->nranges - 1;
+	while (low < high)
+	{
+		int			mid = low + (high - low + 1) / 2;
+
+		if (sampler->startOrdinals[mid] <= ordinal)
+			low = mid;
+		else
+			high = mid - 1;
+	}
+	range = &sampler->ranges[low];
+
+	if (sampler->curRange != low)
+	{
+		sampler->curRange = -1;
+		if (AppendOnlyBlockDirectory_LoadMinipage(&sampler->blockDirectory,
+												  range->segno,
+												  sampler->columnGroupNo,
+												  range->firstRowNum) == NULL)
+			return false;
+		sampler->curRange = low;
+	}
+	minipageInfo = &sampler->blockDirectory.minipages[sampler->columnGroupNo];
+
+	/* Find the row number within the minipage */
+	offset = ordinal - sampler->startOrdinals[low];
+	for (entry_no = 0; entry_no < minipageInfo->numMinipageEntries; entry_no++)
+	{
+		MinipageEntry *entry = &minipageInfo->minipage->entry[entry_no];
+
+		if (offset < entry->rowCount)
+		{
+			AOTupleIdInit(aoTupleId, range->segno, entry->firstRowNum + offset);
+			return true;
+		}
+		offset -= entry->rowCount;
+	}
+
+	return false;
+}
+
 static void
 aoco_endscan(TableScanDesc scan)
 {
@@ -536,6 +729,8 @@ aoco_endscan(TableScanDesc scan)
 	aocsScanDesc = (AOCSScanDesc) scan;
 	if (aocsScanDesc->descIdentifier == AOCSSCANDESCDATA)
 	{
+		if (aocsScanDesc->sampler)
+			aoco_analyze_sampler_end(aocsScanDesc->sampler);
 		aocs_endscan(aocsScanDesc);
 		return;
 	}
@@ -1224,6 +1419,16 @@ aoco_scan_analyze_next_block(TableScanDesc scan, BlockNumber blockno,
                                    BufferAccessStrategy bstrategy)
 {
 	AOCSScanDesc aoscan = (AOCSScanDesc) scan;
+
+	if (aoscan->sampler)
+	{
+		AOCSAnalyzeSamplerData *sampler = aoscan->sampler;
+
+		sampler->haveTarget = aoco_analyze_sampler_get_tid(sampler, blockno,
+														   &sampler->targetTid);
+		return true;
+	}
+
 	aoscan->targetTupleId = blockno;
 
 	return true;
@@ -1237,6 +1442,39 @@ aoco_scan_analyze_next_tuple(TableScanDesc scan, TransactionId OldestXmin,
 	AOCSScanDesc aoscan = (AOCSScanDesc) scan;
 	bool		ret = false;
 
+	if (aoscan->sampler)
+	{
+		AOCSAnalyzeSamplerData *sampler = aoscan->sampler;
+
+		if (!sampler->haveTarget)
+			return false;
+		sampler->haveTarget = false;
+
+		ExecClearTuple(slot);
+		if (aocs_fetch(sampler->fetchDesc, &sampler->targetTid, slot))
+		{
+			int			natts = slot->tts_tupleDescriptor->natts;
+			int			i;
+
+			/* Dropped columns are not fetched */
+			for (i = 0; i < natts; i++)
+			{
+				if (!sampler->proj[i])
+				{
+					slot->tts_values[i] = (Datum) 0;
+					slot->tts_isnull[i] = true;
+				}
+			}
+			ExecStoreVirtualTuple(slot);
+			*liverows += 1;
+			return true;
+		}
+
+		/* The row has been deleted or updated */
+		*deadrows += 1;
+		return false;
+	}
+
 	/* skip several tuples if they are not sampling target */
 	while (aoscan->targetTupleId > aoscan->nextTupleId)
 	{
@@ -37,11 +37,14 @@
 #include "catalog/indexing.h"
 #include "catalog/pg_am.h"
 #include "catalog/pg_appendonly.h"
+#include "catalog/pg_index.h"
 #include "cdb/cdbappendonlyam.h"
 #include "cdb/cdbvars.h"
+#include "commands/progress.h"
 #include "commands/vacuum.h"
 #include "executor/executor.h"
 #include "nodes/execnodes.h"
+#include "pgstat.h"
 #include "storage/procarray.h"
 #include "storage/lmgr.h"
 #include "utils/lsyscache.h"
@@ -49,6 +52,8 @@
 #include "utils/relcache.h"
 #include "utils/guc.h"
 #include "utils/snapmgr.h"
+#include "utils/syscache.h"
+#include "utils/tuplesort.h"
 #include "miscadmin.h"
 
 
@@ -112,6 +117,49 @@ AppendOnlyCompaction_GetHideRatio(int64 hiddenTupcount, int64 totalTupcount)
 	return hideRatio;
 }
 
+/*
+ * Returns the number of BLCKSZ pages that one vacuum delay point during
+ * the compaction of a segfile stands for. Compaction calls the delay point
+ * roughly once per varblock, so this is the average varblock size.
+ */
+BlockNumber
+AppendOnlyCompaction_PagesPerDelayPoint(int64 segeof, int64 varblockcount)
+{
+	int64		pages;
+
+	if (varblockcount <= 0)
+		return 1;
+
+	pages = (segeof / varblockcount + BLCKSZ - 1) / BLCKSZ;
+
+	return (BlockNumber) Max(pages, 1);
+}
+
+/*
+ * Vacuum delay point for compaction, called after approximately one
+ * varblock worth of tuples has been moved or thrown away.
+ *
+ * Segment files are read and written without going through shared buffers,
+ * so nothing charges the cost-based vacuum delay on our behalf. Charge for
+ * the pages read from the compacted segfile and written to the insertion
+ * target here, so that vacuum_cost_delay/vacuum_cost_limit throttle AO
+ * compaction the same way they throttle heap vacuum. Also advance the
+ * VACUUM progress counters.
+ */
+void
+AppendOnlyCompaction_DelayPoint(BlockNumber pages, int64 droppedTupleCount)
+{
+	if (VacuumCostActive)
+		VacuumCostBalance += pages * (VacuumCostPageMiss + VacuumCostPageDirty);
+
+	pgstat_progress_incr_param(PROGRESS_VACUUM_HEAP_BLKS_SCANNED, pages);
+	if (droppedTupleCount > 0)
+		pgstat_progress_incr_param(PROGRESS_VACUUM_NUM_DEAD_TUPLES,
+								   droppedTupleCount);
+
+	vacuum_delay_point();
+}
+
 /*
  * Returns true iff the given segment file should be compacted.
  */
@@ -270,6 +318,103 @@ AppendOnlySegmentFileTruncateToEOF(Relation aorel, int segno, int64 segeof)
 	}
 }
 
+/*
+ * Returns the index the relation has been marked to be clustered on (ALTER
+ * TABLE ... CLUSTER ON), opened and locked, or NULL if there is none.
+ *
+ * When there is one, compaction writes the live tuples of a segment file
+ * out in the order of that index, instead of the order they were appended
+ * in, so that the table gradually becomes physically clustered and BRIN
+ * indexes on the key columns get narrow ranges. As with CLUSTER on
+ * append-optimized tables, only B-tree indexes are supported.
+ */
+Relation
+AppendOnlyCompaction_OpenClusterIndex(Relation aorel)
+{
+	List	   *indexoidlist;
+	ListCell   *lc;
+	Oid			clusterIndexOid = InvalidOid;
+	Relation	clusterIndex;
+
+	indexoidlist = RelationGetIndexList(aorel);
+	foreach(lc, indexoidlist)
+	{
+		Oid			indexOid = lfirst_oid(lc);
+		HeapTuple	indexTuple;
+		Form_pg_index indexForm;
+
+		indexTuple = SearchSysCache1(INDEXRELID, ObjectIdGetDatum(indexOid));
+		if (!HeapTupleIsValid(indexTuple))
+			elog(ERROR, "cache lookup failed for index %u", indexOid);
+		indexForm = (Form_pg_index) GETSTRUCT(indexTuple);
+
+		if (indexForm->indisclustered && indexForm->indisvalid)
+			clusterIndexOid = indexOid;
+		ReleaseSysCache(indexTuple);
+
+		if (OidIsValid(clusterIndexOid))
+			break;
+	}
+	list_free(indexoidlist);
+
+	if (!OidIsValid(clusterIndexOid))
+		return NULL;
+
+	clusterIndex = index_open(clusterIndexOid, AccessShareLock);
+	if (clusterIndex->rd_rel->relam != BTREE_AM_OID)
+	{
+		index_close(clusterIndex, AccessShareLock);
+		return NULL;
+	}
+
+	return clusterIndex;
+}
+
+/*
+ * Adds the tuple in the slot to a compaction sort, set up with
+ * tuplesort_begin_cluster() on the index returned by
+ * AppendOnlyCompaction_OpenClusterIndex().
+ */
+void
+AppendOnlyCompaction_SortTuple(Tuplesortstate *sortstate, TupleTableSlot *slot)
+{
+	HeapTuple	tuple;
+
+	slot_getallattrs(slot);
+	tuple = heap_form_tuple(slot->tts_tupleDescriptor,
+							slot->tts_values, slot->tts_isnull);
+	tuplesort_putheaptuple(sortstate, tuple);
+	heap_freetuple(tuple);
+}
+
+/*
+ * Stores the next tuple of a performed compaction sort in the (virtual)
+ * slot. Returns false when the sort is exhausted. The slot's contents stay
+ * valid until the next call.
+ *
+ * The old location of the tuple is not carried through the sort, so the
+ * slot's tid is left invalid.
+ */
+bool
+AppendOnlyCompaction_FetchSortedTuple(Tuplesortstate *sortstate,
+									  TupleTableSlot *slot)
+{
+	HeapTuple	tuple;
+
+	ExecClearTuple(slot);
+
+	tuple = tuplesort_getheaptuple(sortstate, true);
+	if (tuple == NULL)
+		return false;
+
+	heap_deform_tuple(tuple, slot->tts_tupleDescriptor,
+					  slot->tts_values, slot->tts_isnull);
+	ExecStoreVirtualTuple(slot);
+	ItemPointerSetInvalid(&slot->tts_tid);
+
+	return true;
+}
+
 static void
 AppendOnlyMoveTuple(TupleTableSlot *slot,
 					MemTupleBinding *mt_bind,
@@ -370,6 +515,10 @@ AppendOnlySegmentFileFullCompaction(Relation aorel,
 	AOTupleId  *aoTupleId;
 	int64		tupleCount = 0;
 	int64		tuplePerPage = INT_MAX;
+	int64		droppedTupleCount = 0;
+	BlockNumber	pagesPerDelayPoint;
+	Relation	clusterIndex;
+	Tuplesortstate *sortstate = NULL;
     Oid         visimaprelid;
     Oid         visimapidxid;
     Oid         blkdirrelid;
@@ -383,6 +532,10 @@ AppendOnlySegmentFileFullCompaction(Relation aorel,
 	{
 		tuplePerPage = fsinfo->total_tupcount / fsinfo->varblockcount;
 	}
+	if (tuplePerPage <= 0)
+		tuplePerPage = 1;
+	pagesPerDelayPoint = AppendOnlyCompaction_PagesPerDelayPoint(fsinfo->eof,
+																 fsinfo->varblockcount);
 	relname = RelationGetRelationName(aorel);
 
 	GetAppendOnlyEntryAuxOids(aorel->rd_id, appendOnlyMetaDataSnapshot,
@@ -428,6 +581,15 @@ AppendOnlySegmentFileFullCompaction(Relation aorel,
 	estate->es_num_result_relations = 1;
 	estate->es_result_relation_info = resultRelInfo;
 
+	/*
+	 * If the table is marked clustered on an index, the visible tuples are
+	 * sorted first and moved in index order once the scan is done.
+	 */
+	clusterIndex = AppendOnlyCompaction_OpenClusterIndex(aorel);
+	if (clusterIndex)
+		sortstate = tuplesort_begin_cluster(tupDesc, clusterIndex,
+											maintenance_work_mem, NULL, false);
+
 	/*
 	 * Go through all visible tuples and move them to a new segfile.
 	 */
@@ -439,28 +601,55 @@ AppendOnlySegmentFileFullCompaction(Relation aorel,
 		aoTupleId = (AOTupleId *) &slot->tts_tid;
 		if (AppendOnlyVisimap_IsVisible(&scanDesc->visibilityMap, aoTupleId))
 		{
-			AppendOnlyMoveTuple(slot,
-								mt_bind,
-								insertDesc,
-								resultRelInfo,
-								estate);
+			if (sortstate)
+				AppendOnlyCompaction_SortTuple(sortstate, slot);
+			else
+				AppendOnlyMoveTuple(slot,
+									mt_bind,
+									insertDesc,
+									resultRelInfo,
+									estate);
 			movedTupleCount++;
 		}
 		else
 		{
 			/* Tuple is invisible and needs to be dropped */
 			AppendOnlyThrowAwayTuple(aorel, slot);
+			droppedTupleCount++;
 		}
 
 		/*
 		 * Check for vacuum delay point after approximately a var block
 		 */
 		tupleCount++;
-		if (VacuumCostActive && tupleCount % tuplePerPage == 0)
+		if (tupleCount % tuplePerPage == 0)
 		{
-			vacuum_delay_point();
+			AppendOnlyCompaction_DelayPoint(pagesPerDelayPoint,
+											droppedTupleCount);
+			droppedTupleCount = 0;
 		}
 	}
+	pgstat_progress_incr_param(PROGRESS_VACUUM_NUM_DEAD_TUPLES,
+							   droppedTupleCount);
+
+	if (sortstate)
+	{
+		tuplesort_performsort(sortstate);
+
+		while (AppendOnlyCompaction_FetchSortedTuple(sortstate, slot))
+		{
+			CHECK_FOR_INTERRUPTS();
+
+			AppendOnlyMoveTuple(slot,
+								mt_bind,
+								insertDesc,
+								resultRelInfo,
+								estate);
+		}
+
+		tuplesort_end(sortstate);
+		index_close(clusterIndex, AccessShareLock);
+	}
 
 	MarkFileSegInfoAwaitingDrop(aorel, compact_segno);
 
@@ -660,6 +660,193 @@ AppendOnlyBlockDirectory_GetEntry(
 	return false;
 }
 
+/*
+ * set_current_segfile
+ *
+ * Make the given segment file the current one of a block directory that
+ * was initialized for search. Returns false if the segment file is not
+ * known to the block directory, or has been compacted away.
+ */
+static bool
+set_current_segfile(AppendOnlyBlockDirectory *blockDirectory, int segno)
+{
+	int			i;
+
+	for (i = 0; i < blockDirectory->totalSegfiles; i++)
+	{
+		FileSegInfo *fsInfo = blockDirectory->segmentFileInfo[i];
+		int			fsSegno;
+		FileSegInfoState fsState;
+
+		if (blockDirectory->isAOCol)
+		{
+			fsSegno = ((AOCSFileSegInfo *) fsInfo)->segno;
+			fsState = ((AOCSFileSegInfo *) fsInfo)->state;
+		}
+		else
+		{
+			fsSegno = fsInfo->segno;
+			fsState = fsInfo->state;
+		}
+
+		if (fsSegno == segno)
+		{
+			if (fsState == AOSEG_STATE_AWAITING_DROP)
+				return false;
+
+			blockDirectory->currentSegmentFileNum = segno;
+			blockDirectory->currentSegmentFileInfo = fsInfo;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/*
+ * AppendOnlyBlockDirectory_GetMinipageRowRanges
+ *
+ * Walk through all the minipages of the given column group, in all the
+ * segment files of a block directory initialized for search, and return
+ * the number of rows each of them covers. Entries beyond the EOF of the
+ * segment file, left behind by aborted inserts, are not counted.
+ *
+ * The result is palloc'd in the caller's memory context, and is ordered by
+ * segment file and row number. The in-memory minipage of the column group
+ * is overwritten.
+ */
+MinipageRowRange *
+AppendOnlyBlockDirectory_GetMinipageRowRanges(AppendOnlyBlockDirectory *blockDirectory,
+											  int columnGroupNo,
+											  int *nranges)
+{
+	Relation	blkdirRel = blockDirectory->blkdirRel;
+	Relation	blkdirIdx = blockDirectory->blkdirIdx;
+	ScanKey		scanKeys = blockDirectory->scanKeys;
+	TupleDesc	heapTupleDesc;
+	MinipagePerColumnGroup *minipageInfo;
+	MinipageRowRange *ranges;
+	int			maxranges = 64;
+	int			i;
+
+	Assert(blkdirRel != NULL && blkdirIdx != NULL);
+	Assert(blockDirectory->minipages[columnGroupNo].minipage != NULL);
+
+	heapTupleDesc = RelationGetDescr(blkdirRel);
+	minipageInfo = &blockDirectory->minipages[columnGroupNo];
+
+	ranges = palloc(maxranges * sizeof(MinipageRowRange));
+	*nranges = 0;
+
+	for (i = 0; i < blockDirectory->totalSegfiles; i++)
+	{
+		FileSegInfo *fsInfo = blockDirectory->segmentFileInfo[i];
+		int			segno;
+		SysScanDesc idxScanDesc;
+		HeapTuple	tuple;
+
+		segno = blockDirectory->isAOCol ?
+			((AOCSFileSegInfo *) fsInfo)->segno : fsInfo->segno;
+
+		if (!set_current_segfile(blockDirectory, segno))
+			continue;
+
+		/* Only the (segno, columngroup_no) keys, to get all the minipages */
+		scanKeys[0].sk_argument = Int32GetDatum(segno);
+		scanKeys[1].sk_argument = Int32GetDatum(columnGroupNo);
+
+		idxScanDesc = systable_beginscan_ordered(blkdirRel, blkdirIdx,
+												 blockDirectory->appendOnlyMetaDataSnapshot,
+												 2, scanKeys);
+
+		while ((tuple = systable_getnext_ordered(idxScanDesc, ForwardScanDirection)) != NULL)
+		{
+			int64		rowCount = 0;
+			uint32		entry_no;
+
+			CHECK_FOR_INTERRUPTS();
+
+			extract_minipage(blockDirectory, tuple, heapTupleDesc, columnGroupNo);
+
+			if (minipageInfo->numMinipageEntries == 0)
+				continue;
+
+			for (entry_no = 0; entry_no < minipageInfo->numMinipageEntries; entry_no++)
+				rowCount += minipageInfo->minipage->entry[entry_no].rowCount;
+
+			if (*nranges >= maxranges)
+			{
+				maxranges *= 2;
+				ranges = repalloc(ranges, maxranges * sizeof(MinipageRowRange));
+			}
+			ranges[*nranges].segno = segno;
+			ranges[*nranges].firstRowNum = minipageInfo->minipage->entry[0].firstRowNum;
+			ranges[*nranges].rowCount = rowCount;
+			(*nranges)++;
+		}
+
+		systable_endscan_ordered(idxScanDesc);
+	}
+
+	/* The cached minipage no longer matches currentSegmentFileNum */
+	minipageInfo->numMinipageEntries = 0;
+	blockDirectory->currentSegmentFileNum = -1;
+	blockDirectory->currentSegmentFileInfo = NULL;
+
+	return ranges;
+}
+
+/*
+ * AppendOnlyBlockDirectory_LoadMinipage
+ *
+ * Load the minipage of the given column group whose first entry starts at
+ * 'firstRowNum' into memory, as returned by
+ * AppendOnlyBlockDirectory_GetMinipageRowRanges(). Returns NULL if there is
+ * no such minipage.
+ */
+MinipagePerColumnGroup *
+AppendOnlyBlockDirectory_LoadMinipage(AppendOnlyBlockDirectory *blockDirectory,
+									  int segno,
+									  int columnGroupNo,
+									  int64 firstRowNum)
+{
+	Relation	blkdirRel = blockDirectory->blkdirRel;
+	Relation	blkdirIdx = blockDirectory->blkdirIdx;
+	ScanKey		scanKeys = blockDirectory->scanKeys;
+	MinipagePerColumnGroup *minipageInfo;
+	SysScanDesc idxScanDesc;
+	HeapTuple	tuple;
+
+	Assert(blkdirRel != NULL && blkdirIdx != NULL);
+	Assert(blockDirectory->numScanKeys == 3);
+
+	if (!set_current_segfile(blockDirectory, segno))
+		return NULL;
+
+	minipageInfo = &blockDirectory->minipages[columnGroupNo];
+	minipageInfo->numMinipageEntries = 0;
+
+	scanKeys[0].sk_argument = Int32GetDatum(segno);
+	scanKeys[1].sk_argument = Int32GetDatum(columnGroupNo);
+	scanKeys[2].sk_argument = Int64GetDatum(firstRowNum);
+
+	idxScanDesc = systable_beginscan_ordered(blkdirRel, blkdirIdx,
+											 blockDirectory->appendOnlyMetaDataSnapshot,
+											 blockDirectory->numScanKeys, scanKeys);
+
+	tuple = systable_getnext_ordered(idxScanDesc, BackwardScanDirection);
+	if (tuple != NULL)
+		extract_minipage(blockDirectory, tuple,
+						 RelationGetDescr(blkdirRel), columnGroupNo);
+
+	systable_endscan_ordered(idxScanDesc);
+
+	if (minipageInfo->numMinipageEntries == 0)
+		return NULL;
+
+	return minipageInfo;
+}
+
 /*
  * AppendOnlyBlockDirectory_InsertEntry
  *
@@ -16,9 +16,11 @@
 #include "postgres.h"
 
 #include "access/printtup.h"
+#include "cdb/cdbvars.h"
 #include "libpq/libpq.h"
 #include "libpq/pqformat.h"
 #include "tcop/pquery.h"
+#include "utils/date.h"
 #include "utils/lsyscache.h"
 #include "utils/memdebug.h"
 #include "utils/memutils.h"
@@ -174,6 +176,14 @@ printtup_startup(DestReceiver *self, int operation pg_attribute_unused(), TupleD
 								  FetchPortalTargetList(portal),
 								  portal->formats);
 
+	/*
+	 * The rows are only sent when the send buffer is full, a large result
+	 * set goes out with fewer system calls through a larger buffer.  Only
+	 * the QD talks to clients, a QE's results go through the interconnect.
+	 */
+	if (Gp_role == GP_ROLE_DISPATCH)
+		pq_setsendbuffersize(gp_client_send_buffer_size * 1024);
+
 	/* ----------------
 	 * We could set up the derived attr info at this time, but we postpone it
 	 * until the first call of printtup, for 2 reasons:
@@ -481,18 +491,24 @@ printtup(TupleTableSlot *slot, DestReceiver *self)
 #error BYTE_ORDER must be BIG_ENDIAN or LITTLE_ENDIAN
 #endif
 					appendBinaryStringInfo(buf, (char *) &n32, 4);
-					appendBinaryStringInfo(buf, str, strlen(str));
+					appendBinaryStringInfo(buf, str, sp - str);
 				}
 				break;
 			case INT8OID: /* int8 */
+			case OIDOID: /* oid */
 				{
 					char tmp[33];
 					char *tp = tmp;
 					char *sp;
 					uint64 v;
 					long li = 0;
-					int64 value =DatumGetInt64(attr);
-					bool sign = (value < 0);
+					int64 value;
+					bool sign;
+					if (fatt->atttypid == OIDOID)
+						value = (int64) DatumGetObjectId(attr);
+					else
+						value = DatumGetInt64(attr);
+					sign = (value < 0);
 					if (sign)
 						v = -value;
 					else
@@ -515,10 +531,15 @@ printtup(TupleTableSlot *slot, DestReceiver *self)
 					n32 = (uint32) (sp-str);
 #endif
 					appendBinaryStringInfo(buf, (char *) &n32, 4);
-					appendBinaryStringInfo(buf, str, strlen(str));
+					appendBinaryStringInfo(buf, str, sp - str);
 				}
 				break;
 
+			case BOOLOID: /* bool, a substitute for calling boolout() */
+				pq_sendint32(buf, 1);
+				pq_sendbyte(buf, DatumGetBool(attr) ? 't' : 'f');
+				break;
+
 			case VARCHAROID:
 			case TEXTOID:
 			case BPCHAROID:
@@ -612,6 +633,36 @@ printtup(TupleTableSlot *slot, DestReceiver *self)
 				}
 				break;
 
+			/*
+			 * The send functions of these types build a bytea for every
+			 * value, write their fixed-size representation directly instead.
+			 */
+			case BOOLOID: /* boolsend() */
+				pq_sendint32(buf, 1);
+				pq_sendbyte(buf, DatumGetBool(attr) ? 1 : 0);
+				break;
+			case OIDOID: /* oidsend() */
+				pq_sendint32(buf, 4);
+				pq_sendint32(buf, DatumGetObjectId(attr));
+				break;
+			case DATEOID: /* date_send() */
+				pq_sendint32(buf, 4);
+				pq_sendint32(buf, DatumGetDateADT(attr));
+				break;
+			case FLOAT4OID: /* float4send() */
+				pq_sendint32(buf, 4);
+				pq_sendfloat4(buf, DatumGetFloat4(attr));
+				break;
+			case FLOAT8OID: /* float8send() */
+				pq_sendint32(buf, 8);
+				pq_sendfloat8(buf, DatumGetFloat8(attr));
+				break;
+			case TIMESTAMPOID: /* timestamp_send() */
+			case TIMESTAMPTZOID: /* timestamptz_send() */
+				pq_sendint32(buf, 8);
+				pq_sendint64(buf, DatumGetInt64(attr));
+				break;
+
 			case VARCHAROID:
 			case TEXTOID:
 			case BPCHAROID:
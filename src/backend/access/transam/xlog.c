@@ -7954,6 +7954,7 @@ StartupXLOG(void)
 	LWLockAcquire(ProcArrayLock, LW_EXCLUSIVE);
 	ShmemVariableCache->latestCompletedXid = XidFromFullTransactionId(ShmemVariableCache->nextFullXid);
 	ShmemVariableCache->latestCompletedGxid = ShmemVariableCache->nextGxid;
+	ShmemVariableCache->gxactCompletionCount++;
 	TransactionIdRetreat(ShmemVariableCache->latestCompletedXid);
 	if (IsNormalProcessingMode())
 		elog(LOG, "latest completed transaction id is %u and next transaction id is %u",
@@ -953,6 +953,42 @@ CREATE VIEW gp_stat_replication AS
          ON G.gp_segment_id = R.gp_segment_id
     );
 
+-- UDP interconnect RTT and retransmit histograms of the whole cluster
+CREATE FUNCTION gp_get_segment_interconnect_udp_stats (OUT gp_segment_id int, OUT metric text, OUT bucket text, OUT count int8)
+RETURNS SETOF RECORD
+AS 'SELECT pg_catalog.gp_execution_segment() as gp_segment_id, * FROM pg_catalog.gp_get_interconnect_udp_stats()'
+LANGUAGE SQL EXECUTE ON ALL SEGMENTS;
+
+CREATE VIEW gp_stat_interconnect_udp AS
+    SELECT pg_catalog.gp_execution_segment() AS gp_segment_id, *
+    FROM pg_catalog.gp_get_interconnect_udp_stats()
+    UNION ALL
+    SELECT * FROM pg_catalog.gp_get_segment_interconnect_udp_stats();
+
+-- FTS probe latency histogram and probe outcomes
+CREATE VIEW gp_stat_fts_probe AS
+    SELECT * FROM pg_catalog.gp_get_fts_probe_stats();
+
+-- QEs cached and gangs allocated by the sessions of each database and role
+CREATE VIEW gp_stat_qe_pool AS
+    SELECT
+            P.datid,
+            D.datname,
+            P.usesysid,
+            U.rolname AS usename,
+            P.idle_readers,
+            P.idle_writers,
+            P.hits,
+            P.misses,
+            CASE WHEN P.hits + P.misses > 0
+                 THEN P.hits::float8 / (P.hits + P.misses) END AS hit_ratio,
+            P.evictions,
+            P.gangs,
+            P.gang_setup_time
+    FROM pg_catalog.gp_get_qe_pool_stats() AS P
+            LEFT JOIN pg_database AS D ON (P.datid = D.oid)
+            LEFT JOIN pg_authid AS U ON (P.usesysid = U.oid);
+
 CREATE VIEW pg_stat_wal_receiver AS
     SELECT
             s.pid,
@@ -1342,6 +1378,9 @@ CREATE VIEW pg_stat_progress_vacuum AS
                       WHEN 4 THEN 'cleaning up indexes'
                       WHEN 5 THEN 'truncating heap'
                       WHEN 6 THEN 'performing final cleanup'
+                      WHEN 7 THEN 'append-optimized pre-cleanup'
+                      WHEN 8 THEN 'append-optimized compact'
+                      WHEN 9 THEN 'append-optimized post-cleanup'
                       END AS phase,
         S.param2 AS heap_blks_total, S.param3 AS heap_blks_scanned,
         S.param4 AS heap_blks_vacuumed, S.param5 AS index_vacuum_count,
@@ -635,6 +635,22 @@ cdbCopyEndInternal(CdbCopy *c, char *abort_msg,
 			if (res->numCompleted > 0)
 				segment_rows_completed = res->numCompleted;
 
+			/*
+			 * Like the dispatcher does, note whether the QE wrote xlog, so
+			 * that the transaction is committed in two phases, and whether
+			 * its segment can vote read-only.
+			 */
+			if (q->conn->wrote_xlog || q->conn->assigned_xid)
+			{
+				markGxactSegmentWrote(q->segindex);
+				q->conn->assigned_xid = false;
+			}
+			if (q->conn->wrote_xlog)
+			{
+				MarkTopTransactionWriteXLogOnExecutor();
+				q->conn->wrote_xlog = false;
+			}
+
 			/* free the PGresult object */
 			PQclear(res);
 		}
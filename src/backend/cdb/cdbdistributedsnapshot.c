@@ -23,6 +23,82 @@
 #include "utils/snapmgr.h"
 #include "storage/procarray.h"
 
+/*
+ * Binary search of a sorted array of distributed xids.
+ */
+static inline bool
+DistribXidArrayFind(DistributedTransactionId *xids, int32 count,
+					DistributedTransactionId xid)
+{
+	int32		low = 0;
+	int32		high = count - 1;
+
+	while (low <= high)
+	{
+		int32		mid = low + (high - low) / 2;
+
+		if (xids[mid] == xid)
+			return true;
+		if (xids[mid] < xid)
+			low = mid + 1;
+		else
+			high = mid - 1;
+	}
+
+	return false;
+}
+
+/*
+ * Binary search of the local xids mapped so far, which are kept sorted by
+ * their plain value: only equality matters here, so there is no need for the
+ * wraparound-aware comparison.
+ *
+ * Returns the index of the xid, or -(insertion point) - 1 if not found.
+ */
+static inline int32
+LocalXidArrayFind(TransactionId *xids, int32 count, TransactionId xid)
+{
+	int32		low = 0;
+	int32		high = count - 1;
+
+	while (low <= high)
+	{
+		int32		mid = low + (high - low) / 2;
+
+		if (xids[mid] == xid)
+			return mid;
+		if (xids[mid] < xid)
+			low = mid + 1;
+		else
+			high = mid - 1;
+	}
+
+	return -low - 1;
+}
+
+/*
+ * Add a local xid of an in-progress distributed transaction to the sorted
+ * inProgressMappedLocalXids of the snapshot.
+ */
+static void
+LocalXidArrayInsert(DistributedSnapshotWithLocalMapping *dslm,
+					TransactionId localXid)
+{
+	int32		pos;
+
+	pos = LocalXidArrayFind(dslm->inProgressMappedLocalXids,
+							dslm->currentLocalXidsCount, localXid);
+	if (pos >= 0)
+		return;
+	pos = -pos - 1;
+
+	memmove(&dslm->inProgressMappedLocalXids[pos + 1],
+			&dslm->inProgressMappedLocalXids[pos],
+			(dslm->currentLocalXidsCount - pos) * sizeof(TransactionId));
+	dslm->inProgressMappedLocalXids[pos] = localXid;
+	dslm->currentLocalXidsCount++;
+}
+
 /*
  * DistributedSnapshotWithLocalMapping_CommittedTest
  *		Is the given XID still-in-progress according to the
@@ -36,7 +112,6 @@ DistributedSnapshotWithLocalMapping_CommittedTest(
 												  bool isVacuumCheck)
 {
 	DistributedSnapshot *ds = &dslm->ds;
-	uint32		i;
 	DistributedTransactionId distribXid = InvalidDistributedTransactionId;
 
 	Assert(!IS_QUERY_DISPATCHER());
@@ -67,14 +142,12 @@ DistributedSnapshotWithLocalMapping_CommittedTest(
 		if (TransactionIdFollows(localXid, dslm->minCachedLocalXid) &&
 			TransactionIdPrecedes(localXid, dslm->maxCachedLocalXid))
 		{
-			for (i = 0; i < dslm->currentLocalXidsCount; i++)
-			{
-				Assert(dslm->inProgressMappedLocalXids != NULL);
-				Assert(TransactionIdIsValid(dslm->inProgressMappedLocalXids[i]));
+			Assert(dslm->inProgressMappedLocalXids != NULL);
 
-				if (TransactionIdEquals(localXid, dslm->inProgressMappedLocalXids[i]))
-					return DISTRIBUTEDSNAPSHOT_COMMITTED_INPROGRESS;
-			}
+			if (LocalXidArrayFind(dslm->inProgressMappedLocalXids,
+								  dslm->currentLocalXidsCount,
+								  localXid) >= 0)
+				return DISTRIBUTEDSNAPSHOT_COMMITTED_INPROGRESS;
 		}
 	}
 
@@ -126,8 +199,33 @@ DistributedSnapshotWithLocalMapping_CommittedTest(
 			 * The distributedlog doesn't know of the transaction. It can be
 			 * local-only, or still in-progress. The caller will proceed to do
 			 * a local visibility check, which will determine which it is.
+			 *
+			 * A distributed transaction is marked in the distributedlog
+			 * before the clog.  So once the clog says committed, a
+			 * distributedlog lookup made after that sees the entry of a
+			 * distributed commit, and if it still finds nothing the
+			 * transaction is local-only for good.  The lookup above doesn't
+			 * count, as it was made before the clog check: a distributed
+			 * commit landing between the two would look local-only.
+			 * Remember a local-only transaction, so the next tuple of the
+			 * same transaction doesn't go through the distributedlog SLRU
+			 * again.
 			 */
-			return DISTRIBUTEDSNAPSHOT_COMMITTED_UNKNOWN;
+			if (!TransactionIdDidCommit(localXid))
+				return DISTRIBUTEDSNAPSHOT_COMMITTED_UNKNOWN;
+
+			if (!DistributedLog_CommittedCheck(localXid, &distribXid))
+			{
+				LocalDistribXactCache_AddCommitted(localXid,
+												   InvalidDistributedTransactionId);
+
+				return DISTRIBUTEDSNAPSHOT_COMMITTED_IGNORE;
+			}
+
+			/* committed distributed after all */
+			Assert(distribXid != InvalidDistributedTransactionId);
+			LocalDistribXactCache_AddCommitted(localXid,
+											   distribXid);
 		}
 	}
 
@@ -166,45 +264,36 @@ DistributedSnapshotWithLocalMapping_CommittedTest(
 		return DISTRIBUTEDSNAPSHOT_COMMITTED_INPROGRESS;
 	}
 
-	for (i = 0; i < ds->count; i++)
+	/*
+	 * ds->inProgressXidArray is sorted in ascending order while creating the
+	 * snapshot in CreateDistributedSnapshot(), so a binary search will do.
+	 */
+	if (DistribXidArrayFind(ds->inProgressXidArray, ds->count, distribXid))
 	{
-		if (distribXid == ds->inProgressXidArray[i])
+		/*
+		 * Save the relationship to the local xid so we may avoid checking
+		 * the distributed committed log in a subsequent check. We can only
+		 * record local xids till cache size permits.
+		 */
+		if (dslm->currentLocalXidsCount < ds->count)
 		{
-			/*
-			 * Save the relationship to the local xid so we may avoid checking
-			 * the distributed committed log in a subsequent check. We can
-			 * only record local xids till cache size permits.
-			 */
-			if (dslm->currentLocalXidsCount < ds->count)
+			Assert(dslm->inProgressMappedLocalXids != NULL);
+			LocalXidArrayInsert(dslm, localXid);
+
+			if (!TransactionIdIsValid(dslm->minCachedLocalXid) ||
+				TransactionIdPrecedes(localXid, dslm->minCachedLocalXid))
 			{
-				Assert(dslm->inProgressMappedLocalXids != NULL);
-				dslm->inProgressMappedLocalXids[dslm->currentLocalXidsCount++] =
-					localXid;
-
-				if (!TransactionIdIsValid(dslm->minCachedLocalXid) ||
-					TransactionIdPrecedes(localXid, dslm->minCachedLocalXid))
-				{
-					dslm->minCachedLocalXid = localXid;
-				}
-
-				if (!TransactionIdIsValid(dslm->maxCachedLocalXid) ||
-					TransactionIdFollows(localXid, dslm->maxCachedLocalXid))
-				{
-					dslm->maxCachedLocalXid = localXid;
-				}
+				dslm->minCachedLocalXid = localXid;
 			}
 
-			return DISTRIBUTEDSNAPSHOT_COMMITTED_INPROGRESS;
+			if (!TransactionIdIsValid(dslm->maxCachedLocalXid) ||
+				TransactionIdFollows(localXid, dslm->maxCachedLocalXid))
+			{
+				dslm->maxCachedLocalXid = localXid;
+			}
 		}
 
-		/*
-		 * Leverage the fact that ds->inProgressXidArray is sorted in
-		 * ascending order based on distribXid while creating the snapshot in
-		 * CreateDistributedSnapshot(). So, can fail fast once known are
-		 * lower than rest of them.
-		 */
-		if (distribXid < ds->inProgressXidArray[i])
-			break;
+		return DISTRIBUTEDSNAPSHOT_COMMITTED_INPROGRESS;
 	}
 
 	/*
@@ -15,6 +15,7 @@
 
 #include "postgres.h"
 
+#include "funcapi.h"
 #include "miscadmin.h"
 #include "libpq-fe.h"
 #include "libpq-int.h"
@@ -35,8 +36,10 @@
 
 #include "postmaster/fts.h"
 
+#include "utils/builtins.h"
 #include "utils/fmgroids.h"
 #include "catalog/pg_authid.h"
+#include "catalog/pg_type.h"
 
 /* segment id for the master */
 #define MASTER_SEGMENT_ID -1
@@ -45,6 +48,15 @@ volatile FtsProbeInfo *ftsProbeInfo = NULL;	/* Probe process updates this struct
 
 extern volatile pid_t *shmFtsProbePID;
 
+static const char *const fts_latency_hist_labels[FTS_LATENCY_HIST_BUCKETS] = {
+	"<1ms", "1ms", "2ms", "4ms", "8ms", "16ms",
+	"32ms", "64ms", "128ms", "256ms", "512ms", ">=1024ms"
+};
+
+static const char *const fts_probe_outcome_labels[FTS_PROBE_OUTCOMES] = {
+	"succeeded", "retried", "failed"
+};
+
 /*
  * get fts share memory size
  */
@@ -71,6 +83,74 @@ FtsShmemInit(void)
 
 	if (!IsUnderPostmaster)
 		shared->fts_probe_info.status_version = 0;
+
+	if (!found)
+	{
+		int			i;
+
+		for (i = 0; i < FTS_LATENCY_HIST_BUCKETS; i++)
+			pg_atomic_init_u64(&shared->fts_probe_info.latency_hist[i], 0);
+		for (i = 0; i < FTS_PROBE_OUTCOMES; i++)
+			pg_atomic_init_u64(&shared->fts_probe_info.outcomes[i], 0);
+	}
+}
+
+/*
+ * gp_get_fts_probe_stats
+ * 		Return the FTS probe statistics, one row per bucket: the "latency"
+ * 		buckets first, then the "outcome" buckets.
+ */
+Datum
+gp_get_fts_probe_stats(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *funcctx;
+	int			idx;
+	Datum		values[3];
+	bool		nulls[3];
+	HeapTuple	tuple;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		MemoryContext oldcontext;
+		TupleDesc	tupdesc;
+
+		funcctx = SRF_FIRSTCALL_INIT();
+		oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+		tupdesc = CreateTemplateTupleDesc(3);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 1, "metric", TEXTOID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 2, "bucket", TEXTOID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 3, "count", INT8OID, -1, 0);
+		funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+		funcctx->max_calls = FTS_LATENCY_HIST_BUCKETS + FTS_PROBE_OUTCOMES;
+
+		MemoryContextSwitchTo(oldcontext);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+
+	if (funcctx->call_cntr >= funcctx->max_calls)
+		SRF_RETURN_DONE(funcctx);
+
+	idx = funcctx->call_cntr;
+	MemSet(nulls, 0, sizeof(nulls));
+
+	if (idx < FTS_LATENCY_HIST_BUCKETS)
+	{
+		values[0] = CStringGetTextDatum("latency");
+		values[1] = CStringGetTextDatum(fts_latency_hist_labels[idx]);
+		values[2] = Int64GetDatum((int64) pg_atomic_read_u64(&ftsProbeInfo->latency_hist[idx]));
+	}
+	else
+	{
+		idx -= FTS_LATENCY_HIST_BUCKETS;
+		values[0] = CStringGetTextDatum("outcome");
+		values[1] = CStringGetTextDatum(fts_probe_outcome_labels[idx]);
+		values[2] = Int64GetDatum((int64) pg_atomic_read_u64(&ftsProbeInfo->outcomes[idx]));
+	}
+
+	tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+	SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
 }
 
 /* see src/backend/fts/README */
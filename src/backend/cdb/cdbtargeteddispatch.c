@@ -27,6 +27,7 @@
 #include "catalog/pg_type.h"
 
 #include "catalog/pg_proc.h"
+#include "utils/array.h"
 #include "utils/syscache.h"
 #include "utils/lsyscache.h"
 
@@ -55,6 +56,7 @@ typedef struct PartitionKeyInfo
 	Node	  **values;
 	int			counter;
 	int			numValues;
+	List	   *paramValues;	/* if the values are only known at execution */
 } PartitionKeyInfo;
 
 /**
@@ -65,6 +67,10 @@ InitDirectDispatchCalculationInfo(DirectDispatchInfo *data)
 {
 	data->isDirectDispatch = false;
 	data->contentIds = NULL;
+	data->paramKeyValues = NIL;
+	data->paramKeyTypes = NIL;
+	data->paramKeyHashFuncs = NIL;
+	data->paramKeyNumSegments = 0;
 	data->haveProcessedAnyCalculations = false;
 }
 
@@ -76,9 +82,170 @@ DisableTargetedDispatch(DirectDispatchInfo *data)
 {
 	data->isDirectDispatch = false;
 	data->contentIds = NULL;
+	data->paramKeyValues = NIL;
+	data->paramKeyTypes = NIL;
+	data->paramKeyHashFuncs = NIL;
+	data->paramKeyNumSegments = 0;
 	data->haveProcessedAnyCalculations = true;
 }
 
+/*
+ * Is 'val' something that the executor can resolve to values of 'keytype'
+ * when it sets up the slice table: a Const or a parameter of that type, or
+ * an array of that type?
+ */
+static bool
+IsParamKeyValue(Node *val, Oid keytype)
+{
+	Oid			valtype = exprType(val);
+
+	if (IsA(val, Param))
+	{
+		if (((Param *) val)->paramkind != PARAM_EXTERN)
+			return false;
+	}
+	else if (!IsA(val, Const))
+		return false;
+
+	return valtype == keytype || get_element_type(valtype) == keytype;
+}
+
+/*
+ * Is 'opno' an equality operator between two values of 'keytype'?
+ */
+static bool
+IsKeyEqualityOp(Oid opno, Oid keytype)
+{
+	List	   *op_infos = get_op_btree_interpretation(opno);
+	ListCell   *lc;
+
+	foreach(lc, op_infos)
+	{
+		OpBtreeInterpretation *op_info = lfirst(lc);
+
+		if (op_info->strategy == BTEqualStrategyNumber &&
+			op_info->oplefttype == keytype &&
+			op_info->oprighttype == keytype)
+			return true;
+	}
+	return false;
+}
+
+/*
+ * Find the values that 'var', a distribution key column, can be equal to
+ * according to 'clause', when some of them are parameters or arrays.  That
+ * complements DeterminePossibleValueSet(), which only knows about Consts.
+ *
+ * Recognizes "var = $1", "var IN ($1, $2, ...)", "var = ANY ($1)", and ANDs
+ * and ORs of those.  Returns a list of values for IsParamKeyValue(), or NIL
+ * if 'var' can have any value.
+ */
+static List *
+GetParamKeyValues(Node *clause, Var *var)
+{
+	Oid			keytype = var->vartype;
+	Node	   *leftop;
+	Node	   *rightop;
+
+	if (clause == NULL)
+		return NIL;
+
+	if (IsA(clause, List) || is_andclause(clause))
+	{
+		List	   *args = IsA(clause, List) ? (List *) clause : ((BoolExpr *) clause)->args;
+		ListCell   *lc;
+
+		/* any of the ANDed clauses limits the values, take the first one */
+		foreach(lc, args)
+		{
+			List	   *values = GetParamKeyValues(lfirst(lc), var);
+
+			if (values != NIL)
+				return values;
+		}
+		return NIL;
+	}
+
+	if (is_orclause(clause))
+	{
+		List	   *result = NIL;
+		ListCell   *lc;
+
+		foreach(lc, ((BoolExpr *) clause)->args)
+		{
+			List	   *values = GetParamKeyValues(lfirst(lc), var);
+
+			if (values == NIL)
+				return NIL;
+			result = list_concat(result, values);
+		}
+		return result;
+	}
+
+	if (IsA(clause, OpExpr))
+	{
+		OpExpr	   *opexpr = (OpExpr *) clause;
+
+		if (list_length(opexpr->args) != 2 ||
+			!IsKeyEqualityOp(opexpr->opno, keytype))
+			return NIL;
+
+		leftop = linitial(opexpr->args);
+		rightop = lsecond(opexpr->args);
+		if (IsA(leftop, RelabelType))
+			leftop = (Node *) ((RelabelType *) leftop)->arg;
+		if (IsA(rightop, RelabelType))
+			rightop = (Node *) ((RelabelType *) rightop)->arg;
+
+		if (equal(leftop, var) && IsParamKeyValue(rightop, keytype) &&
+			exprType(rightop) == keytype)
+			return list_make1(rightop);
+		if (equal(rightop, var) && IsParamKeyValue(leftop, keytype) &&
+			exprType(leftop) == keytype)
+			return list_make1(leftop);
+		return NIL;
+	}
+
+	if (IsA(clause, ScalarArrayOpExpr))
+	{
+		ScalarArrayOpExpr *saop = (ScalarArrayOpExpr *) clause;
+
+		if (!saop->useOr || !IsKeyEqualityOp(saop->opno, keytype))
+			return NIL;
+
+		leftop = linitial(saop->args);
+		rightop = lsecond(saop->args);
+		if (IsA(leftop, RelabelType))
+			leftop = (Node *) ((RelabelType *) leftop)->arg;
+		if (!equal(leftop, var))
+			return NIL;
+
+		if (IsA(rightop, ArrayExpr) && !((ArrayExpr *) rightop)->multidims)
+		{
+			List	   *result = NIL;
+			ListCell   *lc;
+
+			foreach(lc, ((ArrayExpr *) rightop)->elements)
+			{
+				Node	   *elem = lfirst(lc);
+
+				if (!IsParamKeyValue(elem, keytype) || exprType(elem) != keytype)
+					return NIL;
+				result = lappend(result, elem);
+			}
+			return result;
+		}
+
+		if (IsParamKeyValue(rightop, keytype) &&
+			get_element_type(exprType(rightop)) == keytype)
+			return list_make1(rightop);
+		return NIL;
+	}
+
+	return NIL;
+}
+
+
 /**
  * helper function for AssignContentIdsFromUpdateDeleteQualification
  */
@@ -130,6 +297,7 @@ GetContentIdsFromPlanForSingleRelation(PlannerInfo *root, Plan *plan, int rangeT
 				parts[i].values = NULL;
 				parts[i].numValues = 0;
 				parts[i].counter = 0;
+				parts[i].paramValues = NIL;
 			}
 		}
 	}
@@ -210,6 +378,7 @@ GetContentIdsFromPlanForSingleRelation(PlannerInfo *root, Plan *plan, int rangeT
 	if (GpPolicyIsHashPartitioned(policy))
 	{
 		long		totalCombinations = 1;
+		bool		hasParamValues = false;
 
 		Assert(parts != NULL);
 
@@ -235,11 +404,20 @@ GetContentIdsFromPlanForSingleRelation(PlannerInfo *root, Plan *plan, int rangeT
 
 			if (pvs.isAnyValuePossible)
 			{
+				DeletePossibleValueSetData(&pvs);
+
+				/* maybe the executor can tell, from the parameter values */
+				parts[i].paramValues = GetParamKeyValues((Node *) qualification, var);
+				if (parts[i].paramValues != NIL)
+				{
+					hasParamValues = true;
+					continue;
+				}
+
 				/*
 				 * can't isolate to single statement -- totalCombinations = -1
 				 * will signal this
 				 */
-				DeletePossibleValueSetData(&pvs);
 				totalCombinations = -1;
 				break;
 			}
@@ -266,6 +444,33 @@ GetContentIdsFromPlanForSingleRelation(PlannerInfo *root, Plan *plan, int rangeT
 													 * specific content at
 													 * all! */
 		}
+		else if (totalCombinations > 0 && hasParamValues)
+		{
+			/*
+			 * leave it to the executor to hash the values, once it knows the
+			 * parameters
+			 */
+			for (i = 0; i < policy->nattrs; i++)
+			{
+				Oid			keytype = parts[i].attr->atttypid;
+				List	   *values = parts[i].paramValues;
+
+				if (values == NIL)
+				{
+					for (int j = 0; j < parts[i].numValues; j++)
+						values = lappend(values, parts[i].values[j]);
+				}
+
+				result.paramKeyValues = lappend(result.paramKeyValues, values);
+				result.paramKeyTypes = lappend_oid(result.paramKeyTypes, keytype);
+				result.paramKeyHashFuncs =
+					lappend_oid(result.paramKeyHashFuncs,
+								cdb_hashproc_in_opfamily(get_opclass_family(policy->opclasses[i]),
+														 keytype));
+			}
+			result.paramKeyNumSegments = policy->numsegments;
+			result.isDirectDispatch = false;
+		}
 		else if (totalCombinations > 0 &&
 			/* don't bother for ones which will likely hash to many segments */
 				 totalCombinations < policy->numsegments * 3)
@@ -334,6 +539,29 @@ GetContentIdsFromPlanForSingleRelation(PlannerInfo *root, Plan *plan, int rangeT
 void
 MergeDirectDispatchCalculationInfo(DirectDispatchInfo *to, DirectDispatchInfo *from)
 {
+	/*
+	 * Segments computed from parameter values are only supported for a
+	 * slice that learns nothing else, except the same again, as from the
+	 * scans of the partitions of a table.
+	 */
+	if (from->paramKeyValues != NIL && !to->haveProcessedAnyCalculations)
+	{
+		*to = *from;
+		return;
+	}
+	if (from->paramKeyValues != NIL &&
+		equal(to->paramKeyValues, from->paramKeyValues) &&
+		equal(to->paramKeyHashFuncs, from->paramKeyHashFuncs) &&
+		to->paramKeyNumSegments == from->paramKeyNumSegments)
+		return;
+	if (to->haveProcessedAnyCalculations)
+	{
+		to->paramKeyValues = NIL;
+		to->paramKeyTypes = NIL;
+		to->paramKeyHashFuncs = NIL;
+		to->paramKeyNumSegments = 0;
+	}
+
 	if (!from->isDirectDispatch)
 	{
 		/* from eliminates all options so take it */
@@ -366,6 +594,163 @@ MergeDirectDispatchCalculationInfo(DirectDispatchInfo *to, DirectDispatchInfo *f
 	to->haveProcessedAnyCalculations = true;
 }
 
+/*
+ * Add the values that 'val', a Const or Param planned by GetParamKeyValues(),
+ * stands for to 'values', as Consts of 'keytype'.
+ *
+ * Returns false if the parameter is not available or not of the planned type.
+ */
+static bool
+ResolveParamKeyValue(Node *val, Oid keytype, ParamListInfo params, List **values)
+{
+	Oid			valtype = exprType(val);
+	Datum		value;
+	bool		isnull;
+	int16		typlen;
+	bool		typbyval;
+	char		typalign;
+
+	if (IsA(val, Const))
+	{
+		value = ((Const *) val)->constvalue;
+		isnull = ((Const *) val)->constisnull;
+	}
+	else
+	{
+		Param	   *param = castNode(Param, val);
+		ParamExternData *prm;
+		ParamExternData prmdata;
+
+		Assert(param->paramkind == PARAM_EXTERN);
+
+		if (params == NULL || param->paramid <= 0 || param->paramid > params->numParams)
+			return false;
+		if (params->paramFetch != NULL)
+			prm = params->paramFetch(params, param->paramid, false, &prmdata);
+		else
+			prm = &params->params[param->paramid - 1];
+		if (prm->ptype != param->paramtype)
+			return false;
+
+		value = prm->value;
+		isnull = prm->isnull;
+	}
+
+	get_typlenbyvalalign(keytype, &typlen, &typbyval, &typalign);
+
+	if (valtype != keytype && get_element_type(valtype) == keytype)
+	{
+		/* "= ANY (array)": each non-NULL element is a possible value */
+		Datum	   *elems;
+		bool	   *elemnulls;
+		int			nelems;
+
+		if (isnull)
+			return true;
+
+		deconstruct_array(DatumGetArrayTypeP(value), keytype,
+						  typlen, typbyval, typalign,
+						  &elems, &elemnulls, &nelems);
+		for (int i = 0; i < nelems; i++)
+		{
+			if (!elemnulls[i])
+				*values = lappend(*values, makeConst(keytype, -1, InvalidOid, typlen,
+													 elems[i], false, typbyval));
+		}
+	}
+	else if (IsA(val, Const))
+	{
+		/* planned Consts are already what the distribution key hashes */
+		*values = lappend(*values, val);
+	}
+	else if (!isnull)
+	{
+		/* "= NULL" is never true, so a NULL parameter adds no value */
+		*values = lappend(*values, makeConst(keytype, -1, InvalidOid, typlen,
+											 value, false, typbyval));
+	}
+
+	return true;
+}
+
+/*
+ * Compute the segments to dispatch a slice to, from the values of the
+ * parameters that its distribution key values depend on (see
+ * DirectDispatchInfo.paramKeyValues).  Called by the executor when it sets up
+ * the slice table.
+ *
+ * Returns false if the slice must be dispatched to all of its segments.
+ */
+bool
+GetContentIdsFromParams(DirectDispatchInfo *dd, ParamListInfo params,
+						List **contentIds)
+{
+	int			nattrs = list_length(dd->paramKeyValues);
+	List	  **values;
+	Oid		   *hashfuncs;
+	long		totalCombinations = 1;
+	CdbHash    *h;
+	ListCell   *lcv,
+			   *lct,
+			   *lch;
+	int			i;
+
+	Assert(nattrs > 0);
+
+	values = (List **) palloc0(nattrs * sizeof(List *));
+	hashfuncs = (Oid *) palloc(nattrs * sizeof(Oid));
+
+	i = 0;
+	forthree(lcv, dd->paramKeyValues, lct, dd->paramKeyTypes, lch, dd->paramKeyHashFuncs)
+	{
+		Oid			keytype = lfirst_oid(lct);
+		ListCell   *lc;
+
+		foreach(lc, (List *) lfirst(lcv))
+		{
+			if (!ResolveParamKeyValue(lfirst(lc), keytype, params, &values[i]))
+				return false;
+		}
+
+		hashfuncs[i] = lfirst_oid(lch);
+		totalCombinations *= list_length(values[i]);
+
+		/* don't bother for ones which will likely hash to many segments */
+		if (totalCombinations >= dd->paramKeyNumSegments * 3)
+			return false;
+		i++;
+	}
+
+	if (totalCombinations == 0)
+	{
+		/* no row can match, any one segment will do */
+		*contentIds = list_make1_int(cdbhashrandomseg(dd->paramKeyNumSegments));
+		return true;
+	}
+
+	h = makeCdbHash(dd->paramKeyNumSegments, nattrs, hashfuncs);
+
+	*contentIds = NIL;
+	for (long index = 0; index < totalCombinations; index++)
+	{
+		long		curIndex = index;
+
+		cdbhashinit(h);
+		for (i = 0; i < nattrs; i++)
+		{
+			int			numValues = list_length(values[i]);
+			Const	   *c = (Const *) list_nth(values[i], curIndex % numValues);
+
+			cdbhash(h, i + 1, c->constvalue, c->constisnull);
+			curIndex /= numValues;
+		}
+
+		*contentIds = list_append_unique_int(*contentIds, cdbhashreduce(h));
+	}
+
+	return true;
+}
+
 /**
  * returns true if we should print test messages.  Note for clients: for multi-slice queries then messages will print in
  *   the order of processing which may not always be deterministic (single joins can be rearranged by the planner,
@@ -401,6 +786,11 @@ FinalizeDirectDispatchDataForSlice(PlanSlice *slice)
 					elog(INFO, "DDCR learned dispatch to content %d", linitial_int(dd->contentIds));
 			}
 		}
+		else if (dd->paramKeyValues != NIL)
+		{
+			if (ShouldPrintTestMessages())
+				elog(INFO, "DDCR learned dispatch depends on parameters");
+		}
 		else
 		{
 			if (ShouldPrintTestMessages())
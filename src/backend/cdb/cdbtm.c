@@ -119,6 +119,7 @@ int gp_gxid_prefetch_num;
 static void doPrepareTransaction(void);
 static void doInsertForgetCommitted(void);
 static void doNotifyingOnePhaseCommit(void);
+static void doNotifyingReadOnlyCommit(List *readOnlySegments);
 static void doNotifyingCommitPrepared(void);
 static void doNotifyingAbort(void);
 static void retryAbortPrepared(void);
@@ -538,6 +539,54 @@ doNotifyingOnePhaseCommit(void)
 	}
 }
 
+/*
+ * Commit the segments that voted read-only, i.e. whose QE neither assigned
+ * an xid nor wrote WAL in this transaction, ahead of the prepare of the
+ * others.
+ *
+ * Nothing of theirs needs to be made durable or atomic with the rest, so a
+ * one-phase commit does, and they are dropped from the transaction: they
+ * won't get the prepare, nor the 'Commit Prepared' broadcast.
+ */
+static void
+doNotifyingReadOnlyCommit(List *readOnlySegments)
+{
+	char		gid[TMGIDSIZE];
+	bool		succeeded;
+	ListCell   *lc;
+	List	   *remaining = NIL;
+	MemoryContext oldcontext;
+
+	elog(DTM_DEBUG5, "doNotifyingReadOnlyCommit entering in state = %s", DtxStateToString(MyTmGxactLocal->state));
+
+	Assert(MyTmGxactLocal->state == DTX_STATE_ACTIVE_DISTRIBUTED);
+
+	dtxFormGid(gid, getDistributedTransactionId());
+	succeeded = doDispatchDtxProtocolCommand(DTX_PROTOCOL_COMMAND_COMMIT_ONEPHASE,
+											 gid, true, readOnlySegments, NULL, 0);
+	if (!succeeded)
+	{
+		ereport(ERROR,
+				(errmsg("one phase commit notification of the read-only segments failed"),
+				TM_ERRDETAIL));
+	}
+
+	oldcontext = MemoryContextSwitchTo(TopTransactionContext);
+	foreach(lc, MyTmGxactLocal->dtxSegments)
+	{
+		int			segindex = lfirst_int(lc);
+
+		if (list_member_int(readOnlySegments, segindex))
+			MyTmGxactLocal->dtxSegmentsMap =
+				bms_del_member(MyTmGxactLocal->dtxSegmentsMap, segindex);
+		else
+			remaining = lappend_int(remaining, segindex);
+	}
+	MemoryContextSwitchTo(oldcontext);
+
+	MyTmGxactLocal->dtxSegments = remaining;
+}
+
 static void
 doNotifyingCommitPrepared(void)
 {
@@ -853,6 +902,11 @@ prepareDtxTransaction(void)
 {
 	TransactionId xid = GetTopTransactionIdIfAny();
 	bool		markXidCommitted = TransactionIdIsValid(xid);
+	List	   *readOnlySegments = NIL;
+	int			numWriteSegments;
+
+	/* the QEs may still be running the last utility statement */
+	cdbdisp_finishDeferredDispatch();
 
 	if (DistributedTransactionContext != DTX_CONTEXT_QD_DISTRIBUTED_CAPABLE)
 	{
@@ -871,13 +925,35 @@ prepareDtxTransaction(void)
 	}
 
 	/*
-	 * If only one segment was involved in the transaction, and no local XID
-	 * has been assigned on the QD either, or there is no xlog writing related
-	 * to this transaction on all segments, we can perform one-phase commit.
-	 * Otherwise, broadcast PREPARE TRANSACTION to the segments.
+	 * With read-only votes, the segments whose QE has no xid and wrote no
+	 * xlog don't count: they are committed right away, whatever the others
+	 * do.  WAL alone is not enough to tell, writes to unlogged or temp tables
+	 * and writes of a released subtransaction leave none behind.
+	 */
+	numWriteSegments = list_length(MyTmGxactLocal->dtxSegments);
+	if (gp_enable_dtx_read_only_vote)
+	{
+		ListCell   *lc;
+
+		foreach(lc, MyTmGxactLocal->dtxSegments)
+		{
+			int			segindex = lfirst_int(lc);
+
+			if (!bms_is_member(segindex, MyTmGxactLocal->dtxWriteSegmentsMap))
+				readOnlySegments = lappend_int(readOnlySegments, segindex);
+		}
+		numWriteSegments -= list_length(readOnlySegments);
+	}
+
+	/*
+	 * If only one segment was involved in the transaction (or wrote), and no
+	 * local XID has been assigned on the QD either, or there is no xlog
+	 * writing related to this transaction on all segments, we can perform
+	 * one-phase commit. Otherwise, broadcast PREPARE TRANSACTION to the
+	 * segments.
 	 */
 	if (!TopXactExecutorDidWriteXLog() ||
-		(!markXidCommitted && list_length(MyTmGxactLocal->dtxSegments) < 2))
+		(!markXidCommitted && numWriteSegments < 2))
 	{
 		setCurrentDtxState(DTX_STATE_ONE_PHASE_COMMIT);
 		/*
@@ -894,6 +970,9 @@ prepareDtxTransaction(void)
 
 	Assert(MyTmGxactLocal->state == DTX_STATE_ACTIVE_DISTRIBUTED);
 
+	if (readOnlySegments != NIL && numWriteSegments > 0)
+		doNotifyingReadOnlyCommit(readOnlySegments);
+
 	doPrepareTransaction();
 }
 
@@ -1442,6 +1521,7 @@ resetTmGxact(void)
 	MyTmGxactLocal->writerGangLost = false;
 	MyTmGxactLocal->dtxSegmentsMap = NULL;
 	MyTmGxactLocal->dtxSegments = NIL;
+	MyTmGxactLocal->dtxWriteSegmentsMap = NULL;
 	MyTmGxactLocal->isOnePhaseCommit = false;
 	if (MyTmGxactLocal->waitGxids != NULL)
 	{
@@ -2418,6 +2498,25 @@ addToGxactDtxSegments(Gang *gang)
 	MemoryContextSwitchTo(oldContext);
 }
 
+/*
+ * Record that the writer QE of a segment wrote xlog or assigned an xid in
+ * the current transaction, so it can't vote read-only at prepare time.
+ */
+void
+markGxactSegmentWrote(int segindex)
+{
+	MemoryContext oldContext;
+
+	/* entry db is just a reader, it is not in the two phase commit either */
+	if (!isCurrentDtxActivated() || segindex < 0)
+		return;
+
+	oldContext = MemoryContextSwitchTo(TopTransactionContext);
+	MyTmGxactLocal->dtxWriteSegmentsMap =
+		bms_add_member(MyTmGxactLocal->dtxWriteSegmentsMap, segindex);
+	MemoryContextSwitchTo(oldContext);
+}
+
 bool
 CurrentDtxIsRollingback(void)
 {
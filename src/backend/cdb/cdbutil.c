@@ -57,6 +57,12 @@
 #include "catalog/namespace.h"
 #include "utils/gpexpand.h"
 #include "access/xact.h"
+#include "funcapi.h"
+#include "access/htup_details.h"
+#include "catalog/pg_type.h"
+#include "port/atomics.h"
+#include "storage/lwlock.h"
+#include "storage/shmem.h"
 
 #define MAX_CACHED_1_GANGS 1
 
@@ -77,6 +83,43 @@
 MemoryContext CdbComponentsContext = NULL;
 static CdbComponentDatabases *cdb_component_dbs = NULL;
 
+/*
+ * QE pool accounting
+ *
+ * Each session keeps its idle QEs in the freelists of cdb_component_dbs, but
+ * the sessions of the same database and role share one entry in shared
+ * memory.  It counts the idle QEs they cache right now, so that
+ * gp_qe_pool_size can bound them, and how well the freelists work.  The
+ * entry goes away when the last of those sessions exits, so the table only
+ * holds the databases and roles that have sessions right now.
+ */
+typedef struct QEPoolKey
+{
+	Oid			dbid;
+	Oid			roleid;
+} QEPoolKey;
+
+typedef struct QEPoolEntry
+{
+	QEPoolKey	key;
+	int			sessions;		/* sessions using the entry, under QEPoolLock */
+	pg_atomic_uint32 idleReaders;	/* idle reader QEs cached right now */
+	pg_atomic_uint32 idleWriters;	/* idle writer QEs cached right now */
+	pg_atomic_uint64 hits;		/* QEs taken from a freelist */
+	pg_atomic_uint64 misses;	/* QEs that needed a new connection */
+	pg_atomic_uint64 evictions; /* idle readers destroyed by gp_qe_pool_size */
+	pg_atomic_uint64 gangs;		/* gangs allocated */
+	pg_atomic_uint64 gangSetupTime; /* microseconds spent allocating them */
+} QEPoolEntry;
+
+static HTAB *QEPoolHash = NULL;
+
+/* the entry of this session, and what this session has added to it */
+static QEPoolEntry *myQEPoolEntry = NULL;
+static bool myQEPoolEntryLookedUp = false;
+static uint32 myIdleReaders = 0;
+static uint32 myIdleWriters = 0;
+
 /*
  * Helper Functions
  */
@@ -93,6 +136,11 @@ static HTAB *hostSegsHashTableInit(void);
 
 static int nextQEIdentifer(CdbComponentDatabases *cdbs);
 
+static QEPoolEntry *getQEPoolEntry(void);
+static void qePoolAddIdle(bool isWriter);
+static void qePoolRemoveIdle(bool isWriter);
+static void qePoolShmemExit(int code, Datum arg);
+
 static HTAB *segment_ip_cache_htab = NULL;
 
 int numsegmentsFromQD = -1;
@@ -587,6 +635,7 @@ cleanupComponentIdleQEs(CdbComponentDatabaseInfo *cdi, bool includeWriter)
 
 		cdi->freelist = list_delete_cell(cdi->freelist, curItem, prevItem); 
 		DECR_COUNT(cdi, numIdleQEs);
+		qePoolRemoveIdle(segdbDesc->isWriter);
 
 		cdbconn_termSegmentDescriptor(segdbDesc);
 
@@ -767,6 +816,7 @@ cdbcomponent_allocateIdleQE(int contentId, SegmentType segmentType)
 	ListCell					*prevItem = NULL;
 	MemoryContext 				oldContext;
 	bool						isWriter;
+	QEPoolEntry					*poolEntry;
 
 	cdbinfo = cdbcomponent_getComponentInfo(contentId);	
 
@@ -796,12 +846,20 @@ cdbcomponent_allocateIdleQE(int contentId, SegmentType segmentType)
 		cdbinfo->freelist = list_delete_cell(cdbinfo->freelist, curItem, prevItem); 
 		/* update numIdleQEs */
 		DECR_COUNT(cdbinfo, numIdleQEs);
+		qePoolRemoveIdle(tmp->isWriter);
 
 		segdbDesc = tmp;
 		break;
 	}
 
-	if (!segdbDesc)
+	poolEntry = getQEPoolEntry();
+
+	if (segdbDesc)
+	{
+		if (poolEntry)
+			pg_atomic_fetch_add_u64(&poolEntry->hits, 1);
+	}
+	else
 	{
 		/*
 		 * 1. for entrydb, it's never be writer.
@@ -809,6 +867,9 @@ cdbcomponent_allocateIdleQE(int contentId, SegmentType segmentType)
 		 */
 		isWriter = contentId == -1 ? false: (cdbinfo->numIdleQEs == 0 && cdbinfo->numActiveQEs == 0);
 		segdbDesc = cdbconn_createSegmentDescriptor(cdbinfo, nextQEIdentifer(cdbinfo->cdbs), isWriter);
+
+		if (poolEntry)
+			pg_atomic_fetch_add_u64(&poolEntry->misses, 1);
 	}
 
 	cdbconn_setQEIdentifier(segdbDesc, -1);
@@ -891,6 +952,26 @@ cdbcomponent_recycleIdleQE(SegmentDatabaseDescriptor *segdbDesc, bool forceDestr
 	if (!isWriter && list_length(cdbinfo->freelist) >= maxLen)
 		goto destroy_segdb;
 
+	/*
+	 * Readers are also bounded by the idle QEs that the other sessions of
+	 * this database and role cache.  The writer is kept anyway, it holds the
+	 * transaction and the temporary tables of the session.
+	 */
+	if (!isWriter && gp_qe_pool_size >= 0)
+	{
+		QEPoolEntry *poolEntry = getQEPoolEntry();
+
+		/* without an entry we can't tell, keep nothing */
+		if (poolEntry == NULL)
+			goto destroy_segdb;
+
+		if (pg_atomic_read_u32(&poolEntry->idleReaders) >= (uint32) gp_qe_pool_size)
+		{
+			pg_atomic_fetch_add_u64(&poolEntry->evictions, 1);
+			goto destroy_segdb;
+		}
+	}
+
 	/* Recycle the QE, put it to freelist */
 	if (isWriter)
 	{
@@ -922,6 +1003,7 @@ cdbcomponent_recycleIdleQE(SegmentDatabaseDescriptor *segdbDesc, bool forceDestr
 	}
 
 	INCR_COUNT(cdbinfo, numIdleQEs);
+	qePoolAddIdle(isWriter);
 
 	MemoryContextSwitchTo(oldContext);
 
@@ -952,6 +1034,278 @@ nextQEIdentifer(CdbComponentDatabases *cdbs)
 	return result;
 }
 
+/*
+ * Find or create the QE pool entry of this session, and count the session
+ * in it.
+ *
+ * Returns NULL if the hash table is full.  The QEs of the session are not
+ * accounted then, and gp_qe_pool_size keeps none of its idle readers.
+ */
+static QEPoolEntry *
+getQEPoolEntry(void)
+{
+	QEPoolKey	key;
+	QEPoolEntry *entry;
+	bool		found;
+
+	if (myQEPoolEntryLookedUp)
+		return myQEPoolEntry;
+
+	myQEPoolEntryLookedUp = true;
+
+	if (QEPoolHash == NULL || !OidIsValid(MyDatabaseId))
+		return NULL;
+
+	MemSet(&key, 0, sizeof(key));
+	key.dbid = MyDatabaseId;
+	key.roleid = GetAuthenticatedUserId();
+
+	LWLockAcquire(QEPoolLock, LW_EXCLUSIVE);
+
+	entry = (QEPoolEntry *) hash_search(QEPoolHash, &key, HASH_ENTER_NULL, &found);
+	if (entry && !found)
+	{
+		entry->sessions = 0;
+		pg_atomic_init_u32(&entry->idleReaders, 0);
+		pg_atomic_init_u32(&entry->idleWriters, 0);
+		pg_atomic_init_u64(&entry->hits, 0);
+		pg_atomic_init_u64(&entry->misses, 0);
+		pg_atomic_init_u64(&entry->evictions, 0);
+		pg_atomic_init_u64(&entry->gangs, 0);
+		pg_atomic_init_u64(&entry->gangSetupTime, 0);
+	}
+	if (entry)
+		entry->sessions++;
+
+	LWLockRelease(QEPoolLock);
+
+	if (entry)
+		before_shmem_exit(qePoolShmemExit, 0);
+	else
+		ereport(WARNING,
+				(errmsg("QE pool accounting is full, the QEs of this session are not accounted"),
+				 errdetail("gp_stat_qe_pool already has %d entries.", MaxBackends)));
+
+	myQEPoolEntry = entry;
+	return entry;
+}
+
+static void
+qePoolAddIdle(bool isWriter)
+{
+	QEPoolEntry *entry = getQEPoolEntry();
+
+	if (entry == NULL)
+		return;
+
+	if (isWriter)
+	{
+		pg_atomic_fetch_add_u32(&entry->idleWriters, 1);
+		myIdleWriters++;
+	}
+	else
+	{
+		pg_atomic_fetch_add_u32(&entry->idleReaders, 1);
+		myIdleReaders++;
+	}
+}
+
+static void
+qePoolRemoveIdle(bool isWriter)
+{
+	QEPoolEntry *entry = myQEPoolEntry;
+
+	if (entry == NULL)
+		return;
+
+	if (isWriter)
+	{
+		Assert(myIdleWriters > 0);
+		pg_atomic_fetch_sub_u32(&entry->idleWriters, 1);
+		myIdleWriters--;
+	}
+	else
+	{
+		Assert(myIdleReaders > 0);
+		pg_atomic_fetch_sub_u32(&entry->idleReaders, 1);
+		myIdleReaders--;
+	}
+}
+
+/*
+ * Give back the idle QEs of this session if it exits without destroying
+ * them first, and remove the entry if this was its last session.
+ */
+static void
+qePoolShmemExit(int code, Datum arg)
+{
+	if (myQEPoolEntry == NULL)
+		return;
+
+	if (myIdleReaders > 0)
+		pg_atomic_fetch_sub_u32(&myQEPoolEntry->idleReaders, myIdleReaders);
+	if (myIdleWriters > 0)
+		pg_atomic_fetch_sub_u32(&myQEPoolEntry->idleWriters, myIdleWriters);
+
+	LWLockAcquire(QEPoolLock, LW_EXCLUSIVE);
+	Assert(myQEPoolEntry->sessions > 0);
+	if (--myQEPoolEntry->sessions == 0)
+		hash_search(QEPoolHash, &myQEPoolEntry->key, HASH_REMOVE, NULL);
+	LWLockRelease(QEPoolLock);
+
+	myIdleReaders = 0;
+	myIdleWriters = 0;
+	myQEPoolEntry = NULL;
+}
+
+/*
+ * Account a gang allocated by AllocateGang(), and the time it took.
+ */
+void
+cdbcomponent_reportGangSetup(int64 elapsed_us)
+{
+	QEPoolEntry *entry = getQEPoolEntry();
+
+	if (entry == NULL)
+		return;
+
+	pg_atomic_fetch_add_u64(&entry->gangs, 1);
+	pg_atomic_fetch_add_u64(&entry->gangSetupTime, (uint64) Max(elapsed_us, 0));
+}
+
+/*
+ * Shared memory for the QE pool accounting, one entry per database and role
+ * with sessions on the coordinator.
+ */
+Size
+QEPoolShmemSize(void)
+{
+	return hash_estimate_size(MaxBackends, sizeof(QEPoolEntry));
+}
+
+void
+QEPoolShmemInit(void)
+{
+	HASHCTL		info;
+
+	MemSet(&info, 0, sizeof(info));
+	info.keysize = sizeof(QEPoolKey);
+	info.entrysize = sizeof(QEPoolEntry);
+
+	QEPoolHash = ShmemInitHash("QE Pool Hash",
+							   MaxBackends, MaxBackends,
+							   &info,
+							   HASH_ELEM | HASH_BLOBS);
+}
+
+/*
+ * gp_get_qe_pool_stats
+ * 		Return the QE pool accounting of this coordinator, one row per
+ * 		database and role.
+ */
+Datum
+gp_get_qe_pool_stats(PG_FUNCTION_ARGS)
+{
+#define GP_QE_POOL_STATS_NATTR 9
+	typedef struct QEPoolStats
+	{
+		QEPoolKey	key;
+		uint32		idleReaders;
+		uint32		idleWriters;
+		uint64		hits;
+		uint64		misses;
+		uint64		evictions;
+		uint64		gangs;
+		uint64		gangSetupTime;
+	} QEPoolStats;
+
+	FuncCallContext *funcctx;
+	QEPoolStats *stats;
+	Datum		values[GP_QE_POOL_STATS_NATTR];
+	bool		nulls[GP_QE_POOL_STATS_NATTR];
+	HeapTuple	tuple;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		MemoryContext oldcontext;
+		TupleDesc	tupdesc;
+		HASH_SEQ_STATUS status;
+		QEPoolEntry *entry;
+		int			n = 0;
+
+		funcctx = SRF_FIRSTCALL_INIT();
+		oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+		tupdesc = CreateTemplateTupleDesc(GP_QE_POOL_STATS_NATTR);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 1, "datid", OIDOID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 2, "usesysid", OIDOID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 3, "idle_readers", INT4OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 4, "idle_writers", INT4OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 5, "hits", INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 6, "misses", INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 7, "evictions", INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 8, "gangs", INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 9, "gang_setup_time", FLOAT8OID, -1, 0);
+		funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+
+		/* copy the counters, so that the lock is not held across calls */
+		stats = (QEPoolStats *) palloc0(MaxBackends * sizeof(QEPoolStats));
+
+		if (QEPoolHash != NULL)
+		{
+			LWLockAcquire(QEPoolLock, LW_SHARED);
+
+			hash_seq_init(&status, QEPoolHash);
+			while ((entry = (QEPoolEntry *) hash_seq_search(&status)) != NULL)
+			{
+				if (n >= MaxBackends)
+				{
+					hash_seq_term(&status);
+					break;
+				}
+				stats[n].key = entry->key;
+				stats[n].idleReaders = pg_atomic_read_u32(&entry->idleReaders);
+				stats[n].idleWriters = pg_atomic_read_u32(&entry->idleWriters);
+				stats[n].hits = pg_atomic_read_u64(&entry->hits);
+				stats[n].misses = pg_atomic_read_u64(&entry->misses);
+				stats[n].evictions = pg_atomic_read_u64(&entry->evictions);
+				stats[n].gangs = pg_atomic_read_u64(&entry->gangs);
+				stats[n].gangSetupTime = pg_atomic_read_u64(&entry->gangSetupTime);
+				n++;
+			}
+
+			LWLockRelease(QEPoolLock);
+		}
+
+		funcctx->user_fctx = stats;
+		funcctx->max_calls = n;
+
+		MemoryContextSwitchTo(oldcontext);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+
+	if (funcctx->call_cntr >= funcctx->max_calls)
+		SRF_RETURN_DONE(funcctx);
+
+	stats = &((QEPoolStats *) funcctx->user_fctx)[funcctx->call_cntr];
+	MemSet(nulls, 0, sizeof(nulls));
+
+	values[0] = ObjectIdGetDatum(stats->key.dbid);
+	values[1] = ObjectIdGetDatum(stats->key.roleid);
+	values[2] = Int32GetDatum((int32) stats->idleReaders);
+	values[3] = Int32GetDatum((int32) stats->idleWriters);
+	values[4] = Int64GetDatum((int64) stats->hits);
+	values[5] = Int64GetDatum((int64) stats->misses);
+	values[6] = Int64GetDatum((int64) stats->evictions);
+	values[7] = Int64GetDatum((int64) stats->gangs);
+	/* in milliseconds, like the other timings of the statistics views */
+	values[8] = Float8GetDatum(stats->gangSetupTime / 1000.0);
+
+	tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+	SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+}
+
 bool
 cdbcomponent_qesExist(void)
 {
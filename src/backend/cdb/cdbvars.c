@@ -80,6 +80,8 @@ int			gp_external_max_segs;	/* max segdbs per gpfdist/gpfdists URI */
 
 int			gp_safefswritesize; /* set for safe AO writes in non-mature fs */
 
+int			gp_qe_pool_size;	/* How many idle reader QEs the sessions of a
+								 * database and role may cache together */
 int			gp_cached_gang_threshold;	/* How many gangs to keep around from
 										 * stmt to stmt. */
 
@@ -207,6 +209,14 @@ bool		gp_interconnect_aggressive_retry = true;	/* fast-track app-level
 
 bool		gp_interconnect_full_crc = false;	/* sanity check UDP data. */
 
+bool		gp_interconnect_compression = false;	/* compress motion tuples */
+
+bool		gp_interconnect_tuple_batching = false;	/* batch narrow tuples */
+
+int			gp_interconnect_flush_deadline = 0;	/* ms, 0 to disable */
+
+bool		gp_interconnect_local_shm = false;	/* shm_mq for same-segment routes */
+
 bool		gp_interconnect_log_stats = false;	/* emit stats at log-level */
 
 bool		gp_interconnect_cache_future_packets = true;
@@ -219,6 +229,7 @@ bool		gp_interconnect_cache_future_packets = true;
  * - the address must be specified as IP;
  */
 char	   *gp_interconnect_proxy_addresses = NULL;
+int			gp_interconnect_proxy_workers = 1;
 
 int			Gp_udp_bufsize_k;	/* UPD recv buf size, in KB */
 
@@ -302,6 +313,18 @@ bool		gp_enable_fast_sri = true;
 /* Enable single-mirror pair dispatch. */
 bool		gp_enable_direct_dispatch = true;
 
+/* Send each gang only the plan of its own slice. */
+bool		gp_dispatch_slice_plans = true;
+
+/* Commit read-only segments of a distributed transaction in one phase. */
+bool		gp_enable_dtx_read_only_vote = false;
+
+/* Overlap the utility statements of a transaction block with the next one. */
+bool		gp_pipeline_utility_dispatch = false;
+
+/* Size in kB of the buffer for the results sent to the client. */
+int			gp_client_send_buffer_size = 64;
+
 /* Force core dump on memory context error */
 bool		coredump_on_memerror = false;
 
@@ -28,10 +28,14 @@
 #include "cdb/cdbgang.h"
 #include "cdb/cdbsreh.h"
 #include "cdb/cdbvars.h"
+#include "pgstat.h"
 #include "utils/resowner.h"
 
 static int numNonExtendedDispatcherState = 0;
 
+/* A utility dispatch whose results are collected later, if any */
+static CdbDispatcherState *deferredDispatcherState = NULL;
+
 dispatcher_handle_t *open_dispatcher_handles;
 static void cleanup_dispatcher_handle(dispatcher_handle_t *h);
 
@@ -281,6 +285,9 @@ cdbdisp_makeDispatcherState(bool isExtendedQuery)
 {
 	dispatcher_handle_t *handle;
 
+	/* The QEs of a deferred utility dispatch must be done before we reuse them */
+	cdbdisp_finishDeferredDispatch();
+
 	if (!isExtendedQuery)
 	{
 		if (numNonExtendedDispatcherState == 1)
@@ -305,6 +312,7 @@ cdbdisp_makeDispatcherState(bool isExtendedQuery)
 	handle->dispatcherState->allocatedGangs = NIL;
 	handle->dispatcherState->largestGangSize = 0;
 	handle->dispatcherState->destroyIdleReaderGang = false;
+	MemSet(&handle->dispatcherState->stats, 0, sizeof(CdbDispatchStats));
 
 	return handle->dispatcherState;
 }
@@ -328,6 +336,16 @@ cdbdisp_makeDispatchParams(CdbDispatcherState *ds,
 	MemoryContextSwitchTo(oldContext);
 }
 
+void
+cdbdisp_setDispatchQueryText(CdbDispatcherState *ds,
+							 char *queryText,
+							 int queryTextLen)
+{
+	Assert(ds->dispatchParams);
+
+	(pDispatchFuncs->setQueryText) (ds, queryText, queryTextLen);
+}
+
 /*
  * Free memory in CdbDispatcherState
  *
@@ -387,6 +405,10 @@ cdbdisp_destroyDispatcherState(CdbDispatcherState *ds)
 	if (ds->destroyIdleReaderGang)
 		cdbcomponent_cleanupIdleQEs(false);
 
+	/* Release anything the dispatch params hold outside of palloc'd memory. */
+	if (ds->dispatchParams != NULL && pDispatchFuncs->destroyDispatchParams != NULL)
+		(pDispatchFuncs->destroyDispatchParams) (ds->dispatchParams);
+
 	ds->allocatedGangs = NIL;
 	ds->dispatchParams = NULL;
 	ds->primaryResults = NULL;
@@ -402,6 +424,74 @@ cdbdisp_cancelDispatch(CdbDispatcherState *ds)
 	cdbdisp_checkDispatchResult(ds, DISPATCH_WAIT_CANCEL);
 }
 
+/*
+ * Leave a dispatched utility statement running, its results are collected
+ * by cdbdisp_finishDeferredDispatch() before the next dispatch.
+ *
+ * The dispatcher state outlives the statement, so it is handed over to the
+ * transaction's resource owner.
+ */
+void
+cdbdisp_deferDispatcherState(CdbDispatcherState *ds)
+{
+	dispatcher_handle_t *h = find_dispatcher_handle(ds);
+
+	Assert(deferredDispatcherState == NULL);
+	Assert(!ds->isExtendedQuery);
+
+	if (h != NULL)
+		h->owner = TopTransactionResourceOwner;
+	deferredDispatcherState = ds;
+}
+
+/*
+ * Wait for the deferred utility dispatch, if any, and raise the error of the
+ * QEs if one failed.
+ */
+void
+cdbdisp_finishDeferredDispatch(void)
+{
+	CdbDispatcherState *ds = deferredDispatcherState;
+	CdbDispatchResults *pr;
+	ErrorData  *qeError = NULL;
+
+	if (ds == NULL)
+		return;
+
+	cdbdisp_checkDispatchResult(ds, DISPATCH_WAIT_NONE);
+
+	pr = cdbdisp_getDispatchResults(ds, &qeError);
+
+	if (qeError)
+	{
+		/* the abort processing cleans up the dispatcher state */
+		FlushErrorState();
+		ReThrowError(qeError);
+	}
+
+	/* collect pgstat from QEs for current transaction level */
+	pgstat_combine_from_qe(pr, -1);
+
+	deferredDispatcherState = NULL;
+	cdbdisp_destroyDispatcherState(ds);
+}
+
+/*
+ * Cancel the deferred utility dispatch, if any, on abort.
+ */
+void
+cdbdisp_cancelDeferredDispatch(void)
+{
+	CdbDispatcherState *ds = deferredDispatcherState;
+
+	if (ds == NULL)
+		return;
+
+	deferredDispatcherState = NULL;
+	cdbdisp_cancelDispatch(ds);
+	cdbdisp_destroyDispatcherState(ds);
+}
+
 bool
 cdbdisp_checkForCancel(CdbDispatcherState *ds)
 {
@@ -519,6 +609,8 @@ AtAbort_DispatcherState(void)
 		CurrentGangCreating = NULL;
 	}
 
+	cdbdisp_cancelDeferredDispatch();
+
 	/*
 	 * Cleanup all outbound dispatcher states belong to
 	 * current resource owner and its children
@@ -547,6 +639,8 @@ AtSubAbort_DispatcherState(void)
 		CurrentGangCreating = NULL;
 	}
 
+	cdbdisp_cancelDeferredDispatch();
+
 	CdbResourceOwnerWalker(CurrentResourceOwner, cdbdisp_cleanupDispatcherHandle);
 }
 
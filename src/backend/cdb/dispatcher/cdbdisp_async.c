@@ -4,11 +4,6 @@
  *	  Functions for asynchronous implementation of dispatching
  *	  commands to QExecutors.
  *
- * GPDB_12_MERGE_FIXME: We should switch to using WaitEventSetWait() instead
- * of straight poll() in this file. WaitEventSetWait() would report the status
- * using the new wait event infrastructure, so that it would show up as a
- * separate state in pg_stat_activity. It's also potentially more efficient.
- *
  *
  * Portions Copyright (c) 2005-2008, Greenplum inc
  * Portions Copyright (c) 2012-Present VMware, Inc. or its affiliates.
@@ -29,7 +24,9 @@
 #include <sys/poll.h>
 #endif
 
+#include "pgstat.h"
 #include "storage/ipc.h"		/* For proc_exit_inprogress  */
+#include "storage/latch.h"
 #include "tcop/tcopprot.h"
 #include "cdb/cdbdisp.h"
 #include "cdb/cdbdisp_async.h"
@@ -40,9 +37,11 @@
 #include "cdb/cdbgang.h"
 #include "cdb/cdbvars.h"
 #include "cdb/cdbpq.h"
+#include "cdb/cdbtm.h"
 #include "miscadmin.h"
 #include "commands/sequence.h"
 #include "access/xact.h"
+#include "utils/memutils.h"
 #include "utils/timestamp.h"
 #define DISPATCH_WAIT_TIMEOUT_MSEC 2000
 
@@ -84,6 +83,16 @@ typedef struct CdbDispatchCmdAsync
 	char	   *query_text;
 	int			query_text_len;
 
+	/*
+	 * Wait event set over the sockets of the QEs that were still running
+	 * when it was built, plus the process latch.  It's kept across calls to
+	 * checkDispatchResult() and rebuilt when new QEs are dispatched or a
+	 * finished QE's socket reports an event.  waitSetCount is the
+	 * dispatchCount it was built for.
+	 */
+	WaitEventSet *waitSet;
+	int			waitSetCount;
+
 } CdbDispatchCmdAsync;
 
 static void *cdbdisp_makeDispatchParams_async(int maxSlices, int largestGangSize, char *queryText, int len);
@@ -98,6 +107,9 @@ static void	cdbdisp_waitDispatchFinish_async(struct CdbDispatcherState *ds);
 
 static bool	cdbdisp_checkForCancel_async(struct CdbDispatcherState *ds);
 static int cdbdisp_getWaitSocketFd_async(struct CdbDispatcherState *ds);
+static void cdbdisp_destroyDispatchParams_async(void *dispatchParams);
+static void cdbdisp_setQueryText_async(struct CdbDispatcherState *ds,
+									   char *queryText, int len);
 
 DispatcherInternalFuncs DispatcherAsyncFuncs =
 {
@@ -106,7 +118,9 @@ DispatcherInternalFuncs DispatcherAsyncFuncs =
 	cdbdisp_makeDispatchParams_async,
 	cdbdisp_checkDispatchResult_async,
 	cdbdisp_dispatchToGang_async,
-	cdbdisp_waitDispatchFinish_async
+	cdbdisp_waitDispatchFinish_async,
+	cdbdisp_destroyDispatchParams_async,
+	cdbdisp_setQueryText_async
 };
 
 
@@ -126,10 +140,14 @@ static void
 			checkSegmentAlive(CdbDispatchCmdAsync *pParms);
 
 static void
-			handlePollError(CdbDispatchCmdAsync *pParms);
+			buildWaitSet(CdbDispatchCmdAsync *pParms);
 
 static void
-			handlePollSuccess(CdbDispatchCmdAsync *pParms, struct pollfd *fds);
+			freeWaitSet(CdbDispatchCmdAsync *pParms);
+
+static void
+			handlePollSuccess(CdbDispatchCmdAsync *pParms, WaitEvent *events,
+							  int nevents);
 
 /*
  * Check dispatch result.
@@ -367,10 +385,79 @@ cdbdisp_makeDispatchParams_async(int maxSlices, int largestGangSize, char *query
 	pParms->waitMode = DISPATCH_WAIT_NONE;
 	pParms->query_text = queryText;
 	pParms->query_text_len = len;
+	pParms->waitSet = NULL;
+	pParms->waitSetCount = 0;
 
 	return (void *) pParms;
 }
 
+/*
+ * Send a different text to the gangs dispatched from now on.
+ *
+ * The QEs already dispatched to may still be sending the old text from their
+ * libpq output buffers, which only point to it, so it is not freed here; it
+ * lives in the DispatcherContext like the new one.
+ */
+static void
+cdbdisp_setQueryText_async(struct CdbDispatcherState *ds, char *queryText, int len)
+{
+	CdbDispatchCmdAsync *pParms = (CdbDispatchCmdAsync *) ds->dispatchParams;
+
+	pParms->query_text = queryText;
+	pParms->query_text_len = len;
+}
+
+/*
+ * Release the resources of a CdbDispatchCmdAsync that don't go away with
+ * its memory context.
+ */
+static void
+cdbdisp_destroyDispatchParams_async(void *dispatchParams)
+{
+	freeWaitSet((CdbDispatchCmdAsync *) dispatchParams);
+}
+
+/*
+ * Build the wait event set checkDispatchResult() waits on, covering every QE
+ * that is still running.
+ */
+static void
+buildWaitSet(CdbDispatchCmdAsync *pParms)
+{
+	int			i;
+
+	freeWaitSet(pParms);
+
+	pParms->waitSet = CreateWaitEventSet(GetMemoryChunkContext(pParms),
+										 pParms->dispatchCount + 1);
+	pParms->waitSetCount = pParms->dispatchCount;
+
+	AddWaitEventToSet(pParms->waitSet, WL_LATCH_SET, PGINVALID_SOCKET,
+					  MyLatch, NULL);
+
+	for (i = 0; i < pParms->dispatchCount; i++)
+	{
+		CdbDispatchResult *dispatchResult = pParms->dispatchResultPtrArray[i];
+
+		if (!dispatchResult->stillRunning)
+			continue;
+
+		AddWaitEventToSet(pParms->waitSet, WL_SOCKET_READABLE,
+						  PQsocket(dispatchResult->segdbDesc->conn),
+						  NULL, dispatchResult);
+	}
+}
+
+static void
+freeWaitSet(CdbDispatchCmdAsync *pParms)
+{
+	if (pParms->waitSet != NULL)
+	{
+		FreeWaitEventSet(pParms->waitSet);
+		pParms->waitSet = NULL;
+	}
+}
+
 /*
  * Receive and process results from all running QEs.
  *
@@ -392,11 +479,11 @@ checkDispatchResult(CdbDispatcherState *ds,
 	int			db_count = 0;
 	int			timeout = 0;
 	bool		sentSignal = false;
-	struct pollfd *fds;
+	WaitEvent  *events;
 	uint8 ftsVersion = 0;
 
 	db_count = pParms->dispatchCount;
-	fds = (struct pollfd *) palloc(db_count * sizeof(struct pollfd));
+	events = (WaitEvent *) palloc((db_count + 1) * sizeof(WaitEvent));
 
 	/*
 	 * OK, we are finished submitting the command to the segdbs. Now, we have
@@ -404,7 +491,6 @@ checkDispatchResult(CdbDispatcherState *ds,
 	 */
 	for (;;)
 	{
-		int			sock;
 		int			n;
 		int			nfds = 0;
 		PGconn		*conn;
@@ -457,13 +543,6 @@ checkDispatchResult(CdbDispatcherState *ds,
 						 segdbDesc->whoami, PQerrorMessage(conn));
 			}
 
-			/*
-			 * Add socket to fd_set if still connected.
-			 */
-			sock = PQsocket(conn);
-			Assert(sock >= 0);
-			fds[nfds].fd = sock;
-			fds[nfds].events = POLLIN;
 			nfds++;
 		}
 
@@ -471,7 +550,10 @@ checkDispatchResult(CdbDispatcherState *ds,
 		 * Break out when no QEs still running.
 		 */
 		if (nfds <= 0)
+		{
+			freeWaitSet(pParms);
 			break;
+		}
 
 		/*
 		 * Wait for results from QEs
@@ -488,42 +570,14 @@ checkDispatchResult(CdbDispatcherState *ds,
 		else
 			timeout = DISPATCH_WAIT_CANCEL_TIMEOUT_MSEC;
 
-		n = poll(fds, nfds, timeout);
-
-		/*
-		 * poll returns with an error, including one due to an interrupted
-		 * call
-		 */
-		if (n < 0)
-		{
-			int			sock_errno = SOCK_ERRNO;
-
-			if (sock_errno == EINTR)
-				continue;
-
-			elog(LOG, "handlePollError poll() failed; errno=%d", sock_errno);
-
-			handlePollError(pParms);
+		if (pParms->waitSet == NULL || pParms->waitSetCount != db_count)
+			buildWaitSet(pParms);
 
-			/*
-			 * Since an error was detected for the segment, request
-			 * FTS to perform a probe before checking the segment
-			 * state.
-			 */
-			FtsNotifyProber();
-			checkSegmentAlive(pParms);
+		n = WaitEventSetWait(pParms->waitSet, timeout, events, db_count + 1,
+							 WAIT_EVENT_DISPATCH);
 
-			if (pParms->waitMode != DISPATCH_WAIT_NONE)
-			{
-				signalQEs(pParms);
-				sentSignal = true;
-			}
-
-			if (!wait)
-				break;
-		}
-		/* If the time limit expires, poll() returns 0 */
-		else if (n == 0)
+		/* If the time limit expires, WaitEventSetWait() returns 0 */
+		if (n == 0)
 		{
 			if (pParms->waitMode != DISPATCH_WAIT_NONE)
 			{
@@ -542,6 +596,9 @@ checkDispatchResult(CdbDispatcherState *ds,
 			{
 				ftsVersion = getFtsVersion();
 				checkSegmentAlive(pParms);
+
+				/* Connections to dead segments may have been closed. */
+				freeWaitSet(pParms);
 			}
 
 			if (!wait)
@@ -549,10 +606,10 @@ checkDispatchResult(CdbDispatcherState *ds,
 		}
 		/* We have data waiting on one or more of the connections. */
 		else
-			handlePollSuccess(pParms, fds);
+			handlePollSuccess(pParms, events, n);
 	}
 
-	pfree(fds);
+	pfree(events);
 }
 
 /*
@@ -605,93 +662,49 @@ dispatchCommand(CdbDispatchResult *dispatchResult,
 	ELOG_DISPATCHER_DEBUG("Command dispatched to QE (%s)", dispatchResult->segdbDesc->whoami);
 }
 
-/*
- * Helper function to checkDispatchResult that handles errors that occur
- * during the poll() call.
- *
- * NOTE: The cleanup of the connections will be performed by handlePollTimeout().
- */
-static void
-handlePollError(CdbDispatchCmdAsync *pParms)
-{
-	int			i;
-
-	for (i = 0; i < pParms->dispatchCount; i++)
-	{
-		CdbDispatchResult *dispatchResult = pParms->dispatchResultPtrArray[i];
-		SegmentDatabaseDescriptor *segdbDesc = dispatchResult->segdbDesc;
-
-		/* Skip if already finished or didn't dispatch. */
-		if (!dispatchResult->stillRunning)
-			continue;
-
-		/* We're done with this QE, sadly. */
-		if (PQstatus(segdbDesc->conn) == CONNECTION_BAD)
-		{
-			char	   *msg = PQerrorMessage(segdbDesc->conn);
-
-			if (msg)
-				elog(LOG, "Dispatcher encountered connection error on %s: %s", segdbDesc->whoami, msg);
-
-			elog(LOG, "Dispatcher noticed bad connection in handlePollError()");
-
-			/* Save error info for later. */
-			cdbdisp_appendMessageNonThread(dispatchResult, LOG,
-										   "Error after dispatch from %s: %s",
-										   segdbDesc->whoami,
-										   msg ? msg : "unknown error");
-
-			PQfinish(segdbDesc->conn);
-			segdbDesc->conn = NULL;
-			dispatchResult->stillRunning = false;
-		}
-	}
-	forwardQENotices();
-
-	return;
-}
-
 /*
  * Receive and process results from QEs.
  */
 static void
 handlePollSuccess(CdbDispatchCmdAsync *pParms,
-				  struct pollfd *fds)
+				  WaitEvent *events, int nevents)
 {
-	int			currentFdNumber = 0;
 	int			i = 0;
 
 	/*
 	 * We have data waiting on one or more of the connections.
 	 */
-	for (i = 0; i < pParms->dispatchCount; i++)
+	for (i = 0; i < nevents; i++)
 	{
 		bool		finished;
-		int			sock;
-		CdbDispatchResult *dispatchResult = pParms->dispatchResultPtrArray[i];
-		SegmentDatabaseDescriptor *segdbDesc = dispatchResult->segdbDesc;
+		CdbDispatchResult *dispatchResult;
+		SegmentDatabaseDescriptor *segdbDesc;
 
-		/*
-		 * Skip if already finished or didn't dispatch.
-		 */
-		if (!dispatchResult->stillRunning)
+		if (events[i].events & WL_LATCH_SET)
+		{
+			/* We were signalled; the caller rechecks InterruptPending. */
+			ResetLatch(MyLatch);
 			continue;
+		}
 
-		ELOG_DISPATCHER_DEBUG("looking for results from %d of %d (%s)",
-							  i + 1, pParms->dispatchCount, segdbDesc->whoami);
-
-		sock = PQsocket(segdbDesc->conn);
-		Assert(sock >= 0);
-		Assert(sock == fds[currentFdNumber].fd);
+		dispatchResult = (CdbDispatchResult *) events[i].user_data;
+		segdbDesc = dispatchResult->segdbDesc;
 
 		/*
-		 * Skip this connection if it has no input available.
+		 * This QE finished after the wait set was built, yet its socket
+		 * became readable.  Events can't be removed from a WaitEventSet, so
+		 * have the caller rebuild it rather than spin on this one.
 		 */
-		if (!(fds[currentFdNumber++].revents & POLLIN))
+		if (!dispatchResult->stillRunning)
+		{
+			freeWaitSet(pParms);
 			continue;
+		}
 
-		ELOG_DISPATCHER_DEBUG("PQsocket says there are results from %d of %d (%s)",
-							  i + 1, pParms->dispatchCount, segdbDesc->whoami);
+		Assert(PQsocket(segdbDesc->conn) == events[i].fd);
+
+		ELOG_DISPATCHER_DEBUG("PQsocket says there are results from %s",
+							  segdbDesc->whoami);
 
 		/*
 		 * Receive and process results from this QE.
@@ -705,8 +718,8 @@ handlePollSuccess(CdbDispatchCmdAsync *pParms,
 		{
 			dispatchResult->stillRunning = false;
 
-			ELOG_DISPATCHER_DEBUG("processResults says we are finished with %d of %d (%s)",
-								  i + 1, pParms->dispatchCount, segdbDesc->whoami);
+			ELOG_DISPATCHER_DEBUG("processResults says we are finished with %s",
+								  segdbDesc->whoami);
 
 			if (DEBUG1 >= log_min_messages)
 			{
@@ -716,8 +729,8 @@ handlePollSuccess(CdbDispatchCmdAsync *pParms,
 				{
 					case 1:
 					case 2:
-						elog(LOG, "duration to dispatch result received from %d (seg %d): %s ms",
-							 i + 1, dispatchResult->segdbDesc->segindex, msec_str);
+						elog(LOG, "duration to dispatch result received from seg %d: %s ms",
+							 dispatchResult->segdbDesc->segindex, msec_str);
 						break;
 				}
 			}
@@ -726,8 +739,8 @@ handlePollSuccess(CdbDispatchCmdAsync *pParms,
 				elog(LOG, "We thought we were done, because finished==true, but libpq says we are still busy");
 		}
 		else
-			ELOG_DISPATCHER_DEBUG("processResults says we have more to do with %d of %d (%s)",
-								  i + 1, pParms->dispatchCount, segdbDesc->whoami);
+			ELOG_DISPATCHER_DEBUG("processResults says we have more to do with %s",
+								  segdbDesc->whoami);
 	}
 }
 
@@ -914,6 +927,17 @@ processResults(CdbDispatchResult *dispatchResult)
 			return true;
 		}
 
+		/*
+		 * A QE that has an xid may have changed something even without
+		 * writing xlog (unlogged or temp tables, subtransactions), its
+		 * segment can't vote read-only.
+		 */
+		if (segdbDesc->conn->wrote_xlog || segdbDesc->conn->assigned_xid)
+		{
+			markGxactSegmentWrote(segdbDesc->segindex);
+			segdbDesc->conn->assigned_xid = false;
+		}
+
 		if (segdbDesc->conn->wrote_xlog)
 		{
 			MarkTopTransactionWriteXLogOnExecutor();
@@ -59,6 +59,19 @@ typedef struct ParamWalkerContext
 	List	   *params;
 } ParamWalkerContext;
 
+/*
+ * Motions cut off while serializing the plan of one slice, see
+ * serializePlanForDispatch().
+ */
+typedef struct SlicePlanPruneContext
+{
+	plan_tree_base_prefix base; /* Required prefix for
+								 * plan_tree_walker/mutator */
+	Bitmapset  *keepSlices;		/* the slice and its ancestors */
+	List	   *motions;		/* motions whose subtree was cut off */
+	List	   *subtrees;		/* their original lefttrees */
+} SlicePlanPruneContext;
+
 /*
  * We need an array describing the relationship between a slice and
  * the number of "child" slices which depend on it.
@@ -106,7 +119,8 @@ static int fillSliceVector(SliceTable *sliceTable,
 static char *buildGpQueryString(DispatchCommandQueryParms *pQueryParms,
 				   int *finalLen);
 
-static DispatchCommandQueryParms *cdbdisp_buildPlanQueryParms(struct QueryDesc *queryDesc, bool planRequiresTxn);
+static char *serializePlanForDispatch(struct QueryDesc *queryDesc, int sliceIndex, int *len);
+static DispatchCommandQueryParms *cdbdisp_buildPlanQueryParms(struct QueryDesc *queryDesc, bool planRequiresTxn, bool withPlan);
 static DispatchCommandQueryParms *cdbdisp_buildUtilityQueryParms(struct Node *stmt, int flags, List *oid_assignments);
 static DispatchCommandQueryParms *cdbdisp_buildCommandQueryParms(const char *strCommand, int flags);
 
@@ -459,6 +473,18 @@ cdbdisp_dispatchCommandInternal(DispatchCommandQueryParms *pQueryParms,
 	ErrorData *qeError = NULL;
 	char *queryText;
 	int queryTextLength;
+	bool deferResults;
+
+	/*
+	 * In a transaction block, nobody needs the results of a two-phase
+	 * utility statement right away if the caller doesn't ask for them: an
+	 * error of the QEs aborts the transaction all the same when it is
+	 * collected before the next dispatch or the commit.
+	 */
+	deferResults = gp_pipeline_utility_dispatch &&
+		cdb_pgresults == NULL &&
+		(flags & DF_NEED_TWO_PHASE) != 0 &&
+		IsTransactionBlock();
 
 	/*
 	 * Dispatch the command.
@@ -500,6 +526,12 @@ cdbdisp_dispatchCommandInternal(DispatchCommandQueryParms *pQueryParms,
 
 	cdbdisp_waitDispatchFinish(ds);
 
+	if (deferResults)
+	{
+		cdbdisp_deferDispatcherState(ds);
+		return;
+	}
+
 	cdbdisp_checkDispatchResult(ds, DISPATCH_WAIT_NONE);
 
 	pr = cdbdisp_getDispatchResults(ds, &qeError);
@@ -613,33 +645,106 @@ cdbdisp_buildUtilityQueryParms(struct Node *stmt,
 	return pQueryParms;
 }
 
-static DispatchCommandQueryParms *
-cdbdisp_buildPlanQueryParms(struct QueryDesc *queryDesc,
-							bool planRequiresTxn)
+static bool
+slicePlanPruneWalker(Node *node, void *context)
 {
-	char	   *splan,
-			   *sddesc;
+	SlicePlanPruneContext *ctx = (SlicePlanPruneContext *) context;
 
-	int			splan_len,
-				splan_len_uncompressed,
-				sddesc_len,
-				rootIdx;
+	if (node == NULL)
+		return false;
 
-	rootIdx = RootSliceIndex(queryDesc->estate);
+	if (IsA(node, Motion))
+	{
+		Motion	   *motion = (Motion *) node;
 
-	DispatchCommandQueryParms *pQueryParms = (DispatchCommandQueryParms *) palloc0(sizeof(*pQueryParms));
+		if (!bms_is_member(motion->motionID, ctx->keepSlices))
+		{
+			ctx->motions = lappend(ctx->motions, motion);
+			ctx->subtrees = lappend(ctx->subtrees, motion->plan.lefttree);
+			motion->plan.lefttree = NULL;
+			return false;
+		}
+	}
 
-	/*
-	 * serialized plan tree. Note that we're called for a single slice tree
-	 * (corresponding to an initPlan or the main plan), so the parameters are
-	 * fixed and we can include them in the prefix.
-	 */
-	splan = serializeNode((Node *) queryDesc->plannedstmt, &splan_len, &splan_len_uncompressed);
+	return plan_tree_walker(node, slicePlanPruneWalker, ctx, false);
+}
+
+static void
+restorePrunedMotions(SlicePlanPruneContext *ctx)
+{
+	ListCell   *lcm,
+			   *lcs;
+
+	forboth(lcm, ctx->motions, lcs, ctx->subtrees)
+		((Motion *) lfirst(lcm))->plan.lefttree = (Plan *) lfirst(lcs);
+}
+
+/*
+ * Serialize the plan to dispatch, and check it against gp_max_plan_size.
+ *
+ * If sliceIndex is -1, that's the whole plan.  Otherwise it's the plan that
+ * the QEs of that slice execute: with execute_pruned_plan, a QE initializes
+ * only the nodes of its own slice, starting at the Motion that sends it, and
+ * doesn't look below the Motions it receives from.  So all but the path from
+ * the top of the plan down to the slice can be left out, by cutting off the
+ * subtrees of the Motions of the other slices while we serialize.
+ */
+static char *
+serializePlanForDispatch(struct QueryDesc *queryDesc, int sliceIndex, int *len)
+{
+	PlannedStmt *stmt = queryDesc->plannedstmt;
+	SlicePlanPruneContext ctx;
+	char	   *splan;
+	int			splan_len_uncompressed;
+
+	ctx.base.node = (Node *) stmt;
+	ctx.keepSlices = NULL;
+	ctx.motions = NIL;
+	ctx.subtrees = NIL;
+
+	if (sliceIndex >= 0)
+	{
+		SliceTable *sliceTable = queryDesc->estate->es_sliceTable;
+		int			si;
+
+		for (si = sliceIndex; si >= 0; si = sliceTable->slices[si].parentIndex)
+			ctx.keepSlices = bms_add_member(ctx.keepSlices, si);
+	}
+
+	PG_TRY();
+	{
+		if (sliceIndex >= 0)
+		{
+			ListCell   *lc;
+
+			(void) slicePlanPruneWalker((Node *) stmt->planTree, &ctx);
+			foreach(lc, stmt->subplans)
+				(void) slicePlanPruneWalker((Node *) lfirst(lc), &ctx);
+		}
+
+		splan = serializeNode((Node *) stmt, len, &splan_len_uncompressed);
+	}
+	PG_CATCH();
+	{
+		restorePrunedMotions(&ctx);
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+
+	restorePrunedMotions(&ctx);
+	list_free(ctx.motions);
+	list_free(ctx.subtrees);
+	bms_free(ctx.keepSlices);
 
 	uint64		plan_size_in_kb = ((uint64) splan_len_uncompressed) / (uint64) 1024;
 
-	elog(((gp_log_gang >= GPVARS_VERBOSITY_TERSE) ? LOG : DEBUG1),
-		 "Query plan size to dispatch: " UINT64_FORMAT "KB", plan_size_in_kb);
+	if (sliceIndex >= 0)
+		elog(((gp_log_gang >= GPVARS_VERBOSITY_TERSE) ? LOG : DEBUG1),
+			 "Query plan size to dispatch (slice %d): " UINT64_FORMAT "KB",
+			 sliceIndex, plan_size_in_kb);
+	else
+		elog(((gp_log_gang >= GPVARS_VERBOSITY_TERSE) ? LOG : DEBUG1),
+			 "Query plan size to dispatch: " UINT64_FORMAT "KB", plan_size_in_kb);
 
 	if (0 < gp_max_plan_size && plan_size_in_kb > gp_max_plan_size)
 	{
@@ -651,7 +756,35 @@ cdbdisp_buildPlanQueryParms(struct QueryDesc *queryDesc,
 				  errhint("Size controlled by gp_max_plan_size"))));
 	}
 
-	Assert(splan != NULL && splan_len > 0 && splan_len_uncompressed > 0);
+	Assert(splan != NULL && *len > 0 && splan_len_uncompressed > 0);
+
+	return splan;
+}
+
+/*
+ * Build the parameters of a plan dispatch.  If withPlan is false, the caller
+ * fills in the plan of each slice with serializePlanForDispatch().
+ */
+static DispatchCommandQueryParms *
+cdbdisp_buildPlanQueryParms(struct QueryDesc *queryDesc,
+							bool planRequiresTxn,
+							bool withPlan)
+{
+	char	   *splan = NULL,
+			   *sddesc;
+
+	int			splan_len = 0,
+				sddesc_len;
+
+	DispatchCommandQueryParms *pQueryParms = (DispatchCommandQueryParms *) palloc0(sizeof(*pQueryParms));
+
+	/*
+	 * serialized plan tree. Note that we're called for a single slice tree
+	 * (corresponding to an initPlan or the main plan), so the parameters are
+	 * fixed and we can include them in the prefix.
+	 */
+	if (withPlan)
+		splan = serializePlanForDispatch(queryDesc, -1, &splan_len);
 
 	sddesc = serializeNode((Node *) queryDesc->ddesc, &sddesc_len, NULL /* uncompressed_size */ );
 
@@ -1040,8 +1173,12 @@ cdbdisp_dispatchX(QueryDesc* queryDesc,
 
 	int			iSlice;
 	int			rootIdx;
+	int			nDispatchSlices = 0;
 	char	   *queryText = NULL;
 	int			queryTextLength = 0;
+	char	  **sliceQueryText = NULL;
+	int		   *sliceQueryTextLength = NULL;
+	instr_time	starttime;
 	struct SliceTable *sliceTbl;
 	struct EState *estate;
 	CdbDispatcherState *ds;
@@ -1068,7 +1205,10 @@ cdbdisp_dispatchX(QueryDesc* queryDesc,
 	 * 
 	 * Notice: This must be done before cdbdisp_buildPlanQueryParms
 	 */
+	INSTR_TIME_SET_CURRENT(starttime);
 	AssignGangs(ds, queryDesc);
+	INSTR_TIME_SET_CURRENT(ds->stats.gangTime);
+	INSTR_TIME_SUBTRACT(ds->stats.gangTime, starttime);
 
 	/*
 	 * Traverse the slice tree in sliceTbl rooted at rootIdx and build a
@@ -1080,8 +1220,56 @@ cdbdisp_dispatchX(QueryDesc* queryDesc,
 	/* Each slice table has a unique-id. */
 	sliceTbl->ic_instance_id = ++gp_interconnect_id;
 
-	pQueryParms = cdbdisp_buildPlanQueryParms(queryDesc, planRequiresTxn);
-	queryText = buildGpQueryString(pQueryParms, &queryTextLength);
+	for (iSlice = 0; iSlice < nSlices; iSlice++)
+	{
+		if (sliceVector[iSlice].slice->gangType != GANGTYPE_UNALLOCATED)
+			nDispatchSlices++;
+	}
+
+	/*
+	 * If the QEs prune the plan down to their own slice anyway, send each
+	 * gang only the part of the plan it executes.  Each slice's message is
+	 * built once and shared by all the QEs of its gang.
+	 */
+	INSTR_TIME_SET_CURRENT(starttime);
+	if (gp_dispatch_slice_plans && execute_pruned_plan &&
+		sliceTbl->hasMotions && nDispatchSlices > 1)
+	{
+		pQueryParms = cdbdisp_buildPlanQueryParms(queryDesc, planRequiresTxn, false);
+
+		sliceQueryText = palloc0(nTotalSlices * sizeof(char *));
+		sliceQueryTextLength = palloc0(nTotalSlices * sizeof(int));
+		for (iSlice = 0; iSlice < nSlices; iSlice++)
+		{
+			ExecSlice  *slice = sliceVector[iSlice].slice;
+			int			si = slice->sliceIndex;
+
+			if (slice->gangType == GANGTYPE_UNALLOCATED)
+				continue;
+
+			pQueryParms->serializedPlantree =
+				serializePlanForDispatch(queryDesc, si,
+										 &pQueryParms->serializedPlantreelen);
+			sliceQueryText[si] = buildGpQueryString(pQueryParms,
+													&sliceQueryTextLength[si]);
+
+			ds->stats.numPlans++;
+			ds->stats.planBytes += pQueryParms->serializedPlantreelen;
+			pfree(pQueryParms->serializedPlantree);
+		}
+		pQueryParms->serializedPlantree = NULL;
+		pQueryParms->serializedPlantreelen = 0;
+	}
+	else
+	{
+		pQueryParms = cdbdisp_buildPlanQueryParms(queryDesc, planRequiresTxn, true);
+		queryText = buildGpQueryString(pQueryParms, &queryTextLength);
+
+		ds->stats.numPlans = 1;
+		ds->stats.planBytes = pQueryParms->serializedPlantreelen;
+	}
+	INSTR_TIME_SET_CURRENT(ds->stats.buildTime);
+	INSTR_TIME_SUBTRACT(ds->stats.buildTime, starttime);
 
 	/*
 	 * Allocate result array with enough slots for QEs of primary gangs.
@@ -1109,6 +1297,7 @@ cdbdisp_dispatchX(QueryDesc* queryDesc,
 		}
 	}
 
+	INSTR_TIME_SET_CURRENT(starttime);
 	for (iSlice = 0; iSlice < nSlices; iSlice++)
 	{
 		Gang	   *primaryGang = NULL;
@@ -1157,16 +1346,29 @@ cdbdisp_dispatchX(QueryDesc* queryDesc,
 		}
 		SIMPLE_FAULT_INJECTOR("before_one_slice_dispatched");
 
+		if (sliceQueryText)
+		{
+			queryText = sliceQueryText[si];
+			queryTextLength = sliceQueryTextLength[si];
+			cdbdisp_setDispatchQueryText(ds, queryText, queryTextLength);
+		}
+
 		cdbdisp_dispatchToGang(ds, primaryGang, si);
 		if (planRequiresTxn || isDtxExplicitBegin())
 			addToGxactDtxSegments(primaryGang);
 
+		ds->stats.numGangs++;
+		ds->stats.numQEs += primaryGang->size;
+		ds->stats.bytesSent += (int64) queryTextLength * primaryGang->size;
+
 		SIMPLE_FAULT_INJECTOR("after_one_slice_dispatched");
 	}
 
 	pfree(sliceVector);
 
 	cdbdisp_waitDispatchFinish(ds);
+	INSTR_TIME_SET_CURRENT(ds->stats.sendTime);
+	INSTR_TIME_SUBTRACT(ds->stats.sendTime, starttime);
 
 	/*
 	 * If bailed before completely dispatched, stop QEs and throw error.
@@ -23,6 +23,7 @@
 #include "commands/variable.h"
 #include "common/ip.h"
 #include "nodes/execnodes.h"	/* CdbProcess, Slice, SliceTable */
+#include "portability/instr_time.h"
 #include "postmaster/postmaster.h"
 #include "tcop/tcopprot.h"
 #include "utils/int8.h"
@@ -103,6 +104,8 @@ AllocateGang(CdbDispatcherState *ds, GangType type, List *segments)
 	SegmentType 	segmentType;
 	Gang			*newGang = NULL;
 	int				i;
+	instr_time		starttime;
+	instr_time		elapsed;
 
 	ELOG_DISPATCHER_DEBUG("AllocateGang begin.");
 
@@ -125,8 +128,14 @@ AllocateGang(CdbDispatcherState *ds, GangType type, List *segments)
 	else
 		segmentType = SEGMENTTYPE_ANY;
 
+	INSTR_TIME_SET_CURRENT(starttime);
+
 	newGang = cdbgang_createGang(segments, segmentType);
 	newGang->allocated = true;
+
+	INSTR_TIME_SET_CURRENT(elapsed);
+	INSTR_TIME_SUBTRACT(elapsed, starttime);
+	cdbcomponent_reportGangSetup(INSTR_TIME_GET_MICROSEC(elapsed));
 	newGang->type = type;
 
 	/*
@@ -652,6 +661,7 @@ DisconnectAndDestroyAllGangs(bool resetSession)
     }
 
 	/* cleanup all out bound dispatcher state */
+	cdbdisp_cancelDeferredDispatch();
 	CdbResourceOwnerWalker(CurrentResourceOwner, cdbdisp_cleanupDispatcherHandle);
 	
 	/* destroy cdb_component_dbs, disconnect all connections with QEs */
@@ -26,7 +26,11 @@
 #include "cdb/ml_ipc.h"
 #include "cdb/tupleremap.h"
 #include "cdb/tupser.h"
+#include "miscadmin.h"
+#include "storage/latch.h"
 #include "utils/memutils.h"
+#include "utils/timeout.h"
+#include "utils/timestamp.h"
 #include "utils/typcache.h"
 
 
@@ -35,6 +39,13 @@
  */
 int			Gp_max_tuple_chunk_size;
 
+/*
+ * Upper limit on the length of a TC_BATCH chunk, header included.  Batches
+ * are kept for every route of a sending motion, so they are capped well
+ * below a full packet; that still fits some hundred narrow tuples.
+ */
+#define MAX_SEND_BATCH_CHUNK_LENGTH	2048
+
 /*
  * STATIC STATE VARS
  *
@@ -46,6 +57,20 @@ int			Gp_max_tuple_chunk_size;
 static uint8 s_eos_buffer[sizeof(TupleChunkListItemData) + 8];
 static TupleChunkListItem s_eos_chunk_data = (TupleChunkListItem) s_eos_buffer;
 
+/*
+ * State of the MOTION_FLUSH_TIMEOUT timer, which sends out tuples that have
+ * been buffered for gp_interconnect_flush_deadline while the sender is busy
+ * elsewhere, see HandleMotionFlushInterrupt().  flushTimerFinTime is 0 when
+ * the timer is not armed.  motionSendActive is set while a send is under way
+ * and the send buffers must not be touched from an interrupt.
+ */
+volatile bool MotionFlushPending = false;
+
+static MotionLayerState *flushTimerMlStates = NULL;
+static ChunkTransportState *flushTimerTransportStates = NULL;
+static volatile TimestampTz flushTimerFinTime = 0;
+static bool motionSendActive = false;
+
 /*
  * HELPER FUNCTION DECLARATIONS
  */
@@ -69,10 +94,48 @@ static void processIncomingChunks(MotionLayerState *mlStates,
 					  int16 srcRoute);
 
 static inline void reconstructTuple(MotionNodeEntry *pMNEntry, ChunkSorterEntry *pCSEntry, TupleRemapper *remapper);
+static void reconstructBatchedTuples(MotionNodeEntry *pMNEntry, ChunkSorterEntry *pCSEntry,
+									 TupleChunkListItem tcItem, TupleRemapper *remapper);
+
+static TupleChunkListItem getSendBatch(MotionLayerState *mlStates,
+									   ChunkTransportState *transportStates,
+									   MotionNodeEntry *pMNEntry,
+									   int16 motNodeID,
+									   int16 targetRoute);
+static bool flushSendBatch(MotionLayerState *mlStates,
+						   ChunkTransportState *transportStates,
+						   MotionNodeEntry *pMNEntry,
+						   int16 motNodeID,
+						   int16 targetRoute);
+static bool checkSendDeadline(MotionLayerState *mlStates,
+							  ChunkTransportState *transportStates,
+							  MotionNodeEntry *pMNEntry,
+							  int16 motNodeID,
+							  int16 targetRoute);
+static bool flushSendRoute(MotionLayerState *mlStates,
+						   ChunkTransportState *transportStates,
+						   MotionNodeEntry *pMNEntry,
+						   int16 motNodeID,
+						   int16 targetRoute);
+static bool flushExpiredRoutes(MotionLayerState *mlStates,
+							   ChunkTransportState *transportStates,
+							   MotionNodeEntry *pMNEntry,
+							   int16 motNodeID,
+							   TimestampTz now);
+static void armFlushTimer(MotionLayerState *mlStates,
+						  ChunkTransportState *transportStates,
+						  TimestampTz fin_time);
+static SendReturnCode SendTupleInternal(MotionLayerState *mlStates,
+										ChunkTransportState *transportStates,
+										int16 motNodeID,
+										TupleTableSlot *slot,
+										int16 targetRoute);
 
 /* Stats-function declarations. */
 static void statSendTuple(MotionLayerState *mlStates, MotionNodeEntry *pMNEntry, TupleChunkList tcList);
 static void statSendEOS(MotionLayerState *mlStates, MotionNodeEntry *pMNEntry);
+static void countSendCopy(ChunkTransportState *transportStates, int16 motNodeID, int bytes);
+static void statSendBatch(MotionLayerState *mlStates, MotionNodeEntry *pMNEntry);
 static void statChunksProcessed(MotionLayerState *mlStates, MotionNodeEntry *pMNEntry, int chunksProcessed, int chunkBytes, int tupleBytes);
 static void statNewTupleArrived(MotionNodeEntry *pMNEntry, ChunkSorterEntry *pCSEntry);
 static void statRecvTuple(MotionNodeEntry *pMNEntry, ChunkSorterEntry *pCSEntry);
@@ -111,6 +174,31 @@ reconstructTuple(MotionNodeEntry *pMNEntry, ChunkSorterEntry *pCSEntry, TupleRem
 	statNewTupleArrived(pMNEntry, pCSEntry);
 }
 
+/*
+ * Like reconstructTuple(), for all the tuples carried by a TC_BATCH chunk.
+ */
+static void
+reconstructBatchedTuples(MotionNodeEntry *pMNEntry, ChunkSorterEntry *pCSEntry,
+						 TupleChunkListItem tcItem, TupleRemapper *remapper)
+{
+	SerTupInfo *pSerInfo = &pMNEntry->ser_tup_info;
+	MinimalTuple tup;
+	int			offset = TUPLE_CHUNK_HEADER_SIZE;
+
+	while ((tup = CvtBatchChunkToTup(tcItem, &offset)) != NULL)
+	{
+		tup = TRCheckAndRemap(remapper, pSerInfo->tupdesc, tup);
+
+		htfifo_addtuple(pCSEntry->ready_tuples, tup);
+
+		/* Stats */
+		statNewTupleArrived(pMNEntry, pCSEntry);
+	}
+
+	/* The batch was received in place, only the list item is ours. */
+	pfree(tcItem);
+}
+
 /*
  * FUNCTION DEFINITIONS
  */
@@ -144,6 +232,10 @@ RemoveMotionLayer(MotionLayerState *mlStates)
 			 mlStates->stat_total_chunkproc_calls);
 #endif
 
+	/* Normally done at interconnect teardown already. */
+	if (flushTimerMlStates == mlStates)
+		DisarmMotionFlush(flushTimerTransportStates);
+
 	/*
 	 * Free all memory used by the Motion Layer in the processing of this
 	 * query.
@@ -285,6 +377,14 @@ UpdateMotionLayerNode(MotionLayerState *mlStates, int16 motNodeID, bool preserve
 
 	pEntry->num_stream_ends_recvd = 0;
 
+	pEntry->send_batches = NULL;
+	pEntry->num_send_batches = 0;
+
+	pEntry->send_last_time = NULL;
+	pEntry->send_pending_since = NULL;
+	pEntry->send_oldest_pending = 0;
+	pEntry->num_send_routes = 0;
+
 	/* Initialize statistics counters. */
 	pEntry->stat_total_chunks_sent = 0;
 	pEntry->stat_total_bytes_sent = 0;
@@ -392,6 +492,15 @@ CheckAndSendRecordCache(MotionLayerState *mlStates,
 	if (!ShouldSendRecordCache(conn, &pMNEntry->ser_tup_info))
 		return;
 
+	motionSendActive = true;
+
+	/* Send the tuples batched so far ahead of the record cache. */
+	if (!flushSendBatch(mlStates, transportStates, pMNEntry, motNodeID, targetRoute))
+	{
+		motionSendActive = false;
+		return;
+	}
+
 #ifdef AMS_VERBOSE_LOGGING
 	elog(DEBUG5, "Serializing RecordCache for sending.");
 #endif
@@ -428,6 +537,8 @@ CheckAndSendRecordCache(MotionLayerState *mlStates,
 	clearTCList(&pMNEntry->ser_tup_info.chunkCache, &tcList);
 
 	UpdateSentRecordCache(conn);
+
+	motionSendActive = false;
 }
 
 /*
@@ -439,11 +550,33 @@ SendTuple(MotionLayerState *mlStates,
 		  int16 motNodeID,
 		  TupleTableSlot *slot,
 		  int16 targetRoute)
+{
+	SendReturnCode rc;
+
+	/*
+	 * Keep the deadline flush out of the send buffers until we're done with
+	 * them.  An error resets this in DisarmMotionFlush().
+	 */
+	motionSendActive = true;
+	rc = SendTupleInternal(mlStates, transportStates, motNodeID, slot, targetRoute);
+	motionSendActive = false;
+
+	return rc;
+}
+
+static SendReturnCode
+SendTupleInternal(MotionLayerState *mlStates,
+				  ChunkTransportState *transportStates,
+				  int16 motNodeID,
+				  TupleTableSlot *slot,
+				  int16 targetRoute)
 {
 	MotionNodeEntry *pMNEntry;
 	TupleChunkListData tcList;
+	TupleChunkListItem batch = NULL;
 	MemoryContext oldCtxt;
 	SendReturnCode rc;
+	int			sent;
 
 	AssertArg(!TupIsNull(slot));
 
@@ -464,18 +597,52 @@ SendTuple(MotionLayerState *mlStates,
 	elog(DEBUG5, "Serializing HeapTuple for sending.");
 #endif
 
-	struct directTransportBuffer b;
-	if (targetRoute != BROADCAST_SEGIDX)
-		getTransportDirectBuffer(transportStates, motNodeID, targetRoute, &b);
+	/*
+	 * Narrow tuples are collected into a TC_BATCH chunk for the route, which
+	 * goes out once it is full.
+	 */
+	if (gp_interconnect_tuple_batching)
+		batch = getSendBatch(mlStates, transportStates, pMNEntry, motNodeID, targetRoute);
+
+	for (;;)
+	{
+		struct directTransportBuffer b;
 
-	int			sent = 0;
+		if (targetRoute != BROADCAST_SEGIDX)
+			getTransportDirectBuffer(transportStates, motNodeID, targetRoute, &b);
 
-	/* Create and store the serialized form, and some stats about it. */
-	oldCtxt = MemoryContextSwitchTo(mlStates->motion_layer_mctx);
+		/* Create and store the serialized form, and some stats about it. */
+		oldCtxt = MemoryContextSwitchTo(mlStates->motion_layer_mctx);
 
-	sent = SerializeTuple(slot, &pMNEntry->ser_tup_info, &b, &tcList, targetRoute);
+		sent = SerializeTuple(slot, &pMNEntry->ser_tup_info, &b, &tcList, targetRoute,
+							  batch, Min(Gp_max_tuple_chunk_size, MAX_SEND_BATCH_CHUNK_LENGTH));
+
+		MemoryContextSwitchTo(oldCtxt);
+
+		if (sent != SERIALIZE_FLUSH_BATCH)
+			break;
+
+		/* The batched tuples have to go out first, then try again. */
+		if (!flushSendBatch(mlStates, transportStates, pMNEntry, motNodeID, targetRoute))
+			return STOP_SENDING;
+	}
+
+	if (sent == SERIALIZED_INTO_BATCH)
+	{
+		countSendCopy(transportStates, motNodeID, tcList.serialized_data_length);
+
+		/* the chunk is counted when the batch is sent, see statSendBatch() */
+		tcList.num_chunks = 0;
+
+		statSendTuple(mlStates, pMNEntry, &tcList);
+
+		if (gp_interconnect_flush_deadline > 0 &&
+			!checkSendDeadline(mlStates, transportStates, pMNEntry, motNodeID, targetRoute))
+			return STOP_SENDING;
+
+		return SEND_COMPLETE;
+	}
 
-	MemoryContextSwitchTo(oldCtxt);
 	if (sent > 0)
 	{
 		putTransportDirectBuffer(transportStates, motNodeID, targetRoute, sent);
@@ -487,10 +654,16 @@ SendTuple(MotionLayerState *mlStates,
 		/* update stats */
 		statSendTuple(mlStates, pMNEntry, &tcList);
 
+		if (gp_interconnect_flush_deadline > 0 &&
+			!checkSendDeadline(mlStates, transportStates, pMNEntry, motNodeID, targetRoute))
+			return STOP_SENDING;
+
 		return SEND_COMPLETE;
 	}
 	/* Otherwise fall-through */
 
+	countSendCopy(transportStates, motNodeID, tcList.serialized_data_length);
+
 #ifdef AMS_VERBOSE_LOGGING
 	elog(DEBUG5, "Serialized HeapTuple for sending:\n"
 		 "\ttarget-route %d \n"
@@ -518,9 +691,362 @@ SendTuple(MotionLayerState *mlStates,
 	/* cleanup */
 	clearTCList(&pMNEntry->ser_tup_info.chunkCache, &tcList);
 
+	if (rc == SEND_COMPLETE && gp_interconnect_flush_deadline > 0 &&
+		!checkSendDeadline(mlStates, transportStates, pMNEntry, motNodeID, targetRoute))
+		rc = STOP_SENDING;
+
 	return rc;
 }
 
+/*
+ * Get the TC_BATCH chunk collecting tuples for a route, allocating the
+ * motion node's batches on first use.
+ */
+static TupleChunkListItem
+getSendBatch(MotionLayerState *mlStates,
+			 ChunkTransportState *transportStates,
+			 MotionNodeEntry *pMNEntry,
+			 int16 motNodeID,
+			 int16 targetRoute)
+{
+	TupleChunkListItem *batchp;
+
+	if (pMNEntry->send_batches == NULL)
+	{
+		ChunkTransportStateEntry *pEntry = NULL;
+
+		getChunkTransportState(transportStates, motNodeID, &pEntry);
+
+		/* one for every connection, plus one for broadcasts */
+		pMNEntry->num_send_batches = pEntry->numConns + 1;
+		pMNEntry->send_batches = (TupleChunkListItem *)
+			MemoryContextAllocZero(mlStates->motion_layer_mctx,
+								   pMNEntry->num_send_batches * sizeof(TupleChunkListItem));
+	}
+
+	if (targetRoute == BROADCAST_SEGIDX)
+		batchp = &pMNEntry->send_batches[pMNEntry->num_send_batches - 1];
+	else
+	{
+		Assert(targetRoute >= 0 && targetRoute < pMNEntry->num_send_batches - 1);
+		batchp = &pMNEntry->send_batches[targetRoute];
+	}
+
+	if (*batchp == NULL)
+	{
+		TupleChunkListItem batch;
+
+		batch = (TupleChunkListItem)
+			MemoryContextAlloc(mlStates->motion_layer_mctx,
+							   sizeof(TupleChunkListItemData) +
+							   Min(Gp_max_tuple_chunk_size, MAX_SEND_BATCH_CHUNK_LENGTH));
+		batch->p_next = NULL;
+		batch->inplace = NULL;
+		batch->chunk_length = TUPLE_CHUNK_HEADER_SIZE;
+		SetChunkType(batch->chunk_data, TC_BATCH);
+		SetChunkDataSize(batch->chunk_data, 0);
+
+		*batchp = batch;
+	}
+
+	return *batchp;
+}
+
+/*
+ * Send the tuples collected in a route's TC_BATCH chunk, if any.
+ *
+ * Returns false if the receiver no longer wants tuples from us.
+ */
+static bool
+flushSendBatch(MotionLayerState *mlStates,
+			   ChunkTransportState *transportStates,
+			   MotionNodeEntry *pMNEntry,
+			   int16 motNodeID,
+			   int16 targetRoute)
+{
+	TupleChunkListItem batch;
+	bool		ok = true;
+
+	if (pMNEntry->send_batches == NULL)
+		return true;
+
+	if (targetRoute == BROADCAST_SEGIDX)
+		batch = pMNEntry->send_batches[pMNEntry->num_send_batches - 1];
+	else
+		batch = pMNEntry->send_batches[targetRoute];
+
+	if (batch == NULL || batch->chunk_length == TUPLE_CHUNK_HEADER_SIZE)
+		return true;
+
+	if (!SendTupleChunkToAMS(mlStates, transportStates, motNodeID, targetRoute, batch))
+	{
+		pMNEntry->stopped = true;
+		ok = false;
+	}
+	else
+		statSendBatch(mlStates, pMNEntry);
+
+	batch->chunk_length = TUPLE_CHUNK_HEADER_SIZE;
+	SetChunkDataSize(batch->chunk_data, 0);
+
+	return ok;
+}
+
+/*
+ * Enforce gp_interconnect_flush_deadline after a tuple went to a route.
+ *
+ * A route that went a whole deadline without a tuple is flushed right away,
+ * so the first tuples after a quiet spell, like the few rows a LIMIT waits
+ * for, are not held back for a packet that would take long to fill.  Busy
+ * routes keep filling whole packets; whatever has been buffered for a
+ * deadline by then is flushed on the next send of the motion, or by the
+ * MOTION_FLUSH_TIMEOUT timer if the sender is busy elsewhere.
+ *
+ * Returns false if the receiver no longer wants tuples from us.
+ */
+static bool
+checkSendDeadline(MotionLayerState *mlStates,
+				  ChunkTransportState *transportStates,
+				  MotionNodeEntry *pMNEntry,
+				  int16 motNodeID,
+				  int16 targetRoute)
+{
+	TimestampTz now = GetCurrentTimestamp();
+	TimestampTz deadline = (TimestampTz) gp_interconnect_flush_deadline * 1000;
+	int			idx;
+	bool		quiet;
+
+	if (pMNEntry->send_last_time == NULL)
+	{
+		ChunkTransportStateEntry *pEntry = NULL;
+
+		getChunkTransportState(transportStates, motNodeID, &pEntry);
+
+		/* one for every connection, plus one for broadcasts */
+		pMNEntry->num_send_routes = pEntry->numConns + 1;
+		pMNEntry->send_last_time = (TimestampTz *)
+			MemoryContextAllocZero(mlStates->motion_layer_mctx,
+								   pMNEntry->num_send_routes * sizeof(TimestampTz));
+		pMNEntry->send_pending_since = (TimestampTz *)
+			MemoryContextAllocZero(mlStates->motion_layer_mctx,
+								   pMNEntry->num_send_routes * sizeof(TimestampTz));
+	}
+
+	if (targetRoute == BROADCAST_SEGIDX)
+		idx = pMNEntry->num_send_routes - 1;
+	else
+		idx = targetRoute;
+
+	quiet = (now - pMNEntry->send_last_time[idx] >= deadline);
+	pMNEntry->send_last_time[idx] = now;
+
+	if (quiet)
+	{
+		if (!flushSendRoute(mlStates, transportStates, pMNEntry, motNodeID, targetRoute))
+			return false;
+	}
+	else if (pMNEntry->send_pending_since[idx] == 0)
+	{
+		pMNEntry->send_pending_since[idx] = now;
+		if (pMNEntry->send_oldest_pending == 0)
+			pMNEntry->send_oldest_pending = now;
+	}
+
+	if (pMNEntry->send_oldest_pending != 0 &&
+		now - pMNEntry->send_oldest_pending >= deadline)
+	{
+		if (!flushExpiredRoutes(mlStates, transportStates, pMNEntry, motNodeID, now))
+			return false;
+	}
+
+	if (pMNEntry->send_oldest_pending != 0)
+		armFlushTimer(mlStates, transportStates,
+					  pMNEntry->send_oldest_pending + deadline);
+
+	return true;
+}
+
+/*
+ * Flush the routes of a sending motion whose oldest buffered tuple has waited
+ * for gp_interconnect_flush_deadline, and note when the next one is due.
+ *
+ * Returns false if the receiver no longer wants tuples from us.
+ */
+static bool
+flushExpiredRoutes(MotionLayerState *mlStates,
+				   ChunkTransportState *transportStates,
+				   MotionNodeEntry *pMNEntry,
+				   int16 motNodeID,
+				   TimestampTz now)
+{
+	TimestampTz deadline = (TimestampTz) gp_interconnect_flush_deadline * 1000;
+	TimestampTz oldest = 0;
+
+	for (int i = 0; i < pMNEntry->num_send_routes; i++)
+	{
+		TimestampTz since = pMNEntry->send_pending_since[i];
+		int16		route = (i == pMNEntry->num_send_routes - 1) ? BROADCAST_SEGIDX : i;
+
+		if (since == 0)
+			continue;
+
+		if (now - since >= deadline)
+		{
+			if (!flushSendRoute(mlStates, transportStates, pMNEntry, motNodeID, route))
+				return false;
+		}
+		else if (oldest == 0 || since < oldest)
+			oldest = since;
+	}
+
+	pMNEntry->send_oldest_pending = oldest;
+
+	return true;
+}
+
+/*
+ * Send out everything buffered for a route, both the tuples in its TC_BATCH
+ * chunk and the transport's partially filled packet.
+ *
+ * Returns false if the receiver no longer wants tuples from us.
+ */
+static bool
+flushSendRoute(MotionLayerState *mlStates,
+			   ChunkTransportState *transportStates,
+			   MotionNodeEntry *pMNEntry,
+			   int16 motNodeID,
+			   int16 targetRoute)
+{
+	if (targetRoute == BROADCAST_SEGIDX)
+		pMNEntry->send_pending_since[pMNEntry->num_send_routes - 1] = 0;
+	else
+		pMNEntry->send_pending_since[targetRoute] = 0;
+
+	if (!flushSendBatch(mlStates, transportStates, pMNEntry, motNodeID, targetRoute))
+		return false;
+
+	if (!FlushTupleChunksToAMS(mlStates, transportStates, motNodeID, targetRoute))
+	{
+		pMNEntry->stopped = true;
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ * Make sure the MOTION_FLUSH_TIMEOUT timer goes off by fin_time, for the
+ * sending motions of the given motion layer.
+ */
+static void
+armFlushTimer(MotionLayerState *mlStates,
+			  ChunkTransportState *transportStates,
+			  TimestampTz fin_time)
+{
+	if (flushTimerFinTime != 0 && flushTimerFinTime <= fin_time &&
+		flushTimerMlStates == mlStates)
+		return;
+
+	flushTimerMlStates = mlStates;
+	flushTimerTransportStates = transportStates;
+	flushTimerFinTime = fin_time;
+	enable_timeout_at(MOTION_FLUSH_TIMEOUT, fin_time);
+}
+
+/*
+ * Timeout handler for MOTION_FLUSH_TIMEOUT.  The flush itself is done in
+ * HandleMotionFlushInterrupt(), once it's safe to send.
+ */
+void
+MotionFlushTimeoutHandler(void)
+{
+	flushTimerFinTime = 0;
+	MotionFlushPending = true;
+	InterruptPending = true;
+	SetLatch(MyLatch);
+
+	/* The UDP interconnect waits for packets on a latch of its own. */
+	if (Gp_interconnect_type == INTERCONNECT_TYPE_UDPIFC)
+		WakeupMainThreadUDPIFC();
+}
+
+/*
+ * Send out what the sending motions have buffered for longer than
+ * gp_interconnect_flush_deadline.
+ *
+ * Called from ProcessInterrupts() after MOTION_FLUSH_TIMEOUT went off.  The
+ * sender is somewhere in its own plan then, scanning or waiting for input to
+ * a join, possibly for much longer than the deadline.  Only the routes that
+ * are past the deadline are flushed, the others get the timer set for when
+ * they will be.  If a send is under way, the next SendTuple() takes care of
+ * it instead.
+ */
+void
+HandleMotionFlushInterrupt(void)
+{
+	MotionLayerState *mlStates = flushTimerMlStates;
+	ChunkTransportState *transportStates = flushTimerTransportStates;
+	TimestampTz deadline = (TimestampTz) gp_interconnect_flush_deadline * 1000;
+	TimestampTz next = 0;
+	TimestampTz now;
+
+	MotionFlushPending = false;
+
+	if (mlStates == NULL || motionSendActive || deadline <= 0)
+		return;
+
+	if (!transportStates->activated || transportStates->teardownActive)
+		return;
+
+	now = GetCurrentTimestamp();
+
+	motionSendActive = true;
+
+	for (int16 motNodeID = 1; motNodeID <= mlStates->mneCount; motNodeID++)
+	{
+		MotionNodeEntry *pMNEntry = &mlStates->mnEntries[motNodeID - 1];
+
+		if (!pMNEntry->valid || pMNEntry->stopped ||
+			pMNEntry->send_oldest_pending == 0)
+			continue;
+
+		/* a stopped receiver is noticed by the next SendTuple() */
+		if (now - pMNEntry->send_oldest_pending >= deadline &&
+			!flushExpiredRoutes(mlStates, transportStates, pMNEntry, motNodeID, now))
+			continue;
+
+		if (pMNEntry->send_oldest_pending != 0 &&
+			(next == 0 || pMNEntry->send_oldest_pending < next))
+			next = pMNEntry->send_oldest_pending;
+	}
+
+	motionSendActive = false;
+
+	if (next != 0)
+		armFlushTimer(mlStates, transportStates, next + deadline);
+}
+
+/*
+ * Forget about the deadline flush of a motion layer whose interconnect is
+ * being torn down.
+ */
+void
+DisarmMotionFlush(ChunkTransportState *transportStates)
+{
+	motionSendActive = false;
+
+	if (flushTimerTransportStates != transportStates)
+		return;
+
+	if (flushTimerFinTime != 0)
+		disable_timeout(MOTION_FLUSH_TIMEOUT, false);
+
+	flushTimerMlStates = NULL;
+	flushTimerTransportStates = NULL;
+	flushTimerFinTime = 0;
+	MotionFlushPending = false;
+}
+
 TupleChunkListItem
 get_eos_tuplechunklist(void)
 {
@@ -545,8 +1071,26 @@ SendEndOfStream(MotionLayerState *mlStates,
 	 */
 	pMNEntry = getMotionNodeEntry(mlStates, motNodeID);
 
+	motionSendActive = true;
+
+	/* Send out any tuples still sitting in batches. */
+	for (int i = 0; i < pMNEntry->num_send_batches; i++)
+	{
+		int16		route = (i == pMNEntry->num_send_batches - 1) ? BROADCAST_SEGIDX : i;
+
+		(void) flushSendBatch(mlStates, transportStates, pMNEntry, motNodeID, route);
+	}
+
+	/* The EOS flushes the rest, nothing is pending for the deadline anymore. */
+	if (pMNEntry->send_pending_since != NULL)
+		MemSet(pMNEntry->send_pending_since, 0,
+			   pMNEntry->num_send_routes * sizeof(TimestampTz));
+	pMNEntry->send_oldest_pending = 0;
+
 	transportStates->SendEos(transportStates, motNodeID, s_eos_chunk_data);
 
+	motionSendActive = false;
+
 	/*
 	 * We increment our own "stream-ends received" count when we send our own,
 	 * as well as when we receive one.
@@ -841,6 +1385,18 @@ EndMotionLayerNode(MotionLayerState *mlStates, int16 motNodeID, bool flushCommLa
 				 pMNEntry->stat_total_chunks_recvd
 				);
 		}
+		if (pMNEntry->ser_tup_info.stat_uncompressed_bytes > 0)
+		{
+			elog(LOG, "Interconnect seg%d slice%d motion%d compressed tuples: "
+				 UINT64_FORMAT " bytes before compression, "
+				 UINT64_FORMAT " bytes after compression.",
+				 GpIdentity.segindex,
+				 currentSliceId,
+				 motNodeID,
+				 pMNEntry->ser_tup_info.stat_uncompressed_bytes,
+				 pMNEntry->ser_tup_info.stat_compressed_bytes
+				);
+		}
 	}
 
 	CleanupSerTupInfo(&pMNEntry->ser_tup_info);
@@ -1033,6 +1589,21 @@ addChunkToSorter(ChunkTransportState *transportStates,
 
 			break;
 
+		case TC_BATCH:
+			/* There shouldn't be any partial tuple data in the list! */
+			if (chunkSorterEntry->chunk_list.num_chunks != 0)
+			{
+				ereport(ERROR,
+						(errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+						 errmsg("received TC_BATCH chunk from [src=%d,mn=%d] after partial tuple data",
+								srcRoute, motNodeID)));
+			}
+
+			/* Turn the chunk straight into HeapTuples! */
+			reconstructBatchedTuples(pMNEntry, chunkSorterEntry, tcItem, conn->remapper);
+
+			break;
+
 		case TC_PARTIAL_START:
 
 			/* There shouldn't be any partial tuple data in the list! */
@@ -1174,6 +1745,22 @@ statSendTuple(MotionLayerState *mlStates, MotionNodeEntry *pMNEntry, TupleChunkL
 
 }
 
+/*
+ * Account for a tuple that was serialized into a chunk of its own or into a
+ * batch, rather than straight into the transport's packet buffer. The
+ * transport counts its own copies of the chunk.
+ */
+static void
+countSendCopy(ChunkTransportState *transportStates, int16 motNodeID, int bytes)
+{
+	ChunkTransportStateEntry *pEntry = NULL;
+
+	getChunkTransportState(transportStates, motNodeID, &pEntry);
+
+	pEntry->stat_tuples_sent++;
+	pEntry->stat_bytes_copied += bytes;
+}
+
 static void
 statSendEOS(MotionLayerState *mlStates, MotionNodeEntry *pMNEntry)
 {
@@ -1188,6 +1775,24 @@ statSendEOS(MotionLayerState *mlStates, MotionNodeEntry *pMNEntry)
 	mlStates->stat_total_bytes_sent += TUPLE_CHUNK_HEADER_SIZE;
 }
 
+/*
+ * The tuples of a batch were counted as they were added to it, only the
+ * chunk itself is left to count.
+ */
+static void
+statSendBatch(MotionLayerState *mlStates, MotionNodeEntry *pMNEntry)
+{
+	AssertArg(pMNEntry != NULL);
+
+	/* Update motion node statistics. */
+	pMNEntry->stat_total_chunks_sent++;
+	pMNEntry->stat_total_bytes_sent += TUPLE_CHUNK_HEADER_SIZE;
+
+	/* Update global motion-layer statistics. */
+	mlStates->stat_total_chunks_sent++;
+	mlStates->stat_total_bytes_sent += TUPLE_CHUNK_HEADER_SIZE;
+}
+
 static void
 statChunksProcessed(MotionLayerState *mlStates, MotionNodeEntry *pMNEntry, int chunksProcessed, int chunkBytes, int tupleBytes)
 {
@@ -19,9 +19,11 @@
 #include "nodes/execnodes.h"	/* ExecSlice, SliceTable */
 #include "miscadmin.h"
 #include "libpq/libpq-be.h"
+#include "storage/latch.h"
 #include "utils/builtins.h"
 #include "utils/memutils.h"
 
+#include "cdb/cdbmotion.h"
 #include "cdb/ml_ipc.h"
 #include "cdb/cdbvars.h"
 #include "cdb/cdbdisp.h"
@@ -353,6 +355,48 @@ SendTupleChunkToAMS(MotionLayerState *mlStates,
 	return (i < pEntry->numConns);
 }
 
+/* See ml_ipc.h */
+bool
+FlushTupleChunksToAMS(MotionLayerState *mlStates,
+					  ChunkTransportState *transportStates,
+					  int16 motNodeID,
+					  int16 targetRoute)
+{
+	ChunkTransportStateEntry *pEntry = NULL;
+	MotionConn *conn;
+	int			i;
+
+	if (!transportStates)
+		elog(FATAL, "FlushTupleChunksToAMS: no transport-states.");
+	if (!transportStates->activated)
+		elog(FATAL, "FlushTupleChunksToAMS: transport states inactive");
+
+	getChunkTransportState(transportStates, motNodeID, &pEntry);
+
+	for (i = 0; i < pEntry->numConns; i++)
+	{
+		if (targetRoute != BROADCAST_SEGIDX && i != targetRoute)
+			continue;
+
+		conn = pEntry->conns + i;
+		if (!conn->stillActive)
+			continue;
+
+		if (transportStates->SendFlush != NULL)
+			transportStates->SendFlush(transportStates, pEntry, conn, motNodeID);
+	}
+
+	/* like SendTupleChunkToAMS(), we are done if no connection is active */
+	for (i = 0; i < pEntry->numConns; i++)
+	{
+		conn = pEntry->conns + i;
+		if (conn->stillActive)
+			return true;
+	}
+
+	return false;
+}
+
 /*
  * The fetches a direct pointer into our transmit buffers, along with
  * an indication as to how much data can be safely shoved into the
@@ -449,6 +493,10 @@ putTransportDirectBuffer(ChunkTransportState *transportStates,
 	{
 		conn->msgSize += length;
 		conn->tupleCount++;
+
+		/* the tuple was serialized straight into the packet */
+		pEntry->stat_tuples_sent++;
+		pEntry->stat_bytes_copied += length;
 	}
 
 	/* put buffer. */
@@ -558,6 +606,9 @@ TeardownInterconnect(ChunkTransportState *transportStates, bool hasErrors)
 {
 	interconnect_handle_t *h = find_interconnect_handle(transportStates);
 
+	/* Nothing may be flushed on a timer once teardown has started. */
+	DisarmMotionFlush(transportStates);
+
 	if (Gp_interconnect_type == INTERCONNECT_TYPE_UDPIFC)
 	{
 		TeardownUDPIFCInterconnect(transportStates, hasErrors);
@@ -637,6 +688,10 @@ createChunkTransportState(ChunkTransportState *transportStates,
 	pEntry->motNodeId = motNodeID;
 	pEntry->numConns = numConns;
 	pEntry->scanStart = 0;
+	pEntry->readWaitSet = NULL;
+	pEntry->readWaitSetDispatchFd = PGINVALID_SOCKET;
+	pEntry->stat_tuples_sent = 0;
+	pEntry->stat_bytes_copied = 0;
 	pEntry->sendSlice = sendSlice;
 	pEntry->recvSlice = recvSlice;
 
@@ -705,6 +760,19 @@ removeChunkTransportState(ChunkTransportState *transportStates,
 
 	MPP_FD_ZERO(&pEntry->readSet);
 
+	if (pEntry->stat_tuples_sent > 0 && gp_log_interconnect >= GPVARS_VERBOSITY_VERBOSE)
+		elog(LOG, "Interconnect seg%d slice%d motion%d copied " UINT64_FORMAT
+			 " bytes in user space to send " UINT64_FORMAT " tuples (%.1f bytes per tuple).",
+			 GpIdentity.segindex, currentSliceId, motNodeID,
+			 pEntry->stat_bytes_copied, pEntry->stat_tuples_sent,
+			 (double) pEntry->stat_bytes_copied / (double) pEntry->stat_tuples_sent);
+
+	if (pEntry->readWaitSet != NULL)
+	{
+		FreeWaitEventSet(pEntry->readWaitSet);
+		pEntry->readWaitSet = NULL;
+	}
+
 	return pEntry;
 }
 
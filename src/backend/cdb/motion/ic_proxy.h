@@ -46,18 +46,30 @@
 } while (0)
 
 /*
- * Build the domain socket path.
+ * The id of the current ic-proxy worker, in [0, gp_interconnect_proxy_workers).
+ *
+ * It is only meaningful in the ic-proxy processes.
+ */
+extern int	ic_proxy_worker_id;
+
+/*
+ * Build the domain socket path of the given worker.
  *
  * Every proxy on the same host must use a different path, this is important to
  * let proxies from different segments or even different clusters to coexist.
  *
- * This is ensured by including the postmaster port & pid in the path.
+ * This is ensured by including the postmaster port & pid in the path, the
+ * worker id is appended for all but the first worker.
  */
 static inline void
-ic_proxy_build_server_sock_path(char *buf, size_t bufsize)
+ic_proxy_build_server_sock_path(char *buf, size_t bufsize, int worker)
 {
-	snprintf(buf, bufsize, "/tmp/.s.PGSQL.ic_proxy.%d.%d",
-			 PostPortNumber, PostmasterPid);
+	if (worker == 0)
+		snprintf(buf, bufsize, "/tmp/.s.PGSQL.ic_proxy.%d.%d",
+				 PostPortNumber, PostmasterPid);
+	else
+		snprintf(buf, bufsize, "/tmp/.s.PGSQL.ic_proxy.%d.%d.%d",
+				 PostPortNumber, PostmasterPid, worker);
 }
 
 /*
@@ -345,6 +345,32 @@ ic_proxy_addr_get_port(const ICProxyAddr *addr)
 	return -1;
 }
 
+/*
+ * Get the address that the given ic-proxy worker of a segment listens on.
+ *
+ * Worker N listens on the port of the address plus N, so the worker 0 uses the
+ * address as is.
+ */
+void
+ic_proxy_addr_get_worker_sockaddr(const ICProxyAddr *addr, int worker,
+								  struct sockaddr_storage *sockaddr)
+{
+	*sockaddr = addr->sockaddr;
+
+	if (sockaddr->ss_family == AF_INET)
+	{
+		struct sockaddr_in *addr4 = (struct sockaddr_in *) sockaddr;
+
+		addr4->sin_port = htons(ntohs(addr4->sin_port) + worker);
+	}
+	else if (sockaddr->ss_family == AF_INET6)
+	{
+		struct sockaddr_in6 *addr6 = (struct sockaddr_in6 *) sockaddr;
+
+		addr6->sin6_port = htons(ntohs(addr6->sin6_port) + worker);
+	}
+}
+
 /*
  * Extract the name and port from a sockaddr.
  *
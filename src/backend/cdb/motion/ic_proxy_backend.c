@@ -362,7 +362,8 @@ ic_proxy_backend_on_connect_timer(uv_timer_t *timer)
 
 		memset(&addr, 0, sizeof(addr));
 		addr.sun_family = AF_UNIX;
-		ic_proxy_build_server_sock_path(addr.sun_path, sizeof(addr.sun_path));
+		ic_proxy_build_server_sock_path(addr.sun_path, sizeof(addr.sun_path),
+										ic_proxy_key_get_worker(&backend->key));
 
 		req = ic_proxy_new(uv_connect_t);
 
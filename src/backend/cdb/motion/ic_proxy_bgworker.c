@@ -20,10 +20,14 @@
 #include "cdb/ic_proxy_bgworker.h"
 #include "ic_proxy_server.h"
 
+/*
+ * The main_arg is the worker id, only the first gp_interconnect_proxy_workers
+ * workers are started.
+ */
 bool
 ICProxyStartRule(Datum main_arg)
 {
-	return true;
+	return DatumGetInt32(main_arg) < gp_interconnect_proxy_workers;
 }
 
 /*
@@ -32,6 +36,8 @@ ICProxyStartRule(Datum main_arg)
 void
 ICProxyMain(Datum main_arg)
 {
+	ic_proxy_worker_id = DatumGetInt32(main_arg);
+
 	/* main loop */
 	proc_exit(ic_proxy_server_main());
 }
@@ -16,6 +16,9 @@
 
 #include "ic_proxy_key.h"
 
+#include "cdb/cdbvars.h"
+#include "utils/hashutils.h"
+
 /*
  * Compares whether two keys are identical.
  *
@@ -160,3 +163,26 @@ ic_proxy_key_to_str(const ICProxyKey *key)
 
 	return buf;
 }
+
+/*
+ * Get the ic-proxy worker that serves a logical connection.
+ *
+ * Both ends of a logical connection must be served by the workers with the
+ * same id, as worker N only talks to the worker N of the other segments, so
+ * the result must not change after ic_proxy_key_reverse().
+ */
+int
+ic_proxy_key_get_worker(const ICProxyKey *key)
+{
+	uint32		hash;
+
+	if (gp_interconnect_proxy_workers <= 1)
+		return 0;
+
+	hash = DatumGetUInt32(hash_uint32((uint32) (key->localPid ^ key->remotePid)));
+	hash = hash_combine(hash, key->commandId);
+	hash = hash_combine(hash, ((uint32) (uint16) key->sendSliceIndex << 16) |
+						(uint16) key->recvSliceIndex);
+
+	return hash % gp_interconnect_proxy_workers;
+}
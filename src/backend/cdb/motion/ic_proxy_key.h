@@ -58,5 +58,6 @@ extern void ic_proxy_key_from_p2c_pkt(ICProxyKey *key, const ICProxyPkt *pkt);
 extern void ic_proxy_key_from_c2p_pkt(ICProxyKey *key, const ICProxyPkt *pkt);
 extern void ic_proxy_key_reverse(ICProxyKey *key);
 extern const char *ic_proxy_key_to_str(const ICProxyKey *key);
+extern int	ic_proxy_key_get_worker(const ICProxyKey *key);
 
 #endif   /* IC_PROXY_KEY_H */
@@ -27,6 +27,11 @@
 
 #include <unistd.h>
 
+/* report the loop and router stats every this many timer ticks */
+#define IC_PROXY_STATS_INTERVAL 10
+
+int			ic_proxy_worker_id = 0;
+
 static uv_loop_t	ic_proxy_server_loop;
 static uv_signal_t	ic_proxy_server_signal_hup;
 static uv_signal_t	ic_proxy_server_signal_int;
@@ -34,6 +39,17 @@ static uv_signal_t	ic_proxy_server_signal_term;
 static uv_signal_t	ic_proxy_server_signal_stop;
 static uv_timer_t	ic_proxy_server_timer;
 
+/*
+ * The loop utilization is measured by the time spent in polling, a prepare
+ * handle runs right before the poll and a check handle runs right after it.
+ */
+static uv_prepare_t	ic_proxy_server_prepare;
+static uv_check_t	ic_proxy_server_check;
+static uint64		ic_proxy_server_poll_start;
+static uint64		ic_proxy_server_idle_time;
+static uint64		ic_proxy_server_stats_start;
+static int			ic_proxy_server_stats_ticks;
+
 static uv_tcp_t		ic_proxy_peer_listener;
 static bool			ic_proxy_peer_listening;
 
@@ -133,6 +149,7 @@ static void
 ic_proxy_server_peer_listener_init(uv_loop_t *loop)
 {
 	const ICProxyAddr *addr;
+	struct sockaddr_storage sockaddr;
 	uv_tcp_t   *listener = &ic_proxy_peer_listener;
 	int			fd = -1;
 	int			ret;
@@ -177,7 +194,8 @@ ic_proxy_server_peer_listener_init(uv_loop_t *loop)
 	uv_tcp_init(loop, listener);
 	uv_tcp_nodelay(listener, true);
 
-	ret = uv_tcp_bind(listener, (struct sockaddr *) &addr->sockaddr, 0);
+	ic_proxy_addr_get_worker_sockaddr(addr, ic_proxy_worker_id, &sockaddr);
+	ret = uv_tcp_bind(listener, (struct sockaddr *) &sockaddr, 0);
 	if (ret < 0)
 	{
 		ic_proxy_log(WARNING, "ic-proxy-server: tcp: fail to bind: %s",
@@ -263,7 +281,7 @@ ic_proxy_server_client_listener_init(uv_loop_t *loop)
 	if (ic_proxy_client_listening)
 		return;
 
-	ic_proxy_build_server_sock_path(path, sizeof(path));
+	ic_proxy_build_server_sock_path(path, sizeof(path), ic_proxy_worker_id);
 
 	/* FIXME: do not unlink here */
 	ic_proxy_log(LOG, "unlink(%s) ...", path);
@@ -326,6 +344,9 @@ ic_proxy_server_client_listener_init(uv_loop_t *loop)
  * mirror promotion, X attempts to connect to Y even if Y is a mirror, or even
  * if we have connected to Y's primary.  In fact we do not know whether Y is a
  * mirror or not, and we do not care.
+ *
+ * With multiple ic-proxy workers every worker forms its own proxy network, the
+ * worker N only connects to the worker N of the other proxies.
  */
 static void
 ic_proxy_server_ensure_peers(uv_loop_t *loop)
@@ -336,6 +357,7 @@ ic_proxy_server_ensure_peers(uv_loop_t *loop)
 	{
 		ICProxyAddr *addr = lfirst(cell);
 		ICProxyPeer *peer;
+		struct sockaddr_storage sockaddr;
 
 		if (addr->content >= GpIdentity.segindex)
 			continue;
@@ -349,15 +371,68 @@ ic_proxy_server_ensure_peers(uv_loop_t *loop)
 		 * the state.
 		 */
 		peer = ic_proxy_peer_blessed_lookup(loop, addr->content, addr->dbid);
-		ic_proxy_peer_connect(peer, (struct sockaddr_in *) addr);
+		ic_proxy_addr_get_worker_sockaddr(addr, ic_proxy_worker_id, &sockaddr);
+		ic_proxy_peer_connect(peer, (struct sockaddr_in *) &sockaddr);
 	}
 }
 
+/*
+ * The loop is going to poll for I/O.
+ */
+static void
+ic_proxy_server_on_prepare(uv_prepare_t *handle)
+{
+	ic_proxy_server_poll_start = uv_hrtime();
+}
+
+/*
+ * The loop has returned from polling for I/O.
+ */
+static void
+ic_proxy_server_on_check(uv_check_t *handle)
+{
+	if (ic_proxy_server_poll_start != 0)
+		ic_proxy_server_idle_time += uv_hrtime() - ic_proxy_server_poll_start;
+
+	ic_proxy_server_poll_start = 0;
+}
+
+/*
+ * Report and reset the loop utilization and the packet latency.
+ *
+ * The utilization is the percentage of the time spent on handling the events
+ * instead of waiting for them, a worker that keeps close to 100% is saturated,
+ * more workers are needed in such a case.
+ */
+static void
+ic_proxy_server_report_stats(void)
+{
+	ICProxyRouterStats stats;
+	uint64		now = uv_hrtime();
+	uint64		elapsed = now - ic_proxy_server_stats_start;
+	uint64		idle = Min(ic_proxy_server_idle_time, elapsed);
+
+	ic_proxy_router_get_stats(&stats);
+
+	if (elapsed > 0 && gp_log_interconnect >= GPVARS_VERBOSITY_VERBOSE)
+		ic_proxy_log(LOG, "ic-proxy-server: worker %d: loop utilization %.1f%%, "
+					 UINT64_FORMAT " packets written, latency avg %.3f ms max %.3f ms",
+					 ic_proxy_worker_id,
+					 100.0 * (elapsed - idle) / elapsed,
+					 stats.npackets,
+					 stats.npackets > 0 ?
+					 stats.totalLatency / 1000000.0 / stats.npackets : 0.0,
+					 stats.maxLatency / 1000000.0);
+
+	ic_proxy_server_stats_start = now;
+	ic_proxy_server_idle_time = 0;
+}
+
 /*
  * Timer handler.
  *
  * This is used to maintain the proxy-proxy network, as well as the client and
- * peer listeners.
+ * peer listeners, the stats are also reported here periodically.
  */
 static void
 ic_proxy_server_on_timer(uv_timer_t *timer)
@@ -365,6 +440,12 @@ ic_proxy_server_on_timer(uv_timer_t *timer)
 	ic_proxy_server_peer_listener_init(timer->loop);
 	ic_proxy_server_ensure_peers(timer->loop);
 	ic_proxy_server_client_listener_init(timer->loop);
+
+	if (++ic_proxy_server_stats_ticks >= IC_PROXY_STATS_INTERVAL)
+	{
+		ic_proxy_server_stats_ticks = 0;
+		ic_proxy_server_report_stats();
+	}
 }
 
 /*
@@ -421,7 +502,8 @@ ic_proxy_server_main(void)
 {
 	char		path[MAXPGPATH];
 
-	ic_proxy_log(LOG, "ic-proxy-server: setting up");
+	ic_proxy_log(LOG, "ic-proxy-server: setting up worker %d of %d",
+				 ic_proxy_worker_id, gp_interconnect_proxy_workers);
 
 	ic_proxy_pkt_cache_init(IC_PROXY_MAX_PKT_SIZE);
 
@@ -454,6 +536,18 @@ ic_proxy_server_main(void)
 	uv_timer_init(&ic_proxy_server_loop, &ic_proxy_server_timer);
 	uv_timer_start(&ic_proxy_server_timer, ic_proxy_server_on_timer, 100, 1000);
 
+	/* the stats handles should not keep the loop alive */
+	ic_proxy_server_poll_start = 0;
+	ic_proxy_server_idle_time = 0;
+	ic_proxy_server_stats_start = uv_hrtime();
+	ic_proxy_server_stats_ticks = 0;
+	uv_prepare_init(&ic_proxy_server_loop, &ic_proxy_server_prepare);
+	uv_prepare_start(&ic_proxy_server_prepare, ic_proxy_server_on_prepare);
+	uv_unref((uv_handle_t *) &ic_proxy_server_prepare);
+	uv_check_init(&ic_proxy_server_loop, &ic_proxy_server_check);
+	uv_check_start(&ic_proxy_server_check, ic_proxy_server_on_check);
+	uv_unref((uv_handle_t *) &ic_proxy_server_check);
+
 	/* monitor the postmaster pipe to check whether postmaster is still alive */
 	uv_pipe_init(&ic_proxy_server_loop, &ic_proxy_postmaster_pipe, false);
 	uv_pipe_open(&ic_proxy_postmaster_pipe, postmaster_alive_fds[POSTMASTER_FD_WATCH]);
@@ -479,7 +573,7 @@ ic_proxy_server_main(void)
 	ic_proxy_peer_table_uninit();
 	ic_proxy_router_uninit();
 
-	ic_proxy_build_server_sock_path(path, sizeof(path));
+	ic_proxy_build_server_sock_path(path, sizeof(path), ic_proxy_worker_id);
 #if 0
 	ic_proxy_log(LOG, "unlink(%s) ...", path);
 	unlink(path);
@@ -519,6 +613,8 @@ ic_proxy_server_quit(uv_loop_t *loop, bool relaunch)
 		uv_close((uv_handle_t *) &ic_proxy_client_listener, NULL);
 	}
 	uv_timer_stop(&ic_proxy_server_timer);
+	uv_prepare_stop(&ic_proxy_server_prepare);
+	uv_check_stop(&ic_proxy_server_check);
 	uv_unref((uv_handle_t *) &ic_proxy_server_signal_hup);
 	uv_unref((uv_handle_t *) &ic_proxy_server_signal_term);
 	uv_unref((uv_handle_t *) &ic_proxy_server_signal_stop);
@@ -38,6 +38,8 @@ struct ICProxyWriteReq
 
 	ic_proxy_sent_cb callback;	/* the callback */
 	void	   *opaque;			/* the callback data */
+
+	uint64		startTime;		/* uv_hrtime() when the write is issued */
 };
 
 /*
@@ -59,6 +61,9 @@ struct ICProxyLoopback
 
 static ICProxyLoopback ic_proxy_router_loopback;
 
+/* Write latency of the packets since the last ic_proxy_router_get_stats() */
+static ICProxyRouterStats ic_proxy_router_stats;
+
 
 /*
  * The loopback check is triggered.
@@ -157,6 +162,18 @@ ic_proxy_router_init(uv_loop_t *loop)
 {
 	uv_check_init(loop, &ic_proxy_router_loopback.check);
 	ic_proxy_router_loopback.queue = NIL;
+
+	memset(&ic_proxy_router_stats, 0, sizeof(ic_proxy_router_stats));
+}
+
+/*
+ * Get the write stats and reset them.
+ */
+void
+ic_proxy_router_get_stats(ICProxyRouterStats *stats)
+{
+	*stats = ic_proxy_router_stats;
+	memset(&ic_proxy_router_stats, 0, sizeof(ic_proxy_router_stats));
 }
 
 /*
@@ -249,6 +266,13 @@ ic_proxy_router_on_write(uv_write_t *req, int status)
 {
 	ICProxyWriteReq *wreq = (ICProxyWriteReq *) req;
 	ICProxyPkt *pkt = req->data;
+	uint64		latency;
+
+	latency = uv_hrtime() - wreq->startTime;
+	ic_proxy_router_stats.npackets++;
+	ic_proxy_router_stats.totalLatency += latency;
+	ic_proxy_router_stats.maxLatency = Max(ic_proxy_router_stats.maxLatency,
+										   latency);
 
 	if (status < 0)
 		ic_proxy_log(LOG, "ic-proxy-router: fail to send %s: %s",
@@ -296,6 +320,7 @@ ic_proxy_router_write(uv_stream_t *stream, ICProxyPkt *pkt, int32 offset,
 	wreq->req.data = pkt;
 	wreq->callback = callback;
 	wreq->opaque = opaque;
+	wreq->startTime = uv_hrtime();
 
 	wbuf.base = ((char *) pkt) + offset;
 	wbuf.len = pkt->len - offset;
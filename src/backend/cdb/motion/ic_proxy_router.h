@@ -21,6 +21,17 @@
 typedef void (* ic_proxy_sent_cb) (void *opaque,
 								   const ICProxyPkt *pkt, int status);
 
+/*
+ * Latency of the router writes, in nanoseconds, measured from
+ * ic_proxy_router_write() to the completion of the write.
+ */
+typedef struct ICProxyRouterStats
+{
+	uint64		npackets;
+	uint64		totalLatency;
+	uint64		maxLatency;
+} ICProxyRouterStats;
+
 
 extern void ic_proxy_router_init(uv_loop_t *loop);
 extern void ic_proxy_router_uninit(void);
@@ -29,6 +40,7 @@ extern void ic_proxy_router_route(uv_loop_t *loop, ICProxyPkt *pkt,
 extern void ic_proxy_router_write(uv_stream_t *stream,
 								  ICProxyPkt *pkt, int32 offset,
 								  ic_proxy_sent_cb callback, void *opaque);
+extern void ic_proxy_router_get_stats(ICProxyRouterStats *stats);
 
 
 #endif   /* IC_PROXY_ROUTER_H */
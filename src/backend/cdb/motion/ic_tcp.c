@@ -20,8 +20,15 @@
 #include "nodes/print.h"
 #include "miscadmin.h"
 #include "libpq/libpq-be.h"
+#include "pgstat.h"
 #include "postmaster/postmaster.h"
+#include "storage/dsm.h"
+#include "storage/latch.h"
+#include "storage/proc.h"
+#include "storage/procarray.h"
+#include "storage/shm_mq.h"
 #include "utils/builtins.h"
+#include "utils/memutils.h"
 
 #include "cdb/cdbselect.h"
 #include "cdb/tupchunklist.h"
@@ -73,6 +80,12 @@ int			listenerBacklog = 128;
 /* our timeout value for select() and other socket operations. */
 static struct timeval tval;
 
+/*
+ * Size of the shared memory queue of a same-segment route, in packets.
+ * Roughly what a loopback socket would buffer.
+ */
+#define TCP_SHM_QUEUE_PACKETS	16
+
 static inline MotionConn *
 getMotionConn(ChunkTransportStateEntry *pEntry, int iConn)
 {
@@ -101,6 +114,14 @@ static void flushInterconnectListenerBacklog(void);
 
 static void waitOnOutbound(ChunkTransportStateEntry *pEntry);
 
+static dsm_handle createShmQueue(MotionConn *conn);
+static void attachShmQueue(MotionConn *conn, dsm_handle handle, int srcPid);
+static void detachShmQueue(MotionConn *conn);
+static bool pollShmQueue(MotionConn *conn);
+static void readPacketShm(MotionConn *conn, ChunkTransportState *transportStates);
+static bool sendShmQueue(ChunkTransportState *transportStates, MotionConn *conn,
+						 shm_mq_iovec *iov, int iovcnt);
+
 static TupleChunkListItem RecvTupleChunkFromAnyTCP(ChunkTransportState *transportStates,
 						 int16 motNodeID,
 						 int16 *srcRoute);
@@ -114,9 +135,15 @@ static void SendEosTCP(ChunkTransportState *transportStates,
 
 static bool SendChunkTCP(ChunkTransportState *transportStates,
 			 ChunkTransportStateEntry *pEntry, MotionConn *conn, TupleChunkListItem tcItem, int16 motionId);
+static bool SendFlushTCP(ChunkTransportState *transportStates,
+			 ChunkTransportStateEntry *pEntry, MotionConn *conn, int16 motionId);
 
 static bool flushBuffer(ChunkTransportState *transportStates,
 			ChunkTransportStateEntry *pEntry, MotionConn *conn, int16 motionId);
+static bool sendChunkDirect(ChunkTransportState *transportStates,
+			ChunkTransportStateEntry *pEntry, MotionConn *conn, TupleChunkListItem tcItem, int16 motionId);
+static bool sendIov(ChunkTransportState *transportStates, MotionConn *conn,
+			struct iovec *iov, int iovcnt);
 
 static void doSendStopMessageTCP(ChunkTransportState *transportStates, int16 motNodeID);
 
@@ -342,6 +369,12 @@ readPacket(MotionConn *conn, ChunkTransportState *transportStates)
 	elog(DEBUG5, "readpacket: (fd %d) (max %d) outstanding bytes %d", conn->sockfd, Gp_max_packet_size, conn->recvBytes);
 #endif
 
+	if (conn->shmMqh != NULL)
+	{
+		readPacketShm(conn, transportStates);
+		return;
+	}
+
 	/* do we have a complete message waiting to be processed ? */
 	if (conn->recvBytes >= PACKET_HEADER_SIZE)
 	{
@@ -468,6 +501,239 @@ readPacket(MotionConn *conn, ChunkTransportState *transportStates)
 #endif
 }
 
+/*
+ * Shared memory queues for same-segment routes.
+ *
+ * When a sender and its receiver run in the same segment, they are backends
+ * of the same postmaster and can share a DSM segment.  The sender creates a
+ * shm_mq and passes its handle in the registration message; the receiver
+ * attaches to it.  From then on each packet is one shm_mq message, so
+ * neither side makes a system call per packet.  The socket stays open, as
+ * stop messages and the teardown handshake still go over it.
+ */
+
+/*
+ * Create the queue for an outgoing connection.  Returns DSM_HANDLE_INVALID,
+ * and the connection uses the socket, if no DSM segment is available.
+ */
+static dsm_handle
+createShmQueue(MotionConn *conn)
+{
+	Size		size = (Size) Gp_max_packet_size * TCP_SHM_QUEUE_PACKETS;
+	shm_mq	   *mq;
+
+	/* Might be retrying a failed connection. */
+	detachShmQueue(conn);
+
+	conn->shmSeg = dsm_create(size, DSM_CREATE_NULL_IF_MAXSEGMENTS);
+	if (conn->shmSeg == NULL)
+		return DSM_HANDLE_INVALID;
+
+	/* We detach explicitly at teardown; don't tie it to a resource owner. */
+	dsm_pin_mapping(conn->shmSeg);
+
+	mq = shm_mq_create(dsm_segment_address(conn->shmSeg), size);
+	shm_mq_set_sender(mq, MyProc);
+	conn->shmMqh = shm_mq_attach(mq, conn->shmSeg, NULL);
+
+	return dsm_segment_handle(conn->shmSeg);
+}
+
+/*
+ * Attach to the queue a same-segment sender announced in its registration
+ * message.
+ *
+ * The handle comes off the network, so don't trust it: the sender must be a
+ * backend of our own postmaster, and the queue must be one it created for
+ * us and that nobody is reading yet.  Anything else is an error.
+ */
+static void
+attachShmQueue(MotionConn *conn, dsm_handle handle, int srcPid)
+{
+	PGPROC	   *sender;
+	shm_mq	   *mq;
+
+	sender = BackendPidGetProc(srcPid);
+	if (!gp_interconnect_local_shm ||
+		conn->remoteContentId != GpIdentity.segindex ||
+		sender == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+				 errmsg("interconnect error: unexpected shared memory queue from seg%d at %s",
+						conn->remoteContentId, conn->remoteHostAndPort),
+				 errdetail("srcPid=%d is not a backend of seg%d",
+						   srcPid, GpIdentity.segindex)));
+
+	conn->shmSeg = dsm_attach(handle);
+	if (conn->shmSeg == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+				 errmsg("interconnect error: could not attach to shared memory queue of seg%d at %s",
+						conn->remoteContentId, conn->remoteHostAndPort)));
+	dsm_pin_mapping(conn->shmSeg);
+
+	mq = dsm_segment_address(conn->shmSeg);
+	if (shm_mq_get_sender(mq) != sender ||
+		shm_mq_get_receiver(mq) != NULL)
+	{
+		detachShmQueue(conn);
+		ereport(ERROR,
+				(errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+				 errmsg("interconnect error: shared memory queue of seg%d at %s does not belong to this connection",
+						conn->remoteContentId, conn->remoteHostAndPort),
+				 errdetail("srcPid=%d", srcPid)));
+	}
+
+	shm_mq_set_receiver(mq, MyProc);
+	conn->shmMqh = shm_mq_attach(mq, conn->shmSeg, NULL);
+}
+
+static void
+detachShmQueue(MotionConn *conn)
+{
+	if (conn->shmMqh != NULL)
+	{
+		shm_mq_detach(conn->shmMqh);
+		conn->shmMqh = NULL;
+	}
+	if (conn->shmSeg != NULL)
+	{
+		dsm_detach(conn->shmSeg);
+		conn->shmSeg = NULL;
+	}
+}
+
+/*
+ * Try to receive the next packet of a same-segment connection without
+ * waiting.  Returns true if readPacket() won't have to wait, i.e. we got a
+ * packet or the sender is gone.
+ *
+ * The packet is left in the queue's buffer, where it stays valid until the
+ * next receive on this connection; that is as long as RecvTupleChunk()
+ * needs it.
+ */
+static bool
+pollShmQueue(MotionConn *conn)
+{
+	shm_mq_result res;
+	Size		nbytes;
+	void	   *data;
+
+	Assert(conn->recvBytes == 0);
+
+	res = shm_mq_receive(conn->shmMqh, &nbytes, &data, true);
+	if (res == SHM_MQ_WOULD_BLOCK)
+		return false;
+
+	if (res == SHM_MQ_SUCCESS)
+	{
+		conn->msgPos = data;
+		conn->recvBytes = nbytes;
+	}
+
+	return true;
+}
+
+static void
+readPacketShm(MotionConn *conn, ChunkTransportState *transportStates)
+{
+	long		timeout_ms = tval.tv_sec * 1000L + tval.tv_usec / 1000;
+	int			retry = 0;
+
+	while (conn->recvBytes == 0)
+	{
+		/* see if user canceled and stuff like that */
+		ML_CHECK_FOR_INTERRUPTS(transportStates->teardownActive);
+
+		if (pollShmQueue(conn))
+		{
+			if (conn->recvBytes != 0)
+				break;
+
+			ereport(ERROR,
+					(errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+					 errmsg("interconnect error: connection closed prematurely"),
+					 errdetail("from Remote Connection: contentId=%d at %s",
+							   conn->remoteContentId, conn->remoteHostAndPort)));
+		}
+
+		/* check for the QD cancel for every 2 seconds */
+		if (Gp_role == GP_ROLE_DISPATCH && retry++ > 4)
+		{
+			retry = 0;
+			checkForCancelFromQD(transportStates);
+		}
+
+		(void) WaitLatch(MyLatch, WL_LATCH_SET | WL_TIMEOUT | WL_EXIT_ON_PM_DEATH,
+						 timeout_ms, WAIT_EVENT_INTERCONNECT);
+		ResetLatch(MyLatch);
+	}
+
+	memcpy(&conn->msgSize, conn->msgPos, sizeof(uint32));
+	if (conn->msgSize != conn->recvBytes)
+		ereport(ERROR,
+				(errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+				 errmsg("interconnect error reading an incoming packet"),
+				 errdetail("packet of %d bytes from seg%d at %s claims to be %d bytes",
+						   conn->recvBytes, conn->remoteContentId,
+						   conn->remoteHostAndPort, conn->msgSize)));
+}
+
+/*
+ * Send one packet, gathered from 'iov', through a same-segment connection's
+ * queue.
+ *
+ * Unlike the socket path, this doesn't look for a stop message before every
+ * packet: that would cost a system call per packet.  A receiver that sent
+ * one stops reading, so we notice it as soon as the queue fills up.
+ */
+static bool
+sendShmQueue(ChunkTransportState *transportStates, MotionConn *conn,
+			 shm_mq_iovec *iov, int iovcnt)
+{
+	long		timeout_ms = tval.tv_sec * 1000L + tval.tv_usec / 1000;
+	shm_mq_result res;
+
+	for (;;)
+	{
+		int			rc;
+
+		res = shm_mq_sendv(conn->shmMqh, iov, iovcnt, true);
+		if (res == SHM_MQ_SUCCESS)
+			break;
+
+		/* the receiver has torn down its end: treat it as a stop message */
+		if (res == SHM_MQ_DETACHED)
+		{
+			conn->stillActive = false;
+			return false;
+		}
+
+		rc = WaitLatchOrSocket(MyLatch,
+							   WL_LATCH_SET | WL_SOCKET_READABLE | WL_TIMEOUT | WL_EXIT_ON_PM_DEATH,
+							   conn->sockfd, timeout_ms, WAIT_EVENT_INTERCONNECT);
+		if (rc & WL_LATCH_SET)
+			ResetLatch(MyLatch);
+
+		ML_CHECK_FOR_INTERRUPTS(transportStates->teardownActive);
+
+		/*
+		 * as a sender... if there is something to read... it must mean its a
+		 * StopSendingMessage or receiver has teared down the interconnect.
+		 */
+		if ((rc & WL_SOCKET_READABLE) || transportStates->teardownActive)
+		{
+#ifdef AMS_VERBOSE_LOGGING
+			print_connection(transportStates, conn->sockfd, "stop from");
+#endif
+			conn->stillActive = false;
+			return false;
+		}
+	}
+
+	return true;
+}
+
 static void
 flushIncomingData(int fd)
 {
@@ -603,6 +869,7 @@ setupOutgoingConnection(ChunkTransportState *transportStates, ChunkTransportStat
 		closesocket(conn->sockfd);
 		conn->sockfd = -1;
 	}
+	detachShmQueue(conn);
 
 #ifdef ENABLE_IC_PROXY
 	if (Gp_interconnect_type == INTERCONNECT_TYPE_PROXY)
@@ -837,6 +1104,11 @@ sendRegisterMessage(ChunkTransportState *transportStates, ChunkTransportStateEnt
 		regMsg->srcSessionId = gp_session_id;
 		regMsg->srcCommandCount = sliceTbl->ic_instance_id;
 
+		/* a receiver in our own segment can read from shared memory */
+		regMsg->srcShmHandle = DSM_HANDLE_INVALID;
+		if (gp_interconnect_local_shm &&
+			conn->remoteContentId == GpIdentity.segindex)
+			regMsg->srcShmHandle = createShmQueue(conn);
 
 		conn->state = mcsSendRegMsg;
 		conn->msgPos = conn->pBuff;
@@ -961,6 +1233,7 @@ readRegisterMessage(ChunkTransportState *transportStates,
 	msg.srcPid = regMsg->srcPid;
 	msg.srcSessionId = regMsg->srcSessionId;
 	msg.srcCommandCount = regMsg->srcCommandCount;
+	msg.srcShmHandle = regMsg->srcShmHandle;
 
 	/* Check for valid message format. */
 	if (msg.msgBytes != sizeof(*regMsg))
@@ -1079,6 +1352,17 @@ readRegisterMessage(ChunkTransportState *transportStates,
 	newConn->cdbProc = cdbproc;
 	newConn->remoteContentId = msg.srcContentId;
 
+	if (msg.srcShmHandle != DSM_HANDLE_INVALID)
+	{
+		attachShmQueue(newConn, msg.srcShmHandle, msg.srcPid);
+
+		if (gp_log_interconnect >= GPVARS_VERBOSITY_VERBOSE)
+			ereport(LOG,
+					(errmsg("interconnect seg%d slice%d receiving from slice%d pid=%d through shared memory",
+							GpIdentity.segindex, msg.recvSliceIndex,
+							msg.sendSliceIndex, msg.srcPid)));
+	}
+
 	/*
 	 * The caller's MotionConn object is no longer valid.
 	 */
@@ -1286,6 +1570,7 @@ SetupTCPInterconnect(EState *estate)
 	interconnect_context->RecvTupleChunkFromAny = RecvTupleChunkFromAnyTCP;
 	interconnect_context->SendEos = SendEosTCP;
 	interconnect_context->SendChunk = SendChunkTCP;
+	interconnect_context->SendFlush = SendFlushTCP;
 	interconnect_context->doSendStopMessage = doSendStopMessageTCP;
 
 #ifdef ENABLE_IC_PROXY
@@ -2054,6 +2339,8 @@ TeardownTCPInterconnect(ChunkTransportState *transportStates, bool hasErrors)
 		{
 			conn = pEntry->conns + i;
 
+			detachShmQueue(conn);
+
 			if (conn->sockfd >= 0)
 			{
 				flushIncomingData(conn->sockfd);
@@ -2110,6 +2397,7 @@ TeardownTCPInterconnect(ChunkTransportState *transportStates, bool hasErrors)
 				closesocket(conn->sockfd);
 				conn->sockfd = -1;
 			}
+			detachShmQueue(conn);
 		}
 		pEntry = removeChunkTransportState(transportStates, mySlice->sliceIndex);
 	}
@@ -2518,20 +2806,58 @@ RecvTupleChunkFromTCP(ChunkTransportState *transportStates,
 	return RecvTupleChunk(conn, transportStates);
 }
 
+/*
+ * (Re)build the wait event set used by RecvTupleChunkFromAnyTCP().
+ *
+ * The set holds every connection we still have read interest in, the process
+ * latch (so that signals wake us up) and, on the QD, the dispatcher socket.
+ * Unlike the select() it replaces, it persists across calls, so the cost of
+ * a wait depends on the number of ready sockets rather than on the number of
+ * senders.
+ */
+static void
+buildReadWaitSet(ChunkTransportStateEntry *pEntry, int waitFd)
+{
+	int			i;
+
+	if (pEntry->readWaitSet != NULL)
+		FreeWaitEventSet(pEntry->readWaitSet);
+
+	pEntry->readWaitSet = CreateWaitEventSet(GetMemoryChunkContext(pEntry->conns),
+											 pEntry->numConns + 2);
+	AddWaitEventToSet(pEntry->readWaitSet, WL_LATCH_SET, PGINVALID_SOCKET,
+					  MyLatch, NULL);
+
+	for (i = 0; i < pEntry->numConns; i++)
+	{
+		MotionConn *conn = pEntry->conns + i;
+
+		/* shared memory queues wake us up through the latch */
+		if (conn->sockfd >= 0 &&
+			MPP_FD_ISSET(conn->sockfd, &pEntry->readSet) &&
+			conn->shmMqh == NULL)
+			AddWaitEventToSet(pEntry->readWaitSet, WL_SOCKET_READABLE,
+							  conn->sockfd, NULL, conn);
+	}
+
+	if (waitFd != PGINVALID_SOCKET)
+		AddWaitEventToSet(pEntry->readWaitSet, WL_SOCKET_READABLE, waitFd,
+						  NULL, NULL);
+	pEntry->readWaitSetDispatchFd = waitFd;
+}
+
 static TupleChunkListItem
 RecvTupleChunkFromAnyTCP(ChunkTransportState *transportStates,
 						 int16 motNodeID,
 						 int16 *srcRoute)
 {
 	ChunkTransportStateEntry *pEntry = NULL;
-	MotionConn *conn;
+	MotionConn *conn = NULL;
 	TupleChunkListItem tcItem;
-	mpp_fd_set	rset;
-	int			n,
-				i,
+	WaitEvent	event;
+	long		timeout_ms;
+	int			i,
 				index;
-	bool		skipSelect = false;
-	int			waitFd = PGINVALID_SOCKET;
 
 #ifdef AMS_VERBOSE_LOGGING
 	elog(DEBUG5, "RecvTupleChunkFromAny(motNodeId=%d)", motNodeID);
@@ -2539,10 +2865,44 @@ RecvTupleChunkFromAnyTCP(ChunkTransportState *transportStates,
 
 	getChunkTransportState(transportStates, motNodeID, &pEntry);
 
+	timeout_ms = tval.tv_sec * 1000L + tval.tv_usec / 1000;
+
 	int			retry = 0;
 
-	do
+	for (;;)
 	{
+		int			waitFd = PGINVALID_SOCKET;
+
+		/*
+		 * Since we may have data in a local buffer, we may be able to
+		 * short-circuit the wait (and if we don't do this we may wait when
+		 * we have data ready, since it has already been read).  Shared
+		 * memory queues are polled here too, as they have no socket to wait
+		 * on.  We scan the connections starting from where we left off in
+		 * the last call (don't continually poll the first when others may be
+		 * ready!).
+		 */
+		index = pEntry->scanStart;
+		for (i = 0; i < pEntry->numConns; i++, index++)
+		{
+			MotionConn *c;
+
+			if (index >= pEntry->numConns)
+				index = 0;
+
+			c = pEntry->conns + index;
+			if (c->sockfd >= 0 &&
+				MPP_FD_ISSET(c->sockfd, &pEntry->readSet) &&
+				(c->recvBytes != 0 ||
+				 (c->shmMqh != NULL && pollShmQueue(c))))
+			{
+				conn = c;
+				break;
+			}
+		}
+		if (conn != NULL)
+			break;
+
 		/* Every 2 seconds */
 		if (Gp_role == GP_ROLE_DISPATCH && retry++ > 4)
 		{
@@ -2551,119 +2911,77 @@ RecvTupleChunkFromAnyTCP(ChunkTransportState *transportStates,
 			checkForCancelFromQD(transportStates);
 		}
 
-		struct timeval timeout = tval;
-		int	nfds = pEntry->highReadSock;
-		
 		/* make sure we check for these. */
 		ML_CHECK_FOR_INTERRUPTS(transportStates->teardownActive);
 
-		memcpy(&rset, &pEntry->readSet, sizeof(mpp_fd_set));
-
 		/*
-		 * since we may have data in a local buffer, we may be able to
-		 * short-circuit the select() call (and if we don't do this we may
-		 * wait when we have data ready, since it has already been read)
-		 */
-		for (i = 0; i < pEntry->numConns; i++)
-		{
-			conn = pEntry->conns + i;
-
-			if (conn->sockfd >= 0 &&
-				MPP_FD_ISSET(conn->sockfd, &rset) &&
-				conn->recvBytes != 0)
-			{
-				/* we have data on this socket, let's short-circuit our select */
-				MPP_FD_ZERO(&rset);
-				MPP_FD_SET(conn->sockfd, &rset);
-
-				skipSelect = true;
-			}
-		}
-		if (skipSelect)
-			break;
-
-		/* 
 		 * Also monitor the events on dispatch fds, eg, errors or sequence
 		 * request from QEs.
 		 */
 		if (Gp_role == GP_ROLE_DISPATCH)
-		{
 			waitFd = cdbdisp_getWaitSocketFd(transportStates->estate->dispatcherState);
-			if (waitFd != PGINVALID_SOCKET)
-			{
-				MPP_FD_SET(waitFd, &rset);
-				if (waitFd > nfds)
-					nfds = waitFd;
-			}
-		}
 
-		n = select(nfds + 1, (fd_set *) &rset, NULL, NULL, &timeout);
-		if (n < 0)
+		if (pEntry->readWaitSet == NULL ||
+			pEntry->readWaitSetDispatchFd != waitFd)
+			buildReadWaitSet(pEntry, waitFd);
+
+		if (WaitEventSetWait(pEntry->readWaitSet, timeout_ms, &event, 1,
+							 WAIT_EVENT_INTERCONNECT) == 0)
+			continue;
+
+		if (event.events & WL_LATCH_SET)
 		{
-			if (errno == EINTR)
-				continue;
-			ereport(ERROR,
-					(errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
-					 errmsg("interconnect error receiving an incoming packet"),
-					 errdetail("%s: %m", "select")));
+			ResetLatch(MyLatch);
+			continue;
 		}
-		else if (n > 0 && waitFd != PGINVALID_SOCKET && MPP_FD_ISSET(waitFd, &rset))
+
+		if (event.user_data == NULL)
 		{
 			/* handle events on dispatch connection */
 			checkForCancelFromQD(transportStates);
-			n--;
+			continue;
 		}
 
-#ifdef AMS_VERBOSE_LOGGING
-		elog(DEBUG5, "RecvTupleChunkFromAny() select() returned %d ready sockets", n);
-#endif
-	} while (n < 1);
+		conn = (MotionConn *) event.user_data;
 
-	/*
-	 * We scan the file descriptors starting from where we left off in the
-	 * last call (don't continually poll the first when others may be ready!).
-	 */
-	index = pEntry->scanStart;
-	for (i = 0; i < pEntry->numConns; i++, index++)
-	{
 		/*
-		 * avoid division ? index = ((scanStart + i) % pEntry->numConns);
+		 * Read interest in this connection was dropped after the set was
+		 * built (typically because we got its EOS, and the sender has now
+		 * gone away).  There's no way to remove a single event from a
+		 * WaitEventSet, so rebuild it.
 		 */
-		if (index >= pEntry->numConns)
-			index = 0;
-
-		conn = pEntry->conns + index;
-
-#ifdef AMS_VERBOSE_LOGGING
-		if (!conn->stillActive)
+		if (conn->sockfd != event.fd ||
+			!MPP_FD_ISSET(conn->sockfd, &pEntry->readSet))
 		{
-			elog(LOG, "RecvTupleChunkFromAny: trying to read on inactive socket %d", conn->sockfd);
+			FreeWaitEventSet(pEntry->readWaitSet);
+			pEntry->readWaitSet = NULL;
+			conn = NULL;
+			continue;
 		}
-#endif
 
-		if (conn->sockfd >= 0 &&
-			MPP_FD_ISSET(conn->sockfd, &rset))
-		{
+		break;
+	}
+
+	index = conn - pEntry->conns;
+
 #ifdef AMS_VERBOSE_LOGGING
-			elog(DEBUG5, "RecvTupleChunkFromAny() (fd %d) %d/%d", conn->sockfd, motNodeID, index);
+	if (!conn->stillActive)
+	{
+		elog(LOG, "RecvTupleChunkFromAny: trying to read on inactive socket %d", conn->sockfd);
+	}
+	elog(DEBUG5, "RecvTupleChunkFromAny() (fd %d) %d/%d", conn->sockfd, motNodeID, index);
 #endif
-			tcItem = RecvTupleChunk(conn, transportStates);
 
-			*srcRoute = index;
+	tcItem = RecvTupleChunk(conn, transportStates);
 
-			/*
-			 * advance start point (avoid doing division/modulus operation
-			 * here)
-			 */
-			pEntry->scanStart = index + 1;
+	*srcRoute = index;
 
-			return tcItem;
-		}
-	}
+	/*
+	 * advance start point (avoid doing division/modulus operation here)
+	 */
+	pEntry->scanStart = index + 1;
 
-	/* we should never ever get here... */
-	elog(FATAL, "RecvTupleChunkFromAnyTCP: didn't receive, and didn't get cancelled");
-	return NULL;				/* keep the compiler happy */
+	return tcItem;
 }
 
 /* See ml_ipc.h */
@@ -2720,12 +3038,6 @@ static bool
 flushBuffer(ChunkTransportState *transportStates,
 			ChunkTransportStateEntry *pEntry, MotionConn *conn, int16 motionId)
 {
-	char	   *sendptr;
-	int			n,
-				sent = 0;
-	mpp_fd_set	wset;
-	mpp_fd_set	rset;
-
 #ifdef AMS_VERBOSE_LOGGING
 	{
 		struct timeval snapTime;
@@ -2740,8 +3052,102 @@ flushBuffer(ChunkTransportState *transportStates,
 	*(uint32 *) conn->pBuff = conn->msgSize;
 
 	/* now send message */
-	sendptr = (char *) conn->pBuff;
-	sent = 0;
+	if (conn->shmMqh != NULL)
+	{
+		shm_mq_iovec iov;
+
+		iov.data = (char *) conn->pBuff;
+		iov.len = conn->msgSize;
+		if (!sendShmQueue(transportStates, conn, &iov, 1))
+			return false;
+	}
+	else
+	{
+		struct iovec iov;
+
+		iov.iov_base = conn->pBuff;
+		iov.iov_len = conn->msgSize;
+		if (!sendIov(transportStates, conn, &iov, 1))
+			return false;
+	}
+
+	conn->tupleCount = 0;
+	conn->msgSize = PACKET_HEADER_SIZE;
+
+	return true;
+}
+
+/*
+ * Send a large chunk as a packet of its own, gathering the packet header and
+ * the chunk straight from the chunk list instead of copying the chunk into
+ * the connection's buffer first.  Whatever is buffered goes out before it,
+ * in the same sendmsg() call on a socket.
+ */
+static bool
+sendChunkDirect(ChunkTransportState *transportStates,
+				ChunkTransportStateEntry *pEntry, MotionConn *conn, TupleChunkListItem tcItem, int16 motionId)
+{
+	uint32		pktlen = PACKET_HEADER_SIZE + tcItem->chunk_length;
+
+	Assert(pktlen <= Gp_max_packet_size);
+
+	if (conn->shmMqh != NULL)
+	{
+		shm_mq_iovec iov[2];
+
+		if (conn->msgSize > PACKET_HEADER_SIZE &&
+			!flushBuffer(transportStates, pEntry, conn, motionId))
+			return false;
+
+		iov[0].data = (char *) &pktlen;
+		iov[0].len = PACKET_HEADER_SIZE;
+		iov[1].data = (char *) tcItem->chunk_data;
+		iov[1].len = tcItem->chunk_length;
+
+		return sendShmQueue(transportStates, conn, iov, 2);
+	}
+	else
+	{
+		struct iovec iov[3];
+		int			iovcnt = 0;
+
+		if (conn->msgSize > PACKET_HEADER_SIZE)
+		{
+			*(uint32 *) conn->pBuff = conn->msgSize;
+			iov[iovcnt].iov_base = conn->pBuff;
+			iov[iovcnt].iov_len = conn->msgSize;
+			iovcnt++;
+		}
+		iov[iovcnt].iov_base = &pktlen;
+		iov[iovcnt].iov_len = PACKET_HEADER_SIZE;
+		iovcnt++;
+		iov[iovcnt].iov_base = tcItem->chunk_data;
+		iov[iovcnt].iov_len = tcItem->chunk_length;
+		iovcnt++;
+
+		if (!sendIov(transportStates, conn, iov, iovcnt))
+			return false;
+
+		conn->tupleCount = 0;
+		conn->msgSize = PACKET_HEADER_SIZE;
+
+		return true;
+	}
+}
+
+/*
+ * Write out 'iov' on a connection's socket, checking for a stop message from
+ * the receiver as we go.  'iov' is consumed.
+ */
+static bool
+sendIov(ChunkTransportState *transportStates, MotionConn *conn,
+		struct iovec *iov, int iovcnt)
+{
+	struct msghdr msg;
+	int			n;
+	mpp_fd_set	wset;
+	mpp_fd_set	rset;
+
 	do
 	{
 		struct timeval timeout;
@@ -2768,7 +3174,11 @@ flushBuffer(ChunkTransportState *transportStates,
 			return false;
 		}
 
-		if ((n = send(conn->sockfd, sendptr + sent, conn->msgSize - sent, 0)) < 0)
+		memset(&msg, 0, sizeof(msg));
+		msg.msg_iov = iov;
+		msg.msg_iovlen = iovcnt;
+
+		if ((n = sendmsg(conn->sockfd, &msg, 0)) < 0)
 		{
 			int			send_errno = errno;
 
@@ -2871,19 +3281,27 @@ flushBuffer(ChunkTransportState *transportStates,
 				ereport(ERROR,
 						(errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
 						 errmsg("interconnect error writing an outgoing packet"),
-						 errdetail("Error during send() call (error:%d) for remote connection: contentId=%d at %s",
+						 errdetail("Error during sendmsg() call (error:%d) for remote connection: contentId=%d at %s",
 								   send_errno, conn->remoteContentId,
 								   conn->remoteHostAndPort)));
 			}
 		}
 		else
 		{
-			sent += n;
+			/* skip over what the kernel took */
+			while (iovcnt > 0 && n >= (int) iov->iov_len)
+			{
+				n -= iov->iov_len;
+				iov++;
+				iovcnt--;
+			}
+			if (n > 0)
+			{
+				iov->iov_base = (char *) iov->iov_base + n;
+				iov->iov_len -= n;
+			}
 		}
-	} while (sent < conn->msgSize);
-
-	conn->tupleCount = 0;
-	conn->msgSize = PACKET_HEADER_SIZE;
+	} while (iovcnt > 0);
 
 	return true;
 }
@@ -2908,6 +3326,13 @@ SendChunkTCP(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEn
 	elog(DEBUG5, "sendChunk: msgSize %d this chunk length %d", conn->msgSize, tcItem->chunk_length);
 #endif
 
+	/*
+	 * A chunk larger than half a packet can't share a packet with another
+	 * one like it, so there is little to gain from buffering it.
+	 */
+	if (length > Gp_max_packet_size / 2)
+		return sendChunkDirect(transportStates, pEntry, conn, tcItem, motionId);
+
 	if (conn->msgSize + length > Gp_max_packet_size)
 	{
 		if (!flushBuffer(transportStates, pEntry, conn, motionId))
@@ -2916,11 +3341,25 @@ SendChunkTCP(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEn
 
 	memcpy(conn->pBuff + conn->msgSize, tcItem->chunk_data, tcItem->chunk_length);
 	conn->msgSize += length;
+	pEntry->stat_bytes_copied += length;
 
 	conn->tupleCount++;
 	return true;
 }
 
+/*
+ * Send out the partially filled packet of a connection, if it holds any
+ * chunks.
+ */
+static bool
+SendFlushTCP(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, MotionConn *conn, int16 motionId)
+{
+	if (conn->msgSize <= PACKET_HEADER_SIZE)
+		return true;
+
+	return flushBuffer(transportStates, pEntry, conn, motionId);
+}
+
 
 
 /*
@@ -33,18 +33,22 @@
 
 #include "access/transam.h"
 #include "access/xact.h"
+#include "catalog/pg_type.h"
 #include "common/ip.h"
+#include "funcapi.h"
 #include "nodes/execnodes.h"
 #include "nodes/pg_list.h"
 #include "nodes/print.h"
 #include "miscadmin.h"
 #include "libpq/libpq-be.h"
 #include "port/atomics.h"
+#include "port/pg_bitutils.h"
 #include "port/pg_crc32c.h"
 #include "pgstat.h"
 #include "postmaster/postmaster.h"
 #include "storage/latch.h"
 #include "storage/pmsignal.h"
+#include "storage/shmem.h"
 #include "utils/builtins.h"
 #include "utils/guc.h"
 #include "utils/memutils.h"
@@ -138,6 +142,22 @@ int
 /* 1/4 sec in msec */
 #define RX_THREAD_POLL_TIMEOUT (250)
 
+/*
+ * On Linux, the sender transmits up to UDPIC_MMSG_BATCH_SIZE packets and the
+ * rx thread receives up to UDPIC_RX_BATCH_SIZE packets per system call, with
+ * sendmmsg() and recvmmsg(). Elsewhere, each packet takes a sendto() or
+ * recvfrom() call.
+ */
+#if defined(__linux__)
+#define UDPIC_USE_MMSG
+#endif
+#define UDPIC_MMSG_BATCH_SIZE (16)
+#ifdef UDPIC_USE_MMSG
+#define UDPIC_RX_BATCH_SIZE (8)
+#else
+#define UDPIC_RX_BATCH_SIZE (1)
+#endif
+
 /*
  * Flags definitions for flag-field of UDP-messages
  *
@@ -323,10 +343,10 @@ struct RxBufferPool
 /*
  * The buffer pool used for keeping data packets.
  *
- * maxCount is set to 1 to make sure there is always a buffer
- * for picking packets from OS buffer.
+ * maxCount is set to UDPIC_RX_BATCH_SIZE to make sure there are always
+ * buffers for picking packets from OS buffer.
  */
-static RxBufferPool rx_buffer_pool = {1, 0, NULL};
+static RxBufferPool rx_buffer_pool = {UDPIC_RX_BATCH_SIZE, 0, NULL};
 
 /*
  * SendBufferPool
@@ -532,6 +552,27 @@ static ICGlobalControlInfo ic_control_info;
 
 #define MAX_SEQS_IN_DISORDER_ACK (4)
 
+/*
+ * Thresholds of delay based flow control, in packets queued in the network.
+ *
+ * DELAY_FC_GAMMA  - leave slow start once more than this many packets queue up.
+ * DELAY_FC_ALPHA  - grow the congestion window below this backlog.
+ * DELAY_FC_BETA   - shrink the congestion window above this backlog.
+ */
+#define DELAY_FC_GAMMA (1)
+#define DELAY_FC_ALPHA (2)
+#define DELAY_FC_BETA (4)
+
+/*
+ * Interconnect histograms.
+ *
+ * IC_RTT_HIST_BUCKETS        - RTT buckets, the first one holds RTTs below
+ *                              128us and each following one doubles that.
+ * IC_RETRANSMIT_HIST_BUCKETS - retransmit buckets: 0, 1, 2, 3, 4-7 and 8+.
+ */
+#define IC_RTT_HIST_BUCKETS (12)
+#define IC_RETRANSMIT_HIST_BUCKETS (6)
+
 /*
  * UnackQueueRing
  *
@@ -617,6 +658,10 @@ typedef struct AckSendParam
  * duplicatedPktNum          - duplicate packet number.
  * recvAckNum                - the number of Acks received.
  * statusQueryMsgNum         - the number of status query messages sent.
+ * sndSyscallNum             - the number of system calls used to send data packets.
+ * recvSyscallNum            - the number of system calls that received packets in the rx thread.
+ * rttHist                   - histogram of acked packet RTTs, in log2 buckets of microseconds.
+ * retransmitHist            - histogram of the number of times acked packets were retransmitted.
  *
  */
 typedef struct ICStatistics
@@ -638,11 +683,38 @@ typedef struct ICStatistics
 	int32		duplicatedPktNum;
 	int32		recvAckNum;
 	int32		statusQueryMsgNum;
+	int32		sndSyscallNum;
+	int32		recvSyscallNum;
+	uint64		rttHist[IC_RTT_HIST_BUCKETS];
+	uint64		retransmitHist[IC_RETRANSMIT_HIST_BUCKETS];
 } ICStatistics;
 
 /* Statistics for UDP interconnect. */
 static ICStatistics ic_statistics;
 
+/*
+ * ICSharedStatistics
+ *
+ * The RTT and retransmit histograms of all backends on this segment, summed
+ * up at interconnect teardown and exposed by gp_get_interconnect_udp_stats().
+ */
+typedef struct ICSharedStatistics
+{
+	pg_atomic_uint64 rttHist[IC_RTT_HIST_BUCKETS];
+	pg_atomic_uint64 retransmitHist[IC_RETRANSMIT_HIST_BUCKETS];
+} ICSharedStatistics;
+
+static ICSharedStatistics *ic_shared_statistics = NULL;
+
+static const char *const ic_rtt_hist_labels[IC_RTT_HIST_BUCKETS] = {
+	"<128us", "128us", "256us", "512us", "1024us", "2048us",
+	"4096us", "8192us", "16384us", "32768us", "65536us", ">=131072us"
+};
+
+static const char *const ic_retransmit_hist_labels[IC_RETRANSMIT_HIST_BUCKETS] = {
+	"0", "1", "2", "3", "4-7", ">=8"
+};
+
 /*=========================================================================
  * STATIC FUNCTIONS declarations
  */
@@ -730,6 +802,10 @@ static void SendEosUDPIFC(ChunkTransportState *transportStates,
 			  int motNodeID, TupleChunkListItem tcItem);
 static bool SendChunkUDPIFC(ChunkTransportState *transportStates,
 				ChunkTransportStateEntry *pEntry, MotionConn *conn, TupleChunkListItem tcItem, int16 motionId);
+static bool SendFlushUDPIFC(ChunkTransportState *transportStates,
+				ChunkTransportStateEntry *pEntry, MotionConn *conn, int16 motionId);
+static bool sendCurrentBuffer(ChunkTransportState *transportStates,
+				  ChunkTransportStateEntry *pEntry, MotionConn *conn, int16 motionId);
 
 static void doSendStopMessageUDPIFC(ChunkTransportState *transportStates, int16 motNodeID);
 static bool dispatcherAYT(void);
@@ -737,9 +813,13 @@ static void checkQDConnectionAlive(void);
 
 
 static void *rxThreadFunc(void *arg);
+static bool rxThreadHandlePacket(icpkthdr *pkt, int read_count,
+								 struct sockaddr_storage *peer, socklen_t peerlen);
 
 static bool handleMismatch(icpkthdr *pkt, struct sockaddr_storage *peer, int peer_len);
 static void handleAckedPacket(MotionConn *ackConn, ICBuffer *buf, uint64 now);
+static void adjustCwndByDelay(MotionConn *conn, uint64 ackTime);
+static void flushICHistograms(void);
 static bool handleAcks(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry);
 static void handleStopMsgs(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, int16 motionId);
 static void handleDisorderPacket(MotionConn *conn, int pos, uint32 tailSeq, icpkthdr *pkt);
@@ -752,6 +832,7 @@ static inline void addCRC(icpkthdr *pkt);
 static inline bool checkCRC(icpkthdr *pkt);
 static void sendBuffers(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, MotionConn *conn);
 static void sendOnce(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, ICBuffer *buf, MotionConn *conn);
+static void sendBatch(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, ICBuffer **bufs, int nbufs, MotionConn *conn);
 static inline uint64 computeExpirationPeriod(MotionConn *conn, uint32 retry);
 
 static ICBuffer *getSndBuffer(MotionConn *conn);
@@ -1458,7 +1539,8 @@ InitMotionUDPIFC(int *listenerSocketFd, uint16 *listenerPort)
 
 	/* Initialize receive buffer pool */
 	rx_buffer_pool.count = 0;
-	rx_buffer_pool.maxCount = 1;
+	/* the rx thread holds up to a batch of buffers for receiving */
+	rx_buffer_pool.maxCount = UDPIC_RX_BATCH_SIZE;
 	rx_buffer_pool.freeList = NULL;
 
 	/* Initialize send control data */
@@ -2700,6 +2782,7 @@ startOutgoingUDPConnections(ChunkTransportState *transportStates,
 
 			conn->rtt = DEFAULT_RTT;
 			conn->dev = DEFAULT_DEV;
+			conn->baseRtt = MAX_RTT;
 			conn->deadlockCheckBeginTime = 0;
 			conn->tupleCount = 0;
 			conn->msgSize = sizeof(conn->conn_info);
@@ -3071,6 +3154,7 @@ SetupUDPIFCInterconnect_Internal(SliceTable *sliceTable)
 	interconnect_context->RecvTupleChunkFromAny = RecvTupleChunkFromAnyUDPIFC;
 	interconnect_context->SendEos = SendEosUDPIFC;
 	interconnect_context->SendChunk = SendChunkUDPIFC;
+	interconnect_context->SendFlush = SendFlushUDPIFC;
 	interconnect_context->doSendStopMessage = doSendStopMessageUDPIFC;
 
 	mySlice = &interconnect_context->sliceTable->slices[sliceTable->localSlice];
@@ -3636,7 +3720,8 @@ TeardownUDPIFCInterconnect_Internal(ChunkTransportState *transportStates,
 		 " freebuf_avg %f "
 		 "mismatch_pkt_num %d disordered_pkt_num %d duplicated_pkt_num %d"
 		 " rtt/dev [" UINT64_FORMAT "/" UINT64_FORMAT ", %f/%f, " UINT64_FORMAT "/" UINT64_FORMAT "] "
-		 " cwnd %f status_query_msg_num %d",
+		 " cwnd %f status_query_msg_num %d"
+		 " snd_syscall_count %d recv_syscall_count %d",
 		 ic_control_info.isSender, isReceiver,
 		 Gp_interconnect_snd_queue_depth, Gp_interconnect_queue_depth, Gp_max_packet_size,
 		 UNACK_QUEUE_RING_SLOTS_NUM, TIMER_SPAN, DEFAULT_RTT,
@@ -3649,9 +3734,11 @@ TeardownUDPIFCInterconnect_Internal(ChunkTransportState *transportStates,
 		 (double) ((double) ic_statistics.totalBuffers) / ((double) ic_statistics.bufferCountingTime),
 		 ic_statistics.mismatchNum, ic_statistics.disorderedPktNum, ic_statistics.duplicatedPktNum,
 		 (minRtt == ~((uint64) 0) ? 0 : minRtt), (minDev == ~((uint64) 0) ? 0 : minDev), avgRtt, avgDev, maxRtt, maxDev,
-		 snd_control_info.cwnd, ic_statistics.statusQueryMsgNum);
+		 snd_control_info.cwnd, ic_statistics.statusQueryMsgNum,
+		 ic_statistics.sndSyscallNum, ic_statistics.recvSyscallNum);
 
 	ic_control_info.isSender = false;
+	flushICHistograms();
 	memset(&ic_statistics, 0, sizeof(ICStatistics));
 
 	pthread_mutex_unlock(&ic_control_info.lock);
@@ -4180,6 +4267,10 @@ logPkt(char *prefix, icpkthdr *pkt)
  *	    (4) exp_period = (SRTT + y x SDEV) << retry
  *	Here y is a constant (In implementation, we use 4) and retry is the times the
  *	packet is retransmitted.
+ *
+ *	With loss based flow control the congestion window grows on every ack and
+ *	is only cut on packet loss. With delay based flow control it is steered by
+ *	the queueing delay instead, see adjustCwndByDelay().
  */
 static void
 handleAckedPacket(MotionConn *ackConn, ICBuffer *buf, uint64 now)
@@ -4190,7 +4281,7 @@ handleAckedPacket(MotionConn *ackConn, ICBuffer *buf, uint64 now)
 
 	buf = icBufferListDelete(&ackConn->unackQueue, buf);
 
-	if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_LOSS)
+	if (Gp_interconnect_fc_method != INTERCONNECT_FC_METHOD_CAPACITY)
 	{
 		buf = icBufferListDelete(&unack_queue_ring.slots[buf->unackQueueRingSlot], buf);
 		unack_queue_ring.numOutStanding--;
@@ -4222,15 +4313,27 @@ handleAckedPacket(MotionConn *ackConn, ICBuffer *buf, uint64 now)
 				buf->conn->dev = newDEV;
 
 				/* adjust the congestion control window. */
-				if (snd_control_info.cwnd < snd_control_info.ssthresh)
+				if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_DELAY)
+					adjustCwndByDelay(buf->conn, ackTime);
+				else if (snd_control_info.cwnd < snd_control_info.ssthresh)
 					snd_control_info.cwnd += 1;
 				else
 					snd_control_info.cwnd += 1 / snd_control_info.cwnd;
 				snd_control_info.cwnd = Min(snd_control_info.cwnd, snd_buffer_pool.maxCount);
 			}
 		}
+
+		if (ackTime < 128)
+			ic_statistics.rttHist[0]++;
+		else
+			ic_statistics.rttHist[Min(pg_leftmost_one_pos64(ackTime) - 6, IC_RTT_HIST_BUCKETS - 1)]++;
 	}
 
+	if (buf->nRetry < 4)
+		ic_statistics.retransmitHist[buf->nRetry]++;
+	else
+		ic_statistics.retransmitHist[buf->nRetry < 8 ? 4 : 5]++;
+
 	buf->conn->stat_total_ack_time += ackTime;
 	buf->conn->stat_max_ack_time = Max(ackTime, buf->conn->stat_max_ack_time);
 	buf->conn->stat_min_ack_time = Min(ackTime, buf->conn->stat_min_ack_time);
@@ -4258,6 +4361,46 @@ handleAckedPacket(MotionConn *ackConn, ICBuffer *buf, uint64 now)
 #endif
 }
 
+/*
+ * adjustCwndByDelay
+ * 		Delay based (Vegas style) congestion window adjustment.
+ *
+ * 	The smallest RTT ever sampled on a connection is taken as its base RTT,
+ * 	i.e. the RTT of an empty network path. Any extra delay on top of it is
+ * 	time the packet spent in switch and socket queues, so the number of our
+ * 	own packets sitting in those queues is estimated as
+ *	    queued = cwnd x (RTT - baseRTT) / RTT
+ * 	Slow start ends as soon as more than DELAY_FC_GAMMA packets queue up.
+ * 	After that the window grows by one packet per RTT while fewer than
+ * 	DELAY_FC_ALPHA packets are queued and shrinks by one packet per RTT when
+ * 	more than DELAY_FC_BETA are, so the window settles before the queues
+ * 	overflow instead of after. Packet loss is still handled like in loss
+ * 	based flow control.
+ */
+static void
+adjustCwndByDelay(MotionConn *conn, uint64 ackTime)
+{
+	float		queued;
+
+	ackTime = Max(ackTime, MIN_RTT);
+	conn->baseRtt = Min(conn->baseRtt, ackTime);
+
+	queued = snd_control_info.cwnd * (float) (ackTime - conn->baseRtt) / (float) ackTime;
+
+	if (snd_control_info.cwnd < snd_control_info.ssthresh)
+	{
+		if (queued > DELAY_FC_GAMMA)
+			snd_control_info.ssthresh = snd_control_info.cwnd;
+		else
+			snd_control_info.cwnd += 1;
+	}
+	else if (queued < DELAY_FC_ALPHA)
+		snd_control_info.cwnd += 1 / snd_control_info.cwnd;
+	else if (queued > DELAY_FC_BETA)
+		snd_control_info.cwnd = Max(snd_control_info.cwnd - 1 / snd_control_info.cwnd,
+									snd_control_info.minCwnd);
+}
+
 /*
  * handleAck
  * 		handle acks incoming from our upstream peers.
@@ -4568,6 +4711,7 @@ sendOnce(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry,
 xmit_retry:
 	n = sendto(pEntry->txfd, buf->pkt, buf->pkt->len, 0,
 			   (struct sockaddr *) &conn->peer, conn->peer_len);
+	ic_statistics.sndSyscallNum++;
 	if (n < 0)
 	{
 		int			save_errno = errno;
@@ -4617,6 +4761,93 @@ xmit_retry:
 	return;
 }
 
+/*
+ * sendBatch
+ * 		Send several buffers of one connection, with as few system calls as
+ * 		possible.
+ *
+ * Where sendmmsg() is available, the packets are handed to the kernel in one
+ * call; otherwise this is just sendOnce() for each buffer. If sendmmsg()
+ * fails, the first unsent buffer goes through sendOnce(), which retries or
+ * reports the error exactly like a single send would, and the rest of the
+ * batch continues after it.
+ */
+static void
+sendBatch(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry,
+		  ICBuffer **bufs, int nbufs, MotionConn *conn)
+{
+#ifdef UDPIC_USE_MMSG
+	struct mmsghdr msgs[UDPIC_MMSG_BATCH_SIZE];
+	struct iovec iovs[UDPIC_MMSG_BATCH_SIZE];
+	ICBuffer   *msgbufs[UDPIC_MMSG_BATCH_SIZE];
+	int			nmsgs = 0;
+	int			sent = 0;
+
+	Assert(nbufs <= UDPIC_MMSG_BATCH_SIZE);
+
+	if (nbufs == 1)
+	{
+		sendOnce(transportStates, pEntry, bufs[0], conn);
+		return;
+	}
+
+	for (int i = 0; i < nbufs; i++)
+	{
+#ifdef USE_ASSERT_CHECKING
+		if (testmode_inject_fault(gp_udpic_dropxmit_percent))
+		{
+#ifdef AMS_VERBOSE_LOGGING
+			write_log("THROW PKT with seq %d srcpid %d despid %d", bufs[i]->pkt->seq, bufs[i]->pkt->srcPid, bufs[i]->pkt->dstPid);
+#endif
+			continue;
+		}
+#endif
+		msgbufs[nmsgs] = bufs[i];
+		iovs[nmsgs].iov_base = bufs[i]->pkt;
+		iovs[nmsgs].iov_len = bufs[i]->pkt->len;
+
+		memset(&msgs[nmsgs], 0, sizeof(struct mmsghdr));
+		msgs[nmsgs].msg_hdr.msg_name = &conn->peer;
+		msgs[nmsgs].msg_hdr.msg_namelen = conn->peer_len;
+		msgs[nmsgs].msg_hdr.msg_iov = &iovs[nmsgs];
+		msgs[nmsgs].msg_hdr.msg_iovlen = 1;
+		nmsgs++;
+	}
+
+	while (sent < nmsgs)
+	{
+		int			n;
+
+		n = sendmmsg(pEntry->txfd, &msgs[sent], nmsgs - sent, 0);
+		ic_statistics.sndSyscallNum++;
+		if (n < 0)
+		{
+			if (errno == EINTR)
+				continue;
+
+			/* let sendOnce() deal with the failing packet */
+			sendOnce(transportStates, pEntry, msgbufs[sent], conn);
+			sent++;
+			continue;
+		}
+
+		for (int i = sent; i < sent + n; i++)
+		{
+			if (msgs[i].msg_len != iovs[i].iov_len && DEBUG1 >= log_min_messages)
+				write_log("Interconnect error writing an outgoing packet [seq %d]: short transmit (given %d sent %d) during sendmmsg() call."
+						  "For Remote Connection: contentId=%d at %s",
+						  msgbufs[i]->pkt->seq, msgbufs[i]->pkt->len, (int) msgs[i].msg_len,
+						  conn->remoteContentId,
+						  conn->remoteHostAndPort);
+		}
+		sent += n;
+	}
+#else
+	for (int i = 0; i < nbufs; i++)
+		sendOnce(transportStates, pEntry, bufs[i], conn);
+#endif
+}
+
 
 /*
  * handleStopMsgs
@@ -4726,11 +4957,14 @@ handleStopMsgs(ChunkTransportState *transportStates, ChunkTransportStateEntry *p
 static void
 sendBuffers(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, MotionConn *conn)
 {
+	ICBuffer   *batch[UDPIC_MMSG_BATCH_SIZE];
+	int			nbatch = 0;
+
 	while (conn->capacity > 0 && icBufferListLength(&conn->sndQueue) > 0)
 	{
 		ICBuffer   *buf = NULL;
 
-		if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_LOSS &&
+		if (Gp_interconnect_fc_method != INTERCONNECT_FC_METHOD_CAPACITY &&
 			(icBufferListLength(&conn->unackQueue) > 0 &&
 			 unack_queue_ring.numSharedOutStanding >= (snd_control_info.cwnd - snd_control_info.minCwnd)))
 			break;
@@ -4751,7 +4985,7 @@ sendBuffers(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEnt
 
 		icBufferListAppend(&conn->unackQueue, buf);
 
-		if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_LOSS)
+		if (Gp_interconnect_fc_method != INTERCONNECT_FC_METHOD_CAPACITY)
 		{
 			unack_queue_ring.numOutStanding++;
 			if (icBufferListLength(&conn->unackQueue) > 1)
@@ -4770,12 +5004,14 @@ sendBuffers(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEnt
 		 * will be output. In the time of error message output, interrupts is
 		 * potentially checked, if there is a pending query cancel, it will
 		 * lead to a dangled buffer (memory leak).
+		 *
+		 * The buffers are collected and sent in batches, see sendBatch().
 		 */
 #ifdef TRANSFER_PROTOCOL_STATS
 		updateStats(TPE_DATA_PKT_SEND, conn, buf->pkt);
 #endif
 
-		sendOnce(transportStates, pEntry, buf, conn);
+		batch[nbatch++] = buf;
 		ic_statistics.sndPktNum++;
 
 #ifdef AMS_VERBOSE_LOGGING
@@ -4783,7 +5019,16 @@ sendBuffers(ChunkTransportState *transportStates, ChunkTransportStateEntry *pEnt
 #endif
 
 		buf->conn->sentSeq = buf->pkt->seq;
+
+		if (nbatch == UDPIC_MMSG_BATCH_SIZE)
+		{
+			sendBatch(transportStates, pEntry, batch, nbatch, conn);
+			nbatch = 0;
+		}
 	}
+
+	if (nbatch > 0)
+		sendBatch(transportStates, pEntry, batch, nbatch, conn);
 }
 
 /*
@@ -4927,7 +5172,7 @@ handleAckForDisorderPkt(ChunkTransportState *transportStates,
 			/* this is a lost packet, retransmit */
 
 			buf->nRetry++;
-			if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_LOSS)
+			if (Gp_interconnect_fc_method != INTERCONNECT_FC_METHOD_CAPACITY)
 			{
 				buf = icBufferListDelete(&unack_queue_ring.slots[buf->unackQueueRingSlot], buf);
 				putIntoUnackQueueRing(&unack_queue_ring, buf,
@@ -4973,7 +5218,7 @@ handleAckForDisorderPkt(ChunkTransportState *transportStates,
 			lostPktCnt--;
 		}
 	}
-	if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_LOSS)
+	if (Gp_interconnect_fc_method != INTERCONNECT_FC_METHOD_CAPACITY)
 	{
 		snd_control_info.ssthresh = Max(snd_control_info.cwnd / 2, snd_control_info.minCwnd);
 		snd_control_info.cwnd = snd_control_info.ssthresh;
@@ -5342,7 +5587,7 @@ checkExceptions(ChunkTransportState *transportStates,
 		checkExpirationCapacityFC(transportStates, pEntry, conn, timeout);
 	}
 
-	if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_LOSS)
+	if (Gp_interconnect_fc_method != INTERCONNECT_FC_METHOD_CAPACITY)
 	{
 		uint64		now = getCurrentTime();
 
@@ -5395,7 +5640,7 @@ computeTimeout(MotionConn *conn, int retry)
 	if (buf->nRetry == 0 && retry == 0)
 		return 0;
 
-	if (Gp_interconnect_fc_method == INTERCONNECT_FC_METHOD_LOSS)
+	if (Gp_interconnect_fc_method != INTERCONNECT_FC_METHOD_CAPACITY)
 		return TIMER_CHECKING_PERIOD;
 
 	/* for capacity based flow control */
@@ -5421,9 +5666,6 @@ SendChunkUDPIFC(ChunkTransportState *transportStates,
 {
 
 	int			length = tcItem->chunk_length;
-	int			retry = 0;
-	bool		doCheckExpiration = false;
-	bool		gotStops = false;
 
 	Assert(conn->msgSize > 0);
 
@@ -5436,11 +5678,62 @@ SendChunkUDPIFC(ChunkTransportState *transportStates,
 	{
 		memcpy(conn->pBuff + conn->msgSize, tcItem->chunk_data, tcItem->chunk_length);
 		conn->msgSize += length;
+		pEntry->stat_bytes_copied += length;
 
 		conn->tupleCount++;
 		return true;
 	}
 
+	if (!sendCurrentBuffer(transportStates, pEntry, conn, motionId))
+		return true;
+
+	/* now we can copy the input to the new buffer */
+	memcpy(conn->pBuff + conn->msgSize, tcItem->chunk_data, tcItem->chunk_length);
+	conn->msgSize += length;
+	pEntry->stat_bytes_copied += length;
+
+	conn->tupleCount++;
+
+	return true;
+}
+
+/*
+ * SendFlushUDPIFC
+ * 		sends out the partially filled buffer of a connection, if it holds
+ * 		any chunks.
+ */
+static bool
+SendFlushUDPIFC(ChunkTransportState *transportStates,
+				ChunkTransportStateEntry *pEntry,
+				MotionConn *conn,
+				int16 motionId)
+{
+	if (conn->msgSize <= sizeof(conn->conn_info))
+		return true;
+
+	(void) sendCurrentBuffer(transportStates, pEntry, conn, motionId);
+
+	return true;
+}
+
+/*
+ * sendCurrentBuffer
+ * 		queues the current buffer of a connection for transmit and waits
+ * 		for a new one.
+ *
+ * Returns false if the connection is no longer active after the stop
+ * messages received meanwhile are handled.
+ */
+static bool
+sendCurrentBuffer(ChunkTransportState *transportStates,
+				  ChunkTransportStateEntry *pEntry,
+				  MotionConn *conn,
+				  int16 motionId)
+{
+	int			retry = 0;
+	bool		doCheckExpiration = false;
+	bool		gotStops = false;
+
 	/* prepare this for transmit */
 
 	ic_statistics.totalCapacity += conn->capacity;
@@ -5496,19 +5789,13 @@ SendChunkUDPIFC(ChunkTransportState *transportStates,
 		handleStopMsgs(transportStates, pEntry, motionId);
 		gotStops = false;
 		if (!conn->stillActive)
-			return true;
+			return false;
 	}
 
 	/* reinitialize connection */
 	conn->tupleCount = 0;
 	conn->msgSize = sizeof(conn->conn_info);
 
-	/* now we can copy the input to the new buffer */
-	memcpy(conn->pBuff + conn->msgSize, tcItem->chunk_data, tcItem->chunk_length);
-	conn->msgSize += length;
-
-	conn->tupleCount++;
-
 	return true;
 }
 
@@ -6118,10 +6405,133 @@ handleDataPacket(MotionConn *conn, icpkthdr *pkt, struct sockaddr_storage *peer,
 	return true;
 }
 
+/*
+ * rxThreadHandlePacket
+ * 		Process one packet received by the rx thread.
+ *
+ * Returns true if the packet buffer was taken over (queued on its connection
+ * or cached), false if the caller may reuse it.
+ *
+ * NOTE: This function MUST NOT contain elog or ereport statements, see
+ * rxThreadFunc().
+ */
+static bool
+rxThreadHandlePacket(icpkthdr *pkt, int read_count,
+					 struct sockaddr_storage *peer, socklen_t peerlen)
+{
+	MotionConn *conn = NULL;
+	bool		consumed = false;
+	bool		wakeup_mainthread = false;
+	AckSendParam param;
+
+	if (DEBUG5 >= log_min_messages)
+		write_log("received inbound len %d", read_count);
+
+	if (read_count < sizeof(icpkthdr))
+	{
+		if (DEBUG1 >= log_min_messages)
+			write_log("Interconnect error: short conn receive (%d)", read_count);
+		return false;
+	}
+
+	/* length must be >= 0 */
+	if (pkt->len < 0)
+	{
+		if (DEBUG3 >= log_min_messages)
+			write_log("received inbound with negative length");
+		return false;
+	}
+
+	if (pkt->len != read_count)
+	{
+		if (DEBUG3 >= log_min_messages)
+			write_log("received inbound packet [%d], short: read %d bytes, pkt->len %d", pkt->seq, read_count, pkt->len);
+		return false;
+	}
+
+	/*
+	 * check the CRC of the payload.
+	 */
+	if (gp_interconnect_full_crc)
+	{
+		if (!checkCRC(pkt))
+		{
+			pg_atomic_add_fetch_u32((pg_atomic_uint32 *) &ic_statistics.crcErrors, 1);
+			if (DEBUG2 >= log_min_messages)
+				write_log("received network data error, dropping bad packet, user data unaffected.");
+			return false;
+		}
+	}
+
+#ifdef AMS_VERBOSE_LOGGING
+	logPkt("GOT MESSAGE", pkt);
+#endif
+
+	memset(&param, 0, sizeof(AckSendParam));
+
+	/*
+	 * Get the connection for the pkt.
+	 *
+	 * The connection hash table should be locked until finishing the
+	 * processing of the packet to avoid the connection addition/removal from
+	 * the hash table during the mean time.
+	 */
+
+	pthread_mutex_lock(&ic_control_info.lock);
+	conn = findConnByHeader(&ic_control_info.connHtab, pkt);
+
+	if (conn != NULL)
+	{
+		/* Handling a regular packet */
+		if (handleDataPacket(conn, pkt, peer, &peerlen, &param, &wakeup_mainthread))
+			consumed = true;
+		ic_statistics.recvPktNum++;
+	}
+	else
+	{
+		/*
+		 * There may have two kinds of Mismatched packets: a) Past packets
+		 * from previous command after I was torn down b) Future packets from
+		 * current command before my connections are built.
+		 *
+		 * The handling logic is to "Ack the past and Nak the future".
+		 */
+		if ((pkt->flags & UDPIC_FLAGS_RECEIVER_TO_SENDER) == 0)
+		{
+			if (DEBUG1 >= log_min_messages)
+				write_log("mismatched packet received, seq %d, srcpid %d, dstpid %d, icid %d, sid %d", pkt->seq, pkt->srcPid, pkt->dstPid, pkt->icId, pkt->sessionId);
+
+#ifdef AMS_VERBOSE_LOGGING
+			logPkt("Got a Mismatched Packet", pkt);
+#endif
+
+			if (handleMismatch(pkt, peer, peerlen))
+				consumed = true;
+			ic_statistics.mismatchNum++;
+		}
+	}
+	pthread_mutex_unlock(&ic_control_info.lock);
+
+	if (wakeup_mainthread)
+		SetLatch(&ic_control_info.latch);
+
+	/*
+	 * real ack sending is after lock release to decrease the lock holding
+	 * time.
+	 */
+	if (param.msg.len != 0)
+		sendAckWithParam(&param);
+
+	return consumed;
+}
+
 /*
  * rxThreadFunc
  * 		Main function of the receive background thread.
  *
+ * The thread holds up to UDPIC_RX_BATCH_SIZE receive buffers, and fills as
+ * many of them as are ready with a single recvmmsg() call where available.
+ *
  * NOTE: This function MUST NOT contain elog or ereport statements.
  * elog is NOT thread-safe.  Developers should instead use something like:
  *
@@ -6133,7 +6543,8 @@ handleDataPacket(MotionConn *conn, icpkthdr *pkt, struct sockaddr_storage *peer,
 static void *
 rxThreadFunc(void *arg)
 {
-	icpkthdr   *pkt = NULL;
+	icpkthdr   *pkts[UDPIC_RX_BATCH_SIZE];
+	int			npkts = 0;		/* buffers held, in pkts[0 .. npkts - 1] */
 	bool		skip_poll = false;
 
 	for (;;)
@@ -6151,14 +6562,21 @@ rxThreadFunc(void *arg)
 			break;
 		}
 
-		/* Try to get a buffer */
-		if (pkt == NULL)
+		/* Try to get buffers, we need at least one */
+		if (npkts < UDPIC_RX_BATCH_SIZE)
 		{
 			pthread_mutex_lock(&ic_control_info.lock);
-			pkt = getRxBuffer(&rx_buffer_pool);
+			while (npkts < UDPIC_RX_BATCH_SIZE)
+			{
+				icpkthdr   *pkt = getRxBuffer(&rx_buffer_pool);
+
+				if (pkt == NULL)
+					break;
+				pkts[npkts++] = pkt;
+			}
 			pthread_mutex_unlock(&ic_control_info.lock);
 
-			if (pkt == NULL)
+			if (npkts == 0)
 			{
 				setRxThreadError(ENOMEM);
 				continue;
@@ -6208,15 +6626,42 @@ rxThreadFunc(void *arg)
 			/* we've got something interesting to read */
 			/* handle incoming */
 			/* ready to read on our socket */
-			MotionConn *conn = NULL;
-			int			read_count = 0;
+			struct sockaddr_storage peers[UDPIC_RX_BATCH_SIZE];
+			int			read_counts[UDPIC_RX_BATCH_SIZE];
+			socklen_t	peerlens[UDPIC_RX_BATCH_SIZE];
+			int			nread;
+			int			nkept;
+
+#ifdef UDPIC_USE_MMSG
+			struct mmsghdr msgs[UDPIC_RX_BATCH_SIZE];
+			struct iovec iovs[UDPIC_RX_BATCH_SIZE];
 
-			struct sockaddr_storage peer;
-			socklen_t	peerlen;
+			for (int i = 0; i < npkts; i++)
+			{
+				iovs[i].iov_base = pkts[i];
+				iovs[i].iov_len = Gp_max_packet_size;
+
+				memset(&msgs[i], 0, sizeof(struct mmsghdr));
+				msgs[i].msg_hdr.msg_name = &peers[i];
+				msgs[i].msg_hdr.msg_namelen = sizeof(peers[i]);
+				msgs[i].msg_hdr.msg_iov = &iovs[i];
+				msgs[i].msg_hdr.msg_iovlen = 1;
+			}
 
-			peerlen = sizeof(peer);
-			read_count = recvfrom(UDP_listenerFd, (char *) pkt, Gp_max_packet_size, 0,
-								  (struct sockaddr *) &peer, &peerlen);
+			/* don't wait for more once the first packet is in */
+			nread = recvmmsg(UDP_listenerFd, msgs, npkts, MSG_WAITFORONE, NULL);
+
+			for (int i = 0; i < nread; i++)
+			{
+				read_counts[i] = msgs[i].msg_len;
+				peerlens[i] = msgs[i].msg_hdr.msg_namelen;
+			}
+#else
+			peerlens[0] = sizeof(peers[0]);
+			read_counts[0] = recvfrom(UDP_listenerFd, (char *) pkts[0], Gp_max_packet_size, 0,
+									  (struct sockaddr *) &peers[0], &peerlens[0]);
+			nread = (read_counts[0] < 0 ? -1 : 1);
+#endif
 
 			if (pg_atomic_read_u32(&ic_control_info.shutdown) == 1)
 			{
@@ -6227,10 +6672,7 @@ rxThreadFunc(void *arg)
 				break;
 			}
 
-			if (DEBUG5 >= log_min_messages)
-				write_log("received inbound len %d", read_count);
-
-			if (read_count < 0)
+			if (nread < 0)
 			{
 				skip_poll = false;
 
@@ -6251,121 +6693,40 @@ rxThreadFunc(void *arg)
 				continue;
 			}
 
-			if (read_count < sizeof(icpkthdr))
-			{
-				if (DEBUG1 >= log_min_messages)
-					write_log("Interconnect error: short conn receive (%d)", read_count);
-				continue;
-			}
+			pg_atomic_add_fetch_u32((pg_atomic_uint32 *) &ic_statistics.recvSyscallNum, 1);
 
 			/*
-			 * when we get a "good" recvfrom() result, we can skip poll()
-			 * until we get a bad one.
+			 * when we get a "good" receive result, we can skip poll() until
+			 * we get a bad one.
 			 */
 			skip_poll = true;
 
-			/* length must be >= 0 */
-			if (pkt->len < 0)
-			{
-				if (DEBUG3 >= log_min_messages)
-					write_log("received inbound with negative length");
-				continue;
-			}
-
-			if (pkt->len != read_count)
-			{
-				if (DEBUG3 >= log_min_messages)
-					write_log("received inbound packet [%d], short: read %d bytes, pkt->len %d", pkt->seq, read_count, pkt->len);
-				continue;
-			}
-
 			/*
-			 * check the CRC of the payload.
+			 * Handle the packets, and keep the buffers that were not taken
+			 * over at the front of the array for the next receive.
 			 */
-			if (gp_interconnect_full_crc)
+			nkept = 0;
+			for (int i = 0; i < npkts; i++)
 			{
-				if (!checkCRC(pkt))
-				{
-					pg_atomic_add_fetch_u32((pg_atomic_uint32 *) &ic_statistics.crcErrors, 1);
-					if (DEBUG2 >= log_min_messages)
-						write_log("received network data error, dropping bad packet, user data unaffected.");
+				if (i < nread &&
+					rxThreadHandlePacket(pkts[i], read_counts[i],
+										 &peers[i], peerlens[i]))
 					continue;
-				}
-			}
-
-#ifdef AMS_VERBOSE_LOGGING
-			logPkt("GOT MESSAGE", pkt);
-#endif
-
-			bool		wakeup_mainthread = false;
-			AckSendParam param;
-
-			memset(&param, 0, sizeof(AckSendParam));
-
-			/*
-			 * Get the connection for the pkt.
-			 *
-			 * The connection hash table should be locked until finishing the
-			 * processing of the packet to avoid the connection
-			 * addition/removal from the hash table during the mean time.
-			 */
-
-			pthread_mutex_lock(&ic_control_info.lock);
-			conn = findConnByHeader(&ic_control_info.connHtab, pkt);
-
-			if (conn != NULL)
-			{
-				/* Handling a regular packet */
-				if (handleDataPacket(conn, pkt, &peer, &peerlen, &param, &wakeup_mainthread))
-					pkt = NULL;
-				ic_statistics.recvPktNum++;
-			}
-			else
-			{
-				/*
-				 * There may have two kinds of Mismatched packets: a) Past
-				 * packets from previous command after I was torn down b)
-				 * Future packets from current command before my connections
-				 * are built.
-				 *
-				 * The handling logic is to "Ack the past and Nak the future".
-				 */
-				if ((pkt->flags & UDPIC_FLAGS_RECEIVER_TO_SENDER) == 0)
-				{
-					if (DEBUG1 >= log_min_messages)
-						write_log("mismatched packet received, seq %d, srcpid %d, dstpid %d, icid %d, sid %d", pkt->seq, pkt->srcPid, pkt->dstPid, pkt->icId, pkt->sessionId);
-
-#ifdef AMS_VERBOSE_LOGGING
-					logPkt("Got a Mismatched Packet", pkt);
-#endif
-
-					if (handleMismatch(pkt, &peer, peerlen))
-						pkt = NULL;
-					ic_statistics.mismatchNum++;
-				}
+				pkts[nkept++] = pkts[i];
 			}
-			pthread_mutex_unlock(&ic_control_info.lock);
-
-			if (wakeup_mainthread)
-				SetLatch(&ic_control_info.latch);
-
-			/*
-			 * real ack sending is after lock release to decrease the lock
-			 * holding time.
-			 */
-			if (param.msg.len != 0)
-				sendAckWithParam(&param);
+			npkts = nkept;
 		}
 
 		/* pthread_yield(); */
 	}
 
-	/* Before return, we release the packet. */
-	if (pkt)
+	/* Before return, we release the packets. */
+	if (npkts > 0)
 	{
 		pthread_mutex_lock(&ic_control_info.lock);
-		freeRxBuffer(&rx_buffer_pool, pkt);
-		pkt = NULL;
+		for (int i = 0; i < npkts; i++)
+			freeRxBuffer(&rx_buffer_pool, pkts[i]);
+		npkts = 0;
 		pthread_mutex_unlock(&ic_control_info.lock);
 	}
 
@@ -6866,6 +7227,16 @@ WaitInterconnectQuitUDPIFC(void)
 	ic_control_info.threadCreated = false;
 }
 
+/*
+ * Wake up the main thread if it is waiting for packets, so that it checks
+ * for interrupts right away.  Called from signal handlers.
+ */
+void
+WakeupMainThreadUDPIFC(void)
+{
+	SetLatch(&ic_control_info.latch);
+}
+
 /*
  * Send a dummy packet to interconnect thread to exit poll() immediately
  */
@@ -6977,3 +7348,116 @@ getActiveMotionConns(void)
 {
 	return ic_statistics.activeConnectionsNum;
 }
+
+/*
+ * Shared memory for the interconnect histograms.
+ */
+Size
+InterconnectUDPStatsShmemSize(void)
+{
+	return MAXALIGN(sizeof(ICSharedStatistics));
+}
+
+void
+InterconnectUDPStatsShmemInit(void)
+{
+	bool		found;
+	int			i;
+
+	ic_shared_statistics = (ICSharedStatistics *)
+		ShmemInitStruct("Interconnect UDP Statistics",
+						InterconnectUDPStatsShmemSize(),
+						&found);
+
+	if (!found)
+	{
+		for (i = 0; i < IC_RTT_HIST_BUCKETS; i++)
+			pg_atomic_init_u64(&ic_shared_statistics->rttHist[i], 0);
+		for (i = 0; i < IC_RETRANSMIT_HIST_BUCKETS; i++)
+			pg_atomic_init_u64(&ic_shared_statistics->retransmitHist[i], 0);
+	}
+}
+
+/*
+ * flushICHistograms
+ * 		Add the histograms of this interconnect instance to the shared ones.
+ */
+static void
+flushICHistograms(void)
+{
+	int			i;
+
+	if (ic_shared_statistics == NULL)
+		return;
+
+	for (i = 0; i < IC_RTT_HIST_BUCKETS; i++)
+	{
+		if (ic_statistics.rttHist[i] > 0)
+			pg_atomic_fetch_add_u64(&ic_shared_statistics->rttHist[i],
+									ic_statistics.rttHist[i]);
+	}
+	for (i = 0; i < IC_RETRANSMIT_HIST_BUCKETS; i++)
+	{
+		if (ic_statistics.retransmitHist[i] > 0)
+			pg_atomic_fetch_add_u64(&ic_shared_statistics->retransmitHist[i],
+									ic_statistics.retransmitHist[i]);
+	}
+}
+
+/*
+ * gp_get_interconnect_udp_stats
+ * 		Return the UDP interconnect histograms of this segment, one row per
+ * 		bucket: the "rtt" buckets first, then the "retransmits" buckets.
+ */
+Datum
+gp_get_interconnect_udp_stats(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *funcctx;
+	int			idx;
+	Datum		values[3];
+	bool		nulls[3];
+	HeapTuple	tuple;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		MemoryContext oldcontext;
+		TupleDesc	tupdesc;
+
+		funcctx = SRF_FIRSTCALL_INIT();
+		oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+		tupdesc = CreateTemplateTupleDesc(3);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 1, "metric", TEXTOID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 2, "bucket", TEXTOID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 3, "count", INT8OID, -1, 0);
+		funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+		funcctx->max_calls = IC_RTT_HIST_BUCKETS + IC_RETRANSMIT_HIST_BUCKETS;
+
+		MemoryContextSwitchTo(oldcontext);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+
+	if (funcctx->call_cntr >= funcctx->max_calls)
+		SRF_RETURN_DONE(funcctx);
+
+	idx = funcctx->call_cntr;
+	MemSet(nulls, 0, sizeof(nulls));
+
+	if (idx < IC_RTT_HIST_BUCKETS)
+	{
+		values[0] = CStringGetTextDatum("rtt");
+		values[1] = CStringGetTextDatum(ic_rtt_hist_labels[idx]);
+		values[2] = Int64GetDatum((int64) pg_atomic_read_u64(&ic_shared_statistics->rttHist[idx]));
+	}
+	else
+	{
+		idx -= IC_RTT_HIST_BUCKETS;
+		values[0] = CStringGetTextDatum("retransmits");
+		values[1] = CStringGetTextDatum(ic_retransmit_hist_labels[idx]);
+		values[2] = Int64GetDatum((int64) pg_atomic_read_u64(&ic_shared_statistics->retransmitHist[idx]));
+	}
+
+	tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+	SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+}
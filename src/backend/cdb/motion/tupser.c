@@ -33,12 +33,29 @@
 #include "utils/syscache.h"
 #include "utils/typcache.h"
 
+#ifdef USE_ZSTD
+#include <zstd.h>
+#endif
+
 /*
  * Transient record types table is sent to upsteam via a specially constructed
  * chunk, with a special "tuple length".
  */
 #define RECORD_CACHE_MAGIC_TUPLEN	-1
 
+/*
+ * A tuple body compressed with gp_interconnect_compression is sent with this
+ * special "tuple length", followed by the uncompressed length and the zstd
+ * frame.
+ */
+#define COMPRESSED_TUPLE_MAGIC_TUPLEN	-2
+
+/* Don't bother compressing tuple bodies smaller than this. */
+#define TUPLE_COMPRESS_MIN_LEN		256
+
+/* zstandard compression level to use for tuples. */
+#define TUPLE_COMPRESS_LEVEL		1
+
 /* A MemoryContext used within the tuple serialize code, so that freeing of
  * space is SUPAFAST.  It is initialized in the first call to InitSerTupInfo()
  * since that must be called before any tuple serialization or deserialization
@@ -47,6 +64,10 @@
 static MemoryContext s_tupSerMemCtxt = NULL;
 
 static void addByteStringToChunkList(TupleChunkList tcList, char *data, int datalen, TupleChunkListCache *cache);
+#ifdef USE_ZSTD
+static char *compressTupleBody(char *tupbody, int tupbodylen, int *compressedlen);
+static void uncompressTupleBody(char *src, int srclen, char *tupbody, int tupbodylen);
+#endif
 
 #define addCharToChunkList(tcList, x, c)							\
 	do															\
@@ -364,10 +385,14 @@ CandidateForSerializeDirect(int16 targetRoute, struct directTransportBuffer *b)
  * Convert a HeapTuple into a byte-sequence, and store it directly
  * into a chunklist for transmission.
  *
+ * If 'batch' is given, narrow tuples are appended to that TC_BATCH chunk
+ * instead, which holds up to 'max_batch_length' bytes including its header.
+ *
  * This code is based on the printtup_internal_20() function in printtup.c.
  */
 int
-SerializeTuple(TupleTableSlot *slot, SerTupInfo *pSerInfo, struct directTransportBuffer *b, TupleChunkList tcList, int16 targetRoute)
+SerializeTuple(TupleTableSlot *slot, SerTupInfo *pSerInfo, struct directTransportBuffer *b, TupleChunkList tcList, int16 targetRoute,
+			   TupleChunkListItem batch, int max_batch_length)
 {
 	int                natts;
 	int                dataSize = TUPLE_CHUNK_HEADER_SIZE;
@@ -379,6 +404,11 @@ SerializeTuple(TupleTableSlot *slot, SerTupInfo *pSerInfo, struct directTranspor
 	unsigned int       tupbodylen;
 	unsigned int       tuplen;
 	bool               hasExternalAttr = false;
+	int32              tuphdr[2];
+	int                tuphdrlen;
+	char               *payload;
+	int                payloadlen;
+	char               *compressed = NULL;
 
 	AssertArg(pSerInfo != NULL);
 	AssertArg(b != NULL);
@@ -461,8 +491,79 @@ SerializeTuple(TupleTableSlot *slot, SerTupInfo *pSerInfo, struct directTranspor
 	tupbody = (char *) mintuple + MINIMAL_TUPLE_DATA_OFFSET;
 	tupbodylen = mintuple->t_len - MINIMAL_TUPLE_DATA_OFFSET;
 
+	/*
+	 * If the caller collects tuples for this route in a TC_BATCH chunk, a
+	 * narrow tuple is appended to it as its body length followed by the
+	 * body. Bodies this small are never compressed, so the receiver can tell
+	 * each tuple's length from its body length alone.
+	 *
+	 * A tuple that doesn't fit, or that can't be batched while the batch
+	 * holds earlier tuples, must wait until the caller has sent the batch.
+	 */
+	if (batch != NULL)
+	{
+		int			batchedlen = sizeof(uint32) + tupbodylen;
+		bool		batchable;
+		int			result = 0;
+
+		batchable = (natts > 0 &&
+					 tupbodylen < TUPLE_COMPRESS_MIN_LEN &&
+					 TUPLE_CHUNK_HEADER_SIZE + batchedlen <= max_batch_length);
+
+		if (batchable && batch->chunk_length + batchedlen <= max_batch_length)
+		{
+			uint32		len = tupbodylen;
+
+			memcpy(batch->chunk_data + batch->chunk_length, &len, sizeof(uint32));
+			memcpy(batch->chunk_data + batch->chunk_length + sizeof(uint32), tupbody, tupbodylen);
+			batch->chunk_length += batchedlen;
+			SetChunkDataSize(batch->chunk_data, batch->chunk_length - TUPLE_CHUNK_HEADER_SIZE);
+
+			tcList->serialized_data_length = batchedlen;
+			result = SERIALIZED_INTO_BATCH;
+		}
+		else if (batchable || batch->chunk_length > TUPLE_CHUNK_HEADER_SIZE)
+			result = SERIALIZE_FLUSH_BATCH;
+
+		if (result != 0)
+		{
+			if (shouldFreeTuple)
+				pfree(mintuple);
+			return result;
+		}
+	}
+
+	/*
+	 * By default the tuple body is sent as is, after its length. A large
+	 * body is sent compressed instead if that makes it smaller.
+	 */
+	tuphdr[0] = tupbodylen;
+	tuphdrlen = sizeof(int32);
+	payload = tupbody;
+	payloadlen = tupbodylen;
+
+#ifdef USE_ZSTD
+	if (gp_interconnect_compression && tupbodylen >= TUPLE_COMPRESS_MIN_LEN)
+	{
+		int			compressedlen;
+
+		compressed = compressTupleBody(tupbody, tupbodylen, &compressedlen);
+		if (compressed != NULL)
+		{
+			tuphdr[0] = COMPRESSED_TUPLE_MAGIC_TUPLEN;
+			tuphdr[1] = tupbodylen;
+			tuphdrlen = 2 * sizeof(int32);
+			payload = compressed;
+			payloadlen = compressedlen;
+
+			pSerInfo->stat_uncompressed_bytes += tupbodylen;
+			pSerInfo->stat_compressed_bytes += compressedlen;
+		}
+	}
+#endif
+
 	/* total on-wire footprint: */
-	tuplen = tupbodylen + sizeof(int);
+	tuplen = tuphdrlen + payloadlen;
 
 	if (CandidateForSerializeDirect(targetRoute, b) &&
 		tuplen + TUPLE_CHUNK_HEADER_SIZE <= b->prilen)
@@ -470,14 +571,16 @@ SerializeTuple(TupleTableSlot *slot, SerTupInfo *pSerInfo, struct directTranspor
 		/*
 		 * The tuple fits in the direct transport buffer.
 		 */
-		memcpy(b->pri + TUPLE_CHUNK_HEADER_SIZE, &tupbodylen, sizeof(tupbodylen));
-		memcpy(b->pri + TUPLE_CHUNK_HEADER_SIZE + sizeof(int), tupbody, tupbodylen);
+		memcpy(b->pri + TUPLE_CHUNK_HEADER_SIZE, tuphdr, tuphdrlen);
+		memcpy(b->pri + TUPLE_CHUNK_HEADER_SIZE + tuphdrlen, payload, payloadlen);
 
 		dataSize += tuplen;
 
 		SetChunkType(b->pri, TC_WHOLE);
 		SetChunkDataSize(b->pri, dataSize - TUPLE_CHUNK_HEADER_SIZE);
 
+		if (compressed)
+			pfree(compressed);
 		if (shouldFreeTuple)
 			pfree(mintuple);
 		return dataSize;
@@ -494,8 +597,8 @@ SerializeTuple(TupleTableSlot *slot, SerTupInfo *pSerInfo, struct directTranspor
 
 	AssertState(s_tupSerMemCtxt != NULL);
 
-	addByteStringToChunkList(tcList, (char *) &tupbodylen, sizeof(tupbodylen), &pSerInfo->chunkCache);
-	addByteStringToChunkList(tcList, tupbody, tupbodylen, &pSerInfo->chunkCache);
+	addByteStringToChunkList(tcList, (char *) tuphdr, tuphdrlen, &pSerInfo->chunkCache);
+	addByteStringToChunkList(tcList, payload, payloadlen, &pSerInfo->chunkCache);
 
 	/*
 	 * GPDB_12_MERGE_FIXME: This function does not use this context. This context
@@ -529,6 +632,8 @@ SerializeTuple(TupleTableSlot *slot, SerTupInfo *pSerInfo, struct directTranspor
 		 */
 	}
 
+	if (compressed)
+		pfree(compressed);
 	if (shouldFreeTuple)
 		pfree(mintuple);
 
@@ -538,6 +643,50 @@ SerializeTuple(TupleTableSlot *slot, SerTupInfo *pSerInfo, struct directTranspor
 	return 0;
 }
 
+/*
+ * Deserialize the next tuple of a TC_BATCH chunk.
+ *
+ * '*offset' is the position of the next tuple within the chunk, starting
+ * right after the chunk header; it is advanced past the returned tuple.
+ * Returns NULL once all the tuples of the batch have been returned.
+ */
+MinimalTuple
+CvtBatchChunkToTup(TupleChunkListItem tcItem, int *offset)
+{
+	char	   *data = GetChunkDataPtr(tcItem);
+	int			remain = tcItem->chunk_length - *offset;
+	uint32		tupbodylen;
+	uint32		tuplen;
+	MinimalTuple tup;
+
+	AssertArg(*offset >= TUPLE_CHUNK_HEADER_SIZE);
+
+	if (remain == 0)
+		return NULL;
+
+	if (remain < sizeof(uint32))
+		ereport(ERROR,
+				(errcode(ERRCODE_PROTOCOL_VIOLATION),
+				 errmsg("truncated tuple in batch chunk")));
+
+	memcpy(&tupbodylen, data + *offset, sizeof(uint32));
+	if (tupbodylen > remain - sizeof(uint32))
+		ereport(ERROR,
+				(errcode(ERRCODE_PROTOCOL_VIOLATION),
+				 errmsg("tuple length %u in batch chunk exceeds the remaining %d bytes",
+						tupbodylen, remain)));
+
+	tuplen = tupbodylen + MINIMAL_TUPLE_DATA_OFFSET;
+	tup = palloc(tuplen);
+	tup->t_len = tuplen;
+	memcpy((char *) tup + MINIMAL_TUPLE_DATA_OFFSET,
+		   data + *offset + sizeof(uint32), tupbodylen);
+
+	*offset += sizeof(uint32) + tupbodylen;
+
+	return tup;
+}
+
 /*
  * Reassemble and deserialize a list of tuple chunks, into a tuple.
  */
@@ -694,6 +843,38 @@ CvtChunksToTup(TupleChunkList tcList, SerTupInfo *pSerInfo, TupleRemapper *remap
 
 			return NULL;
 		}
+		else if (tupbodylen == COMPRESSED_TUPLE_MAGIC_TUPLEN)
+		{
+			/* A MinimalTuple with a compressed body */
+			int			compressedlen;
+			unsigned int tuplen;
+
+			memcpy(&tupbodylen, pos, sizeof(tupbodylen));
+			pos += sizeof(tupbodylen);
+			compressedlen = serData.len - 2 * sizeof(int32);
+
+			if (tupbodylen < 0 || tupbodylen > MaxAllocSize - MINIMAL_TUPLE_DATA_OFFSET ||
+				compressedlen < 0)
+				ereport(ERROR,
+						(errcode(ERRCODE_PROTOCOL_VIOLATION),
+						 errmsg("invalid compressed tuple length %d", tupbodylen)));
+
+			tuplen = tupbodylen + MINIMAL_TUPLE_DATA_OFFSET;
+			tup = palloc(tuplen);
+			tup->t_len = tuplen;
+
+#ifdef USE_ZSTD
+			uncompressTupleBody(pos, compressedlen,
+								(char *) tup + MINIMAL_TUPLE_DATA_OFFSET, tupbodylen);
+#else
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("received a compressed tuple, but zstd is not supported by this build")));
+#endif
+
+			pSerInfo->stat_uncompressed_bytes += tupbodylen;
+			pSerInfo->stat_compressed_bytes += compressedlen;
+		}
 		else
 		{
 			/* A normal MinimalTuple */
@@ -714,3 +895,74 @@ CvtChunksToTup(TupleChunkList tcList, SerTupInfo *pSerInfo, TupleRemapper *remap
 
 	return tup;
 }
+
+#ifdef USE_ZSTD
+/*
+ * Compress a tuple body for sending.
+ *
+ * Returns a palloc'd zstd frame and its length in *compressedlen, or NULL if
+ * the body doesn't get any smaller.
+ */
+static char *
+compressTupleBody(char *tupbody, int tupbodylen, int *compressedlen)
+{
+	static ZSTD_CCtx *cxt = NULL;	/* ZSTD compression context */
+	size_t		bound;
+	size_t		result;
+	char	   *dst;
+
+	if (!cxt)
+	{
+		cxt = ZSTD_createCCtx();
+		if (!cxt)
+			elog(ERROR, "out of memory");
+	}
+
+	bound = ZSTD_compressBound(tupbodylen);
+	dst = palloc(bound);
+
+	result = ZSTD_compressCCtx(cxt, dst, bound, tupbody, tupbodylen,
+							   TUPLE_COMPRESS_LEVEL);
+	if (ZSTD_isError(result))
+		elog(ERROR, "tuple compression failed: %s", ZSTD_getErrorName(result));
+
+	/* the uncompressed length takes another int32 on the wire */
+	if (result + sizeof(int32) >= tupbodylen)
+	{
+		pfree(dst);
+		return NULL;
+	}
+
+	*compressedlen = result;
+	return dst;
+}
+
+/*
+ * Uncompress a received tuple body into 'tupbody', which has room for
+ * exactly 'tupbodylen' bytes.
+ */
+static void
+uncompressTupleBody(char *src, int srclen, char *tupbody, int tupbodylen)
+{
+	static ZSTD_DCtx *cxt = NULL;	/* ZSTD decompression context */
+	size_t		result;
+
+	if (!cxt)
+	{
+		cxt = ZSTD_createDCtx();
+		if (!cxt)
+			elog(ERROR, "out of memory");
+	}
+
+	result = ZSTD_decompressDCtx(cxt, tupbody, tupbodylen, src, srclen);
+	if (ZSTD_isError(result))
+		ereport(ERROR,
+				(errcode(ERRCODE_PROTOCOL_VIOLATION),
+				 errmsg("could not uncompress tuple: %s", ZSTD_getErrorName(result))));
+	if (result != tupbodylen)
+		ereport(ERROR,
+				(errcode(ERRCODE_PROTOCOL_VIOLATION),
+				 errmsg("uncompressed tuple length %zu does not match %d",
+						result, tupbodylen)));
+}
+#endif							/* USE_ZSTD */
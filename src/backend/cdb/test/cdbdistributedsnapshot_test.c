@@ -10,6 +10,19 @@
 
 #define SIZE_OF_IN_PROGRESS_ARRAY (10 * sizeof(DistributedTransactionId))
 
+/*
+ * The clog is consulted by the code under test, but the rest of transam.c
+ * is needed for real, so only this function is swapped in by the linker.
+ */
+bool __wrap_TransactionIdDidCommit(TransactionId transactionId);
+
+bool
+__wrap_TransactionIdDidCommit(TransactionId transactionId)
+{
+	check_expected(transactionId);
+	return (bool) mock();
+}
+
 static void
 test__DistributedSnapshotWithLocalMapping_CommittedTest(void **state)
 {
@@ -112,15 +125,18 @@ test__DistributedSnapshotWithLocalMapping_CommittedTest(void **state)
 	assert_true(dslm.inProgressMappedLocalXids[0] == 10);
 	assert_true(dslm.inProgressMappedLocalXids[1] == 20);
 
-	/* Now lets simulate we got tuple with xid=5 */
+	/*
+	 * Now lets simulate we got tuple with xid=5, it goes in front of the
+	 * sorted cache.
+	 */
 	retval = DistributedSnapshotWithLocalMapping_CommittedTest(&dslm, 5, false);
 	assert_true(retval == DISTRIBUTEDSNAPSHOT_COMMITTED_INPROGRESS);
 	assert_true(dslm.currentLocalXidsCount == 3);
 	assert_true(dslm.minCachedLocalXid == 5);
 	assert_true(dslm.maxCachedLocalXid == 20);
-	assert_true(dslm.inProgressMappedLocalXids[0] == 10);
-	assert_true(dslm.inProgressMappedLocalXids[1] == 20);
-	assert_true(dslm.inProgressMappedLocalXids[2] == 5);
+	assert_true(dslm.inProgressMappedLocalXids[0] == 5);
+	assert_true(dslm.inProgressMappedLocalXids[1] == 10);
+	assert_true(dslm.inProgressMappedLocalXids[2] == 20);
 
 	/*
 	 * Lets revalidate that local cache is working and
@@ -132,9 +148,9 @@ test__DistributedSnapshotWithLocalMapping_CommittedTest(void **state)
 	assert_true(dslm.currentLocalXidsCount == 3);
 	assert_true(dslm.minCachedLocalXid == 5);
 	assert_true(dslm.maxCachedLocalXid == 20);
-	assert_true(dslm.inProgressMappedLocalXids[0] == 10);
-	assert_true(dslm.inProgressMappedLocalXids[1] == 20);
-	assert_true(dslm.inProgressMappedLocalXids[2] == 5);
+	assert_true(dslm.inProgressMappedLocalXids[0] == 5);
+	assert_true(dslm.inProgressMappedLocalXids[1] == 10);
+	assert_true(dslm.inProgressMappedLocalXids[2] == 20);
 
 	/*
 	 * Test where local cache should not be touched, if distributedXid is not
@@ -145,9 +161,72 @@ test__DistributedSnapshotWithLocalMapping_CommittedTest(void **state)
 	assert_true(dslm.currentLocalXidsCount == 3);
 	assert_true(dslm.minCachedLocalXid == 5);
 	assert_true(dslm.maxCachedLocalXid == 20);
-	assert_true(dslm.inProgressMappedLocalXids[0] == 10);
-	assert_true(dslm.inProgressMappedLocalXids[1] == 20);
-	assert_true(dslm.inProgressMappedLocalXids[2] == 5);
+	assert_true(dslm.inProgressMappedLocalXids[0] == 5);
+	assert_true(dslm.inProgressMappedLocalXids[1] == 10);
+	assert_true(dslm.inProgressMappedLocalXids[2] == 20);
+
+	free(ds->inProgressXidArray);
+	free(dslm.inProgressMappedLocalXids);
+}
+
+/*
+ * A committed transaction that the distributedlog doesn't know of, not even
+ * when asked again after the clog said committed, is local-only.  It is
+ * cached as such, and later checks for it are answered from the cache.
+ */
+static void
+test__DistributedSnapshotWithLocalMapping_CommittedTest_LocalOnly(void **state)
+{
+	DistributedSnapshotCommitted retval;
+	DistributedSnapshotWithLocalMapping dslm;
+	DistributedSnapshot *ds = &dslm.ds;
+	DistributedTransactionId distribXid = 10 * 30;
+
+	/* Static initializations */
+	{
+		dslm.minCachedLocalXid = InvalidTransactionId;
+		dslm.maxCachedLocalXid = InvalidTransactionId;
+		dslm.currentLocalXidsCount = 0;
+
+		dslm.inProgressMappedLocalXids =
+			(TransactionId*)malloc(5 * sizeof(TransactionId));
+
+		ds->inProgressXidArray =
+			(DistributedTransactionId*)malloc(SIZE_OF_IN_PROGRESS_ARRAY);
+		ds->distribSnapshotId = 12346;
+
+		ds->xminAllDistributedSnapshots = 3;
+		ds->xmin = 3;
+		ds->xmax = 400;
+		ds->count = 1;
+		ds->inProgressXidArray[0] = 10 * 30;
+	}
+
+	/*
+	 * No distributedlog entry, neither before nor after the clog check.
+	 */
+	expect_value_count(DistributedLog_CommittedCheck, localXid, 30, 2);
+	expect_any_count(DistributedLog_CommittedCheck, distribXid, 2);
+	will_return_count(DistributedLog_CommittedCheck, false, 2);
+
+	expect_value(__wrap_TransactionIdDidCommit, transactionId, 30);
+	will_return(__wrap_TransactionIdDidCommit, true);
+
+	retval = DistributedSnapshotWithLocalMapping_CommittedTest(&dslm, 30, false);
+	assert_true(retval == DISTRIBUTEDSNAPSHOT_COMMITTED_IGNORE);
+	assert_true(dslm.currentLocalXidsCount == 0);
+
+	/* The cache entry carries no distributed xid. */
+	assert_true(LocalDistribXactCache_CommittedFind(30, &distribXid));
+	assert_true(distribXid == InvalidDistributedTransactionId);
+
+	/*
+	 * The next check is answered from the cache; a call to either mocked
+	 * function would fail the test, as no more calls are expected.
+	 */
+	retval = DistributedSnapshotWithLocalMapping_CommittedTest(&dslm, 30, false);
+	assert_true(retval == DISTRIBUTEDSNAPSHOT_COMMITTED_IGNORE);
+	assert_true(dslm.currentLocalXidsCount == 0);
 
 	free(ds->inProgressXidArray);
 	free(dslm.inProgressMappedLocalXids);
@@ -160,7 +239,8 @@ main(int argc, char* argv[])
 
 	const UnitTest tests[] =
 	{
-		unit_test(test__DistributedSnapshotWithLocalMapping_CommittedTest)
+		unit_test(test__DistributedSnapshotWithLocalMapping_CommittedTest),
+		unit_test(test__DistributedSnapshotWithLocalMapping_CommittedTest_LocalOnly)
 	};
 
 	MemoryContextInit();
@@ -227,6 +227,8 @@ ExplainQuery(ParseState *pstate, ExplainStmt *stmt, const char *queryString,
 			es->dxl = defGetBoolean(opt);
 		else if (strcmp(opt->defname, "slicetable") == 0)
 			es->slicetable = defGetBoolean(opt);
+		else if (strcmp(opt->defname, "dispatch") == 0)
+			es->dispatch = defGetBoolean(opt);
 		else
 			ereport(ERROR,
 					(errcode(ERRCODE_SYNTAX_ERROR),
@@ -240,6 +242,11 @@ ExplainQuery(ParseState *pstate, ExplainStmt *stmt, const char *queryString,
 				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
 				 errmsg("EXPLAIN option BUFFERS requires ANALYZE")));
 
+	if (es->dispatch && !es->analyze)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("EXPLAIN option DISPATCH requires ANALYZE")));
+
 	/* if the timing was not set explicitly, set default value */
 	es->timing = (timing_set) ? es->timing : es->analyze;
 
@@ -678,6 +685,10 @@ ExplainOnePlan(PlannedStmt *plannedstmt, IntoClause *into, ExplainState *es,
 	if (es->slicetable)
 		ExplainPrintSliceTable(es, queryDesc);
 
+	/* Print what the plan dispatch sent, and how long it took */
+	if (es->dispatch)
+		ExplainPrintDispatchStats(es, queryDesc);
+
 	/* Print info about runtime of triggers */
 	if (es->analyze)
 		ExplainPrintTriggers(es, queryDesc);
@@ -960,6 +971,60 @@ ExplainPrintSliceTable(ExplainState *es, QueryDesc *queryDesc)
 	ExplainCloseGroup("Slice Table", "Slice Table", false, es);
 }
 
+/*
+ * ExplainPrintDispatchStats -
+ *	  append the statistics of the dispatch of the main plan to es->str
+ *
+ * Init plans are dispatched separately, they are not included.
+ */
+void
+ExplainPrintDispatchStats(ExplainState *es, QueryDesc *queryDesc)
+{
+	CdbDispatcherState *ds = queryDesc->estate->dispatcherState;
+	CdbDispatchStats stats;
+
+	if (ds)
+		stats = ds->stats;
+	else
+		MemSet(&stats, 0, sizeof(stats));
+
+	if (es->format == EXPLAIN_FORMAT_TEXT)
+	{
+		appendStringInfo(es->str,
+						 "Dispatch: %d gangs, %d QEs, %d plans of " INT64_FORMAT "kB, " INT64_FORMAT "kB sent\n",
+						 stats.numGangs,
+						 stats.numQEs,
+						 stats.numPlans,
+						 (stats.planBytes + 1023) / 1024,
+						 (stats.bytesSent + 1023) / 1024);
+		if (es->timing)
+			appendStringInfo(es->str,
+							 "Dispatch Time: gangs %.3f ms, build %.3f ms, send %.3f ms\n",
+							 INSTR_TIME_GET_MILLISEC(stats.gangTime),
+							 INSTR_TIME_GET_MILLISEC(stats.buildTime),
+							 INSTR_TIME_GET_MILLISEC(stats.sendTime));
+	}
+	else
+	{
+		ExplainOpenGroup("Dispatch", "Dispatch", true, es);
+		ExplainPropertyInteger("Gangs", NULL, stats.numGangs, es);
+		ExplainPropertyInteger("QEs", NULL, stats.numQEs, es);
+		ExplainPropertyInteger("Plans", NULL, stats.numPlans, es);
+		ExplainPropertyInteger("Plan Size", "kB", (stats.planBytes + 1023) / 1024, es);
+		ExplainPropertyInteger("Bytes Sent", "kB", (stats.bytesSent + 1023) / 1024, es);
+		if (es->timing)
+		{
+			ExplainPropertyFloat("Gang Time", "ms",
+								 INSTR_TIME_GET_MILLISEC(stats.gangTime), 3, es);
+			ExplainPropertyFloat("Build Time", "ms",
+								 INSTR_TIME_GET_MILLISEC(stats.buildTime), 3, es);
+			ExplainPropertyFloat("Send Time", "ms",
+								 INSTR_TIME_GET_MILLISEC(stats.sendTime), 3, es);
+		}
+		ExplainCloseGroup("Dispatch", "Dispatch", true, es);
+	}
+}
+
 /*
  * ExplainPrintTriggers -
  *	  convert a QueryDesc's trigger statistics to text and append it to
@@ -125,6 +125,7 @@
 #include "cdb/cdbappendonlyam.h"
 #include "cdb/cdbtm.h"
 #include "cdb/cdbvars.h"
+#include "commands/progress.h"
 #include "commands/vacuum.h"
 #include "pgstat.h"
 #include "postmaster/autovacuum.h"
@@ -199,6 +200,11 @@ ao_vacuum_rel_pre_cleanup(Relation onerel, int options, VacuumParams *params,
 					get_namespace_name(RelationGetNamespace(onerel)),
 					relname)));
 
+	pgstat_progress_start_command(PROGRESS_COMMAND_VACUUM,
+								  RelationGetRelid(onerel));
+	pgstat_progress_update_param(PROGRESS_VACUUM_PHASE,
+								 PROGRESS_VACUUM_PHASE_AO_PRE_CLEANUP);
+
 	AppendOnlyRecycleDeadSegments(onerel);
 
 	/*
@@ -206,6 +212,8 @@ ao_vacuum_rel_pre_cleanup(Relation onerel, int options, VacuumParams *params,
 	 * This releases space left behind by aborted inserts.
 	 */
 	AppendOnlyTruncateToEOF(onerel);
+
+	pgstat_progress_end_command();
 }
 
 
@@ -242,6 +250,11 @@ ao_vacuum_rel_post_cleanup(Relation onerel, int options, VacuumParams *params,
 	 */
 	Assert(RelationIsAoRows(onerel) || RelationIsAoCols(onerel));
 
+	pgstat_progress_start_command(PROGRESS_COMMAND_VACUUM,
+								  RelationGetRelid(onerel));
+	pgstat_progress_update_param(PROGRESS_VACUUM_PHASE,
+								 PROGRESS_VACUUM_PHASE_AO_POST_CLEANUP);
+
 	AppendOnlyRecycleDeadSegments(onerel);
 
 	vacuum_appendonly_indexes(onerel, options, bstrategy);
@@ -271,6 +284,8 @@ ao_vacuum_rel_post_cleanup(Relation onerel, int options, VacuumParams *params,
 						MultiXactCutoff,
 						false,
 						true /* isvacuum */);
+
+	pgstat_progress_end_command();
 }
 
 void
@@ -284,6 +299,7 @@ ao_vacuum_rel_compact(Relation onerel, int options, VacuumParams *params,
 	Snapshot	appendOnlyMetaDataSnapshot = RegisterSnapshot(GetCatalogSnapshot(InvalidOid));
 	char	   *relname;
 	int			elevel;
+	FileSegTotals *totals;
 
 	/*
 	 * This should run in a distributed transaction. But also allow utility
@@ -310,6 +326,32 @@ ao_vacuum_rel_compact(Relation onerel, int options, VacuumParams *params,
 					get_namespace_name(RelationGetNamespace(onerel)),
 					relname)));
 
+	/*
+	 * Report progress. The total is the size of all segfiles in BLCKSZ
+	 * pages; the compaction routines advance heap_blks_scanned and
+	 * num_dead_tuples as they go through the segfiles that need compaction.
+	 */
+	if (RelationIsAoRows(onerel))
+		totals = GetSegFilesTotals(onerel, appendOnlyMetaDataSnapshot);
+	else
+		totals = GetAOCSSSegFilesTotals(onerel, appendOnlyMetaDataSnapshot);
+
+	pgstat_progress_start_command(PROGRESS_COMMAND_VACUUM,
+								  RelationGetRelid(onerel));
+	{
+		const int	progress_index[] = {
+			PROGRESS_VACUUM_PHASE,
+			PROGRESS_VACUUM_TOTAL_HEAP_BLKS
+		};
+		const int64 progress_val[] = {
+			PROGRESS_VACUUM_PHASE_AO_COMPACT,
+			RelationGuessNumberOfBlocksFromSize(totals->totalbytes)
+		};
+
+		pgstat_progress_update_multi_param(2, progress_index, progress_val);
+	}
+	pfree(totals);
+
 	/*
 	 * Compact all the segfiles. Repeat as many times as required.
 	 *
@@ -361,6 +403,10 @@ ao_vacuum_rel_compact(Relation onerel, int options, VacuumParams *params,
 		CommandCounterIncrement();
 	}
 
+	SIMPLE_FAULT_INJECTOR("vacuum_ao_after_compact");
+
+	pgstat_progress_end_command();
+
 	UnregisterSnapshot(appendOnlyMetaDataSnapshot);
 }
 
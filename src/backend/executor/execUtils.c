@@ -89,6 +89,7 @@
 #include "nodes/makefuncs.h"
 #include "storage/ipc.h"
 #include "cdb/cdbllize.h"
+#include "cdb/cdbtargeteddispatch.h"
 #include "utils/guc.h"
 #include "utils/workfile_mgr.h"
 #include "utils/metrics_utils.h"
@@ -1233,7 +1234,7 @@ ExecPrefetchJoinQual(JoinState *node)
 
 
 static void
-FillSliceGangInfo(ExecSlice *slice, PlanSlice *ps)
+FillSliceGangInfo(ExecSlice *slice, PlanSlice *ps, ParamListInfo params)
 {
 	int numsegments = ps->numsegments;
 	DirectDispatchInfo *dd = &ps->directDispatch;
@@ -1254,6 +1255,11 @@ FillSliceGangInfo(ExecSlice *slice, PlanSlice *ps)
 			{
 				slice->segments = list_copy(dd->contentIds);
 			}
+			else if (dd->paramKeyValues != NIL &&
+					 GetContentIdsFromParams(dd, params, &slice->segments))
+			{
+				/* the parameter values tell which segments to use */
+			}
 			else
 			{
 				int i;
@@ -1359,7 +1365,7 @@ InitSliceTable(EState *estate, PlannedStmt *plannedstmt)
 		currExecSlice->rootIndex = rootIndex;
 		currExecSlice->gangType = currPlanSlice->gangType;
 
-		FillSliceGangInfo(currExecSlice, currPlanSlice);
+		FillSliceGangInfo(currExecSlice, currPlanSlice, estate->es_param_list_info);
 	}
 	table->numSlices = numSlices;
 
@@ -28,6 +28,7 @@
 #include "lib/binaryheap.h"
 #include "utils/tuplesort.h"
 #include "miscadmin.h"
+#include "utils/faultinjector.h"
 #include "utils/memutils.h"
 
 
@@ -256,6 +257,8 @@ execMotionSender(MotionState *node)
 			doSendTuple(motion, node, outerTupleSlot);
 			/* doSendTuple() may have set node->stopRequested as a side-effect */
 
+			SIMPLE_FAULT_INJECTOR("motion_sender_tuple_sent");
+
 			if (node->stopRequested)
 			{
 				elog(gp_workfile_caching_loglevel, "Motion calling Squelch on child node");
@@ -52,6 +52,13 @@
 
 #include "tcop/tcopprot.h" /* quickdie() */
 
+/*
+ * After a probe cycle that saw retries or failures, the next cycle starts
+ * after this fraction of gp_fts_probe_interval, so that a flapping or
+ * failing segment is looked at again sooner than a healthy cluster.
+ */
+#define FTS_UNHEALTHY_INTERVAL_DIVISOR 4
+
 bool am_ftsprobe = false;
 bool am_ftshandler = false;
 
@@ -271,6 +278,8 @@ static
 void FtsLoop()
 {
 	bool	updated_probe_state;
+	bool	unhealthy;
+	int		interval;
 	MemoryContext probeContext = NULL, oldContext = NULL;
 	time_t elapsed,	probe_start_time, timeout;
 	CdbComponentDatabases *cdbs = NULL;
@@ -315,6 +324,8 @@ void FtsLoop()
 
 		/* Reset this as we are performing the probe */
 		probe_requested = false;
+		updated_probe_state = false;
+		unhealthy = false;
 		skip_fts_probe = false;
 
 #ifdef FAULT_INJECTOR
@@ -342,7 +353,7 @@ void FtsLoop()
 			 */
 			oldContext = MemoryContextSwitchTo(probeContext);
 
-			updated_probe_state = FtsWalRepMessageSegments(cdbs);
+			updated_probe_state = FtsWalRepMessageSegments(cdbs, &unhealthy);
 
 			MemoryContextSwitchTo(oldContext);
 
@@ -377,10 +388,15 @@ void FtsLoop()
 		SpinLockRelease(&ftsProbeInfo->lock);
 
 
-		/* check if we need to sleep before starting next iteration */
+		/*
+		 * check if we need to sleep before starting next iteration, come back
+		 * sooner if the segments did not all answer right away.
+		 */
+		interval = gp_fts_probe_interval;
+		if (unhealthy || updated_probe_state)
+			interval = Max(interval / FTS_UNHEALTHY_INTERVAL_DIVISOR, 1);
 		elapsed = time(NULL) - probe_start_time;
-		timeout = elapsed >= gp_fts_probe_interval ? 0 : 
-							gp_fts_probe_interval - elapsed;
+		timeout = elapsed >= interval ? 0 : interval - elapsed;
 
 		/*
 		 * In above code we might update gp_segment_configuration and then wal
@@ -28,8 +28,10 @@
 #include "cdb/cdbvars.h"
 #include "postmaster/fts.h"
 #include "postmaster/ftsprobe.h"
+#include "port/pg_bitutils.h"
 #include "postmaster/postmaster.h"
 #include "utils/snapmgr.h"
+#include "utils/timestamp.h"
 
 
 static struct pollfd *PollFds;
@@ -141,6 +143,31 @@ allDone(fts_context *context)
 	return result;
 }
 
+/*
+ * Add the latency of a successful probe, from the start of its connection to
+ * its response, to the histogram in shared memory.
+ */
+static void
+ftsRecordProbeLatency(int64 latency_us)
+{
+	int64		latency_ms = latency_us / 1000;
+	int			bucket;
+
+	if (latency_ms < 1)
+		bucket = 0;
+	else
+		bucket = Min(pg_leftmost_one_pos64(latency_ms) + 1,
+					 FTS_LATENCY_HIST_BUCKETS - 1);
+
+	pg_atomic_fetch_add_u64(&ftsProbeInfo->latency_hist[bucket], 1);
+}
+
+static void
+ftsRecordProbeOutcome(FtsProbeOutcome outcome)
+{
+	pg_atomic_fetch_add_u64(&ftsProbeInfo->outcomes[outcome], 1);
+}
+
 /*
  * Establish async libpq connection to a segment
  */
@@ -195,6 +222,7 @@ ftsConnectStart(fts_segment_info *ftsInfo)
 	 * Start the timer.
 	 */
 	ftsInfo->startTime = (pg_time_t) time(NULL);
+	ftsInfo->probeStartTime = GetCurrentTimestamp();
 
 	return true;
 }
@@ -741,6 +769,15 @@ ftsReceive(fts_context *context)
 				 * subsequent step processes it and transitions to next state.
 				 */
 				probeRecordResponse(ftsInfo, result);
+				if (ftsInfo->state == FTS_PROBE_SEGMENT)
+				{
+					long		secs;
+					int			usecs;
+
+					TimestampDifference(ftsInfo->probeStartTime,
+										GetCurrentTimestamp(), &secs, &usecs);
+					ftsRecordProbeLatency((int64) secs * 1000000 + usecs);
+				}
 				ftsInfo->state = nextSuccessState(ftsInfo->state);
 				break;
 			default:
@@ -967,6 +1004,20 @@ processResponse(fts_context *context)
 		AssertImply(IsFtsMessageStateFailed(ftsInfo->state),
 					ftsInfo->retry_count == gp_fts_probe_retries);
 
+		/*
+		 * Count the outcome before acting on it, updating the configuration
+		 * may error out.
+		 */
+		if (ftsInfo->state == FTS_PROBE_SUCCESS)
+			ftsRecordProbeOutcome(ftsInfo->retry_count > 0 ?
+								  FTS_PROBE_OUTCOME_RETRIED :
+								  FTS_PROBE_OUTCOME_SUCCEEDED);
+		else if (ftsInfo->state == FTS_PROBE_FAILED)
+			ftsRecordProbeOutcome(FTS_PROBE_OUTCOME_FAILED);
+
+		if (ftsInfo->retry_count > 0 || IsFtsMessageStateFailed(ftsInfo->state))
+			context->unhealthy = true;
+
 		CdbComponentDatabaseInfo *primary = ftsInfo->primary_cdbinfo;
 
 		CdbComponentDatabaseInfo *mirror = ftsInfo->mirror_cdbinfo;
@@ -1187,6 +1238,7 @@ static void
 FtsWalRepInitProbeContext(CdbComponentDatabases *cdbs, fts_context *context)
 {
 	context->num_pairs = cdbs->total_segments;
+	context->unhealthy = false;
 	context->perSegInfos = (fts_segment_info *) palloc0(
 		context->num_pairs * sizeof(fts_segment_info));
 
@@ -1244,8 +1296,14 @@ InitPollFds(size_t size)
 	PollFds = (struct pollfd *) palloc0(size * sizeof(struct pollfd));
 }
 
+/*
+ * Send FTS messages to all the primaries that have a mirror, and act on the
+ * responses.  Returns true if the configuration was updated.  *unhealthy is
+ * set if any message had to be retried or failed, i.e. the cluster might be
+ * in trouble and worth probing again soon.
+ */
 bool
-FtsWalRepMessageSegments(CdbComponentDatabases *cdbs)
+FtsWalRepMessageSegments(CdbComponentDatabases *cdbs, bool *unhealthy)
 {
 	bool is_updated = false;
 	fts_context context;
@@ -1262,6 +1320,7 @@ FtsWalRepMessageSegments(CdbComponentDatabases *cdbs)
 		processRetry(&context);
 		is_updated |= processResponse(&context);
 	}
+	*unhealthy = context.unhealthy;
 	int i;
 	if (!FtsIsActive())
 	{
@@ -1307,6 +1307,80 @@ test_PrimaryUpMirrorDownNotInSync_to_PrimaryDown(void **state)
 	assert_true(context.perSegInfos[1].state == FTS_RESPONSE_PROCESSED);
 }
 
+/*
+ * 2 segments, one answered at the first attempt and one after a retry.  Both
+ * outcomes are counted and the cycle is reported as unhealthy.
+ */
+static void
+test_processResponse_counts_probe_outcomes(void **state)
+{
+	CdbComponentDatabases *cdbs = InitTestCdb(
+		2, true, GP_SEGMENT_CONFIGURATION_MODE_NOTINSYNC);
+	fts_context context;
+	FtsWalRepInitProbeContext(cdbs, &context);
+	init_fts_context(&context, FTS_PROBE_SUCCESS);
+
+	uint64 succeeded = pg_atomic_read_u64(
+		&ftsProbeInfo->outcomes[FTS_PROBE_OUTCOME_SUCCEEDED]);
+	uint64 retried = pg_atomic_read_u64(
+		&ftsProbeInfo->outcomes[FTS_PROBE_OUTCOME_RETRIED]);
+	uint64 failed = pg_atomic_read_u64(
+		&ftsProbeInfo->outcomes[FTS_PROBE_OUTCOME_FAILED]);
+
+	will_return_count(FtsIsActive, true, 2);
+
+	context.perSegInfos[0].result.isPrimaryAlive = true;
+	context.perSegInfos[0].result.isMirrorAlive = true;
+	context.perSegInfos[0].result.isSyncRepEnabled = true;
+	context.perSegInfos[1].result.isPrimaryAlive = true;
+	context.perSegInfos[1].result.isMirrorAlive = true;
+	context.perSegInfos[1].result.isSyncRepEnabled = true;
+	context.perSegInfos[1].retry_count = 1;
+
+	expect_value(PQfinish, conn, context.perSegInfos[0].conn);
+	will_be_called(PQfinish);
+	expect_value(PQfinish, conn, context.perSegInfos[1].conn);
+	will_be_called(PQfinish);
+
+	bool is_updated = processResponse(&context);
+
+	assert_false(is_updated);
+	assert_true(context.unhealthy);
+	assert_int_equal(pg_atomic_read_u64(
+		&ftsProbeInfo->outcomes[FTS_PROBE_OUTCOME_SUCCEEDED]), succeeded + 1);
+	assert_int_equal(pg_atomic_read_u64(
+		&ftsProbeInfo->outcomes[FTS_PROBE_OUTCOME_RETRIED]), retried + 1);
+	assert_int_equal(pg_atomic_read_u64(
+		&ftsProbeInfo->outcomes[FTS_PROBE_OUTCOME_FAILED]), failed);
+}
+
+static void
+test_ftsRecordProbeLatency_buckets(void **state)
+{
+	uint64 before[FTS_LATENCY_HIST_BUCKETS];
+	int i;
+
+	for (i = 0; i < FTS_LATENCY_HIST_BUCKETS; i++)
+		before[i] = pg_atomic_read_u64(&ftsProbeInfo->latency_hist[i]);
+
+	ftsRecordProbeLatency(500);			/* <1ms */
+	ftsRecordProbeLatency(1500);		/* 1ms */
+	ftsRecordProbeLatency(3000);		/* 2ms */
+	ftsRecordProbeLatency(700000);		/* 512ms */
+	ftsRecordProbeLatency(60000000);	/* >=1024ms */
+
+	assert_int_equal(pg_atomic_read_u64(&ftsProbeInfo->latency_hist[0]),
+					 before[0] + 1);
+	assert_int_equal(pg_atomic_read_u64(&ftsProbeInfo->latency_hist[1]),
+					 before[1] + 1);
+	assert_int_equal(pg_atomic_read_u64(&ftsProbeInfo->latency_hist[2]),
+					 before[2] + 1);
+	assert_int_equal(pg_atomic_read_u64(&ftsProbeInfo->latency_hist[10]),
+					 before[10] + 1);
+	assert_int_equal(pg_atomic_read_u64(&ftsProbeInfo->latency_hist[11]),
+					 before[11] + 1);
+}
+
 /*
  * 1 segment, probe times out.
  */
@@ -1393,6 +1467,8 @@ main(int argc, char* argv[])
 		unit_test(test_PrimaryUpMirrorDownNotInSync_to_PrimayUpMirrorUpNotInSync),
 		unit_test(test_PrimaryUpMirrorDownNotInSync_to_PrimayUpMirrorDownNotInSync),
 		unit_test(test_PrimaryUpMirrorDownNotInSync_to_PrimaryDown),
+		unit_test(test_processResponse_counts_probe_outcomes),
+		unit_test(test_ftsRecordProbeLatency_buckets),
 		unit_test(test_probeTimeout),
 		/*-----------------------------------------------------------------------*/
 		unit_test(test_FtsWalRepInitProbeContext_initial_state)
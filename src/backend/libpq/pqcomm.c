@@ -341,6 +341,27 @@ pq_comm_close_fatal(void)
 	}
 }                               /* pq_comm_close_fatal */
 
+/* --------------------------------
+ *		pq_setsendbuffersize - resize the send buffer
+ *
+ *		The buffer is only flushed to the socket when it is full, so a larger
+ *		one sends a large result set with fewer and bigger send() calls.  The
+ *		size never goes below the default, nor below the data still pending.
+ * --------------------------------
+ */
+void
+pq_setsendbuffersize(int size)
+{
+	size = Max(size, PQ_SEND_BUFFER_SIZE);
+
+	if (PqSendBuffer == NULL || size == PqSendBufferSize ||
+		size < PqSendPointer || PqCommBusy)
+		return;
+
+	PqSendBuffer = repalloc(PqSendBuffer, size);
+	PqSendBufferSize = size;
+}
+
 
 /*
  * Streams -- wrapper around Unix socket system calls
@@ -138,6 +138,10 @@ _copyPlannedStmt(const PlannedStmt *from)
 		COPY_SCALAR_FIELD(slices[i].segindex);
 		COPY_SCALAR_FIELD(slices[i].directDispatch.isDirectDispatch);
 		COPY_NODE_FIELD(slices[i].directDispatch.contentIds);
+		COPY_NODE_FIELD(slices[i].directDispatch.paramKeyValues);
+		COPY_NODE_FIELD(slices[i].directDispatch.paramKeyTypes);
+		COPY_NODE_FIELD(slices[i].directDispatch.paramKeyHashFuncs);
+		COPY_SCALAR_FIELD(slices[i].directDispatch.paramKeyNumSegments);
 	}
 
 	COPY_NODE_FIELD(intoPolicy);
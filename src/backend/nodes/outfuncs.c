@@ -380,6 +380,10 @@ _outPlannedStmt(StringInfo str, const PlannedStmt *node)
 		WRITE_INT_FIELD(slices[i].segindex);
 		WRITE_BOOL_FIELD(slices[i].directDispatch.isDirectDispatch);
 		WRITE_NODE_FIELD(slices[i].directDispatch.contentIds);
+		WRITE_NODE_FIELD(slices[i].directDispatch.paramKeyValues);
+		WRITE_NODE_FIELD(slices[i].directDispatch.paramKeyTypes);
+		WRITE_NODE_FIELD(slices[i].directDispatch.paramKeyHashFuncs);
+		WRITE_INT_FIELD(slices[i].directDispatch.paramKeyNumSegments);
 	}
 
 	WRITE_BITMAPSET_FIELD(rewindPlanIDs);
@@ -2451,6 +2451,10 @@ _readPlannedStmt(void)
 		READ_INT_FIELD(slices[i].segindex);
 		READ_BOOL_FIELD(slices[i].directDispatch.isDirectDispatch);
 		READ_NODE_FIELD(slices[i].directDispatch.contentIds);
+		READ_NODE_FIELD(slices[i].directDispatch.paramKeyValues);
+		READ_NODE_FIELD(slices[i].directDispatch.paramKeyTypes);
+		READ_NODE_FIELD(slices[i].directDispatch.paramKeyHashFuncs);
+		READ_INT_FIELD(slices[i].directDispatch.paramKeyNumSegments);
 	}
 
 	READ_BITMAPSET_FIELD(rewindPlanIDs);
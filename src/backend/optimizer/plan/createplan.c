@@ -2112,6 +2112,7 @@ create_projection_plan(PlannerInfo *root, ProjectionPath *best_path, int flags)
 	{
 		DirectDispatchInfo dispatchInfo;
 
+		MemSet(&dispatchInfo, 0, sizeof(dispatchInfo));
 		dispatchInfo.isDirectDispatch = true;
 		dispatchInfo.contentIds = best_path->direct_dispath_contentIds;
 		dispatchInfo.haveProcessedAnyCalculations = true;
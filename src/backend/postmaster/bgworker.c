@@ -930,7 +930,7 @@ RegisterBackgroundWorker(BackgroundWorker *worker)
 	 * towards the MAX_BACKENDS limit elsewhere.  For now, it doesn't seem
 	 * important to relax this restriction.
 	 */
-	if (!auxworker && ++numworkers > max_worker_processes - MaxPMAuxProc)
+	if (!auxworker && ++numworkers > max_worker_processes - NumPMAuxProc())
 	{
 		ereport(LOG,
 				(errcode(ERRCODE_CONFIGURATION_LIMIT_EXCEEDED),
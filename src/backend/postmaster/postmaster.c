@@ -413,12 +413,38 @@ static BackgroundWorker PMAuxProcList[MaxPMAuxProc] =
 	 BackoffSweeperStartRule},
 
 #ifdef ENABLE_IC_PROXY
+	/*
+	 * One slot per possible ic-proxy worker, ICProxyStartRule() only starts
+	 * the first gp_interconnect_proxy_workers of them.  The bgw_main_arg is
+	 * the worker id.
+	 */
 	{"ic proxy process", "ic proxy process",
 	 0,
 	 BgWorkerStart_RecoveryFinished,
 	 0, /* restart immediately if ic proxy process exits with non-zero code */
 	 "postgres", "ICProxyMain", 0, {0}, 0,
 	 ICProxyStartRule},
+
+	{"ic proxy process 1", "ic proxy process",
+	 0,
+	 BgWorkerStart_RecoveryFinished,
+	 0, /* restart immediately if ic proxy process exits with non-zero code */
+	 "postgres", "ICProxyMain", 1, {0}, 0,
+	 ICProxyStartRule},
+
+	{"ic proxy process 2", "ic proxy process",
+	 0,
+	 BgWorkerStart_RecoveryFinished,
+	 0, /* restart immediately if ic proxy process exits with non-zero code */
+	 "postgres", "ICProxyMain", 2, {0}, 0,
+	 ICProxyStartRule},
+
+	{"ic proxy process 3", "ic proxy process",
+	 0,
+	 BgWorkerStart_RecoveryFinished,
+	 0, /* restart immediately if ic proxy process exits with non-zero code */
+	 "postgres", "ICProxyMain", 3, {0}, 0,
+	 ICProxyStartRule},
 #endif  /* ENABLE_IC_PROXY */
 
 	/*
@@ -1067,6 +1093,13 @@ PostmasterMain(int argc, char *argv[])
 					 ReservedBackends, MaxConnections);
 		ExitPostmaster(1);
 	}
+	if (max_worker_processes < NumPMAuxProc())
+	{
+		write_stderr("%s: max_worker_processes (%d) must be at least %d, to reserve %d for auxiliary processes like FTS\n",
+					 progname,
+					 max_worker_processes, NumPMAuxProc(), NumPMAuxProc());
+		ExitPostmaster(1);
+	}
 	if (XLogArchiveMode > ARCHIVE_MODE_OFF && wal_level == WAL_LEVEL_MINIMAL)
 		ereport(ERROR,
 				(errmsg("WAL archival cannot be enabled when wal_level is \"minimal\"")));
@@ -7179,6 +7212,19 @@ isAuxiliaryBgWorker(BackgroundWorker *worker)
 	return false;
 }
 
+/*
+ * Number of background worker slots reserved for auxiliary processes.
+ *
+ * That is every entry of PMAuxProcList, except the ic-proxy workers beyond
+ * gp_interconnect_proxy_workers, which never start.
+ */
+int
+NumPMAuxProc(void)
+{
+	return MaxPMAuxProc - IC_PROXY_NUM_BGWORKER +
+		(IC_PROXY_NUM_BGWORKER > 0 ? gp_interconnect_proxy_workers : 0);
+}
+
 bool
 amAuxiliaryBgWorker(void)
 {
@@ -114,6 +114,27 @@ static PGPROC *allProcs;
 static PGXACT *allPgXact;
 static TMGXACT *allTmGxact;
 
+/*
+ * The last distributed snapshot this backend built by walking the ProcArray,
+ * reused by CreateDistributedSnapshot() as long as no distributed transaction
+ * ended since.  xminAllDistributedSnapshots may then lag behind, which only
+ * keeps the segments from forgetting old distributed transactions a bit
+ * longer.
+ */
+typedef struct DistributedSnapshotCache
+{
+	bool		valid;
+	uint64		gxactCompletionCount;	/* ShmemVariableCache's, when built */
+	DistributedTransactionId myGxid;	/* MyTmGxact->gxid, when built */
+	DistributedTransactionId xminAllDistributedSnapshots;
+	DistributedTransactionId xmin;
+	DistributedTransactionId xmax;
+	int32		count;
+	DistributedTransactionId *inProgressXidArray;	/* malloc'd, maxProcs */
+} DistributedSnapshotCache;
+
+static DistributedSnapshotCache distribSnapshotCache;
+
 /*
  * Bookkeeping for tracking emulated transactions in recovery
  */
@@ -386,6 +407,9 @@ ProcArrayRemove(PGPROC *proc, TransactionId latestXid)
 		if (InvalidDistributedTransactionId != gxid &&
 			ShmemVariableCache->latestCompletedGxid < gxid)
 			ShmemVariableCache->latestCompletedGxid = gxid;
+
+		if (InvalidDistributedTransactionId != gxid)
+			ShmemVariableCache->gxactCompletionCount++;
 	}
 
 	for (index = 0; index < arrayP->numProcs; index++)
@@ -428,6 +452,9 @@ ProcArrayEndGxact(TMGXACT *tmGxact)
 	if (InvalidDistributedTransactionId != gxid &&
 		ShmemVariableCache->latestCompletedGxid < gxid)
 		ShmemVariableCache->latestCompletedGxid = gxid;
+
+	if (Gp_role == GP_ROLE_DISPATCH && InvalidDistributedTransactionId != gxid)
+		ShmemVariableCache->gxactCompletionCount++;
 }
 
 /*
@@ -1960,8 +1987,63 @@ DistributedSnapshotMappedEntry_Compare(const void *p1, const void *p2)
 		return -1;
 }
 
+/*
+ * Fill in the distributed snapshot from the cached one, if no distributed
+ * transaction ended since the cached one was built.  A snapshot that sees the
+ * same ended transactions is as good as a new one: the transactions that
+ * started since have gxids >= its xmax, so they are in progress to it.
+ */
+static bool
+DistributedSnapshotFromCache(DistributedSnapshot *ds)
+{
+	DistributedSnapshotCache *cache = &distribSnapshotCache;
+
+	if (!cache->valid ||
+		cache->gxactCompletionCount != ShmemVariableCache->gxactCompletionCount ||
+		cache->myGxid != MyTmGxact->gxid)
+		return false;
+
+	ds->xminAllDistributedSnapshots = cache->xminAllDistributedSnapshots;
+	ds->xmin = cache->xmin;
+	ds->xmax = cache->xmax;
+	ds->count = cache->count;
+	memcpy(ds->inProgressXidArray, cache->inProgressXidArray,
+		   cache->count * sizeof(DistributedTransactionId));
+
+	return true;
+}
+
+static void
+DistributedSnapshotToCache(DistributedSnapshot *ds)
+{
+	DistributedSnapshotCache *cache = &distribSnapshotCache;
+
+	if (cache->inProgressXidArray == NULL)
+	{
+		/* we hold ProcArrayLock, rather go without the cache than error out */
+		cache->inProgressXidArray = (DistributedTransactionId *)
+			malloc(GetMaxSnapshotXidCount() * sizeof(DistributedTransactionId));
+		if (cache->inProgressXidArray == NULL)
+			return;
+	}
+
+	cache->gxactCompletionCount = ShmemVariableCache->gxactCompletionCount;
+	cache->myGxid = MyTmGxact->gxid;
+	cache->xminAllDistributedSnapshots = ds->xminAllDistributedSnapshots;
+	cache->xmin = ds->xmin;
+	cache->xmax = ds->xmax;
+	cache->count = ds->count;
+	memcpy(cache->inProgressXidArray, ds->inProgressXidArray,
+		   ds->count * sizeof(DistributedTransactionId));
+	cache->valid = true;
+}
+
 /*
  * create distributed snapshot based on current visible distributed transaction
+ *
+ * Walking the whole ProcArray is the expensive part with many connections, so
+ * the last snapshot is reused when nothing it depends on changed, see
+ * DistributedSnapshotFromCache().
  */
 static bool
 CreateDistributedSnapshot(DistributedSnapshot *ds)
@@ -1972,6 +2054,7 @@ CreateDistributedSnapshot(DistributedSnapshot *ds)
 	DistributedTransactionId xmax;
 	DistributedSnapshotId distribSnapshotId;
 	DistributedTransactionId globalXminDistributedSnapshots;
+	DistributedTransactionId nextGxid;
 	ProcArrayStruct *arrayP = procArray;
 
 	Assert(LWLockHeldByMe(ProcArrayLock));
@@ -1989,6 +2072,33 @@ CreateDistributedSnapshot(DistributedSnapshot *ds)
 
 	Assert(ds->inProgressXidArray != NULL);
 
+	if (DistributedSnapshotFromCache(ds))
+	{
+		distribSnapshotId = pg_atomic_add_fetch_u32((pg_atomic_uint32 *)shmNextSnapshotId, 1);
+		ds->distribSnapshotId = distribSnapshotId;
+
+		if (MyTmGxact->xminDistributedSnapshot == InvalidDistributedTransactionId)
+			MyTmGxact->xminDistributedSnapshot = ds->xmin;
+
+		elog((Debug_print_snapshot_dtm ? LOG : DEBUG5),
+			 "[Distributed Snapshot #%u] *Reuse* (gxid = "UINT64_FORMAT"', count = %u)",
+			 distribSnapshotId,
+			 MyTmGxact->gxid,
+			 ds->count);
+
+		return true;
+	}
+
+	/*
+	 * Gxids are assigned without ProcArrayLock, so the walk below may see a
+	 * gxid assigned after it started but miss a lower one assigned a bit
+	 * earlier.  Remember where assignment stood to tell whether that could
+	 * have happened.
+	 */
+	SpinLockAcquire(shmGxidGenLock);
+	nextGxid = ShmemVariableCache->nextGxid;
+	SpinLockRelease(shmGxidGenLock);
+
 	/*
 	 * Gather up current in-progress global transactions for the distributed
 	 * snapshot.
@@ -2056,6 +2166,14 @@ CreateDistributedSnapshot(DistributedSnapshot *ds)
 	if (MyTmGxact->xminDistributedSnapshot == InvalidDistributedTransactionId)
 		MyTmGxact->xminDistributedSnapshot = xmin;
 
+	/*
+	 * Only cache the snapshot if no gxid assigned during the walk can be
+	 * below its xmax.  Any gxid the walk missed is then >= xmax, i.e. in
+	 * progress to the snapshot for as long as it is reused.
+	 */
+	if (xmax <= nextGxid)
+		DistributedSnapshotToCache(ds);
+
 	elog((Debug_print_full_dtm ? LOG : DEBUG5),
 		 "CreateDistributedSnapshot distributed snapshot has xmin = "UINT64_FORMAT", count = %u, xmax = "UINT64_FORMAT".",
 		 xmin, count, xmax);
@@ -11,6 +11,7 @@
 VariableCacheData vcdata;
 uint32 nextSnapshotId;
 int num_committed_xacts;
+slock_t gxid_gen_lock;
 
 static void
 setup(void)
@@ -18,6 +19,9 @@ setup(void)
 	ShmemVariableCache = &vcdata;
 	shmNextSnapshotId = &nextSnapshotId;
 	shmNumCommittedGxacts = &num_committed_xacts;
+	SpinLockInit(&gxid_gen_lock);
+	shmGxidGenLock = &gxid_gen_lock;
+	distribSnapshotCache.valid = false;
 
 	/* Some imaginary LWLockId number */
 	*shmNumCommittedGxacts = 0;
@@ -136,6 +140,104 @@ test__CreateDistributedSnapshot(void **state)
 	free(procArray);
 }
 
+static void
+test__CreateDistributedSnapshot_reuse(void **state)
+{
+	DistributedSnapshot ds;
+	DistributedSnapshotId firstSnapshotId;
+	GpRoleValue saved_role = Gp_role;
+
+	ds.inProgressXidArray =
+		(DistributedTransactionId*)malloc(SIZE_OF_IN_PROGRESS_ARRAY);
+
+	setup();
+	Gp_role = GP_ROLE_DISPATCH;
+
+#ifdef USE_ASSERT_CHECKING
+	expect_value_count(LWLockHeldByMe, l, ProcArrayLock, -1);
+	will_return_count(LWLockHeldByMe, true, -1);
+#endif
+
+	ShmemVariableCache->latestCompletedGxid = 24;
+	ShmemVariableCache->nextGxid = 31;
+	ShmemVariableCache->gxactCompletionCount = 0;
+
+	allTmGxact[procArray->pgprocnos[0]].gxid = 20;
+	allTmGxact[procArray->pgprocnos[0]].xminDistributedSnapshot = InvalidDistributedTransactionId;
+	allTmGxact[procArray->pgprocnos[1]].gxid = 10;
+	allTmGxact[procArray->pgprocnos[1]].xminDistributedSnapshot = 5;
+	allTmGxact[procArray->pgprocnos[2]].gxid = 30;
+	allTmGxact[procArray->pgprocnos[2]].xminDistributedSnapshot = 20;
+
+	procArray->numProcs = 3;
+
+	MyTmGxact = &allTmGxact[procArray->pgprocnos[0]];
+
+	CreateDistributedSnapshot(&ds);
+
+	assert_true(distribSnapshotCache.valid);
+	assert_true(ds.xminAllDistributedSnapshots == 5);
+	assert_true(ds.xmin == 10);
+	assert_true(ds.xmax == 30);
+	assert_true(ds.count == 2);
+	firstSnapshotId = ds.distribSnapshotId;
+
+	/*************************************************************************
+	 * A transaction that starts, or a snapshot that is taken, does not change
+	 * what is in progress to the snapshot, so the same one is returned again,
+	 * under a new id.
+	 */
+	allTmGxact[procArray->pgprocnos[1]].xminDistributedSnapshot = 10;
+	allTmGxact[procArray->pgprocnos[3]].gxid = 31;
+	allTmGxact[procArray->pgprocnos[3]].xminDistributedSnapshot = InvalidDistributedTransactionId;
+	ShmemVariableCache->nextGxid = 32;
+
+	procArray->numProcs = 4;
+
+	memset(ds.inProgressXidArray, 0, SIZE_OF_IN_PROGRESS_ARRAY);
+	CreateDistributedSnapshot(&ds);
+
+	assert_true(ds.distribSnapshotId == firstSnapshotId + 1);
+	assert_true(ds.xminAllDistributedSnapshots == 5);
+	assert_true(ds.xmin == 10);
+	assert_true(ds.xmax == 30);
+	assert_true(ds.count == 2);
+	assert_true(ds.inProgressXidArray[0] == 10);
+	assert_true(ds.inProgressXidArray[1] == 30);
+
+	/*************************************************************************
+	 * Once a transaction ends, the snapshot is built again.
+	 */
+	ProcArrayEndGxact(&allTmGxact[procArray->pgprocnos[1]]);
+
+	memset(ds.inProgressXidArray, 0, SIZE_OF_IN_PROGRESS_ARRAY);
+	CreateDistributedSnapshot(&ds);
+
+	assert_true(ds.xminAllDistributedSnapshots == 10);
+	assert_true(ds.xmin == 20);
+	assert_true(ds.xmax == 31);
+	assert_true(ds.count == 2);
+	assert_true(ds.inProgressXidArray[0] == 30);
+	assert_true(ds.inProgressXidArray[1] == 31);
+
+	/*************************************************************************
+	 * A snapshot that saw a gxid assigned during the walk is not reused, it
+	 * may have missed a lower one.
+	 */
+	distribSnapshotCache.valid = false;
+	ShmemVariableCache->nextGxid = 30;
+
+	CreateDistributedSnapshot(&ds);
+
+	assert_true(ds.xmax == 31);
+	assert_false(distribSnapshotCache.valid);
+
+	Gp_role = saved_role;
+	free(ds.inProgressXidArray);
+	free(allTmGxact);
+	free(procArray);
+}
+
 int
 main(int argc, char* argv[])
 {
@@ -143,7 +245,8 @@ main(int argc, char* argv[])
 
 	const UnitTest tests[] =
 	{
-		unit_test(test__CreateDistributedSnapshot)
+		unit_test(test__CreateDistributedSnapshot),
+		unit_test(test__CreateDistributedSnapshot_reuse)
 	};
 
 	MemoryContextInit();
@@ -266,8 +266,14 @@ ReadyForQuery(CommandDest dest)
 					pq_sendint64(&buf, VmemTracker_GetMaxReservedVmemBytes());
 					pq_endmessage(&buf);
 
+					/*
+					 * Whether the QE wrote xlog, and whether it has a
+					 * transaction of its own, i.e. whether it may have
+					 * changed anything, logged or not.
+					 */
 					pq_beginmessage(&buf, 'x');
 					pq_sendbyte(&buf, TransactionDidWriteXLog());
+					pq_sendbyte(&buf, TransactionIdIsValid(GetTopTransactionIdIfAny()));
 					pq_endmessage(&buf);
 				}
 
@@ -95,6 +95,7 @@
 #include "cdb/cdbdisp_query.h"
 #include "cdb/cdbdispatchresult.h"
 #include "cdb/cdbgang.h"
+#include "cdb/cdbmotion.h"
 #include "cdb/ml_ipc.h"
 #include "utils/guc.h"
 #include "access/twophase.h"
@@ -3991,6 +3992,9 @@ ProcessInterrupts(const char* filename, int lineno)
 
 	if (ParallelMessagePending)
 		HandleParallelMessages();
+
+	if (MotionFlushPending)
+		HandleMotionFlushInterrupt();
 }
 
 /*
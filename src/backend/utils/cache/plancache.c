@@ -1225,6 +1225,20 @@ cached_plan_cost(CachedPlan *plan, bool include_planner)
 				/* How many segments are involved in this slice? */
 				if (slice->directDispatch.isDirectDispatch)
 					nsegments = list_length(slice->directDispatch.contentIds);
+				else if (slice->directDispatch.paramKeyValues != NIL)
+				{
+					ListCell   *lc;
+
+					/*
+					 * The segments depend on the parameters; guess one per
+					 * combination of the key values, counting an array as
+					 * one value.
+					 */
+					nsegments = 1;
+					foreach(lc, slice->directDispatch.paramKeyValues)
+						nsegments = Min(nsegments * list_length((List *) lfirst(lc)),
+										slice->numsegments);
+				}
 				else
 					nsegments = slice->numsegments;
 				maxsegments = Max(maxsegments, nsegments);
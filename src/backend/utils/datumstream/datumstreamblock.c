@@ -945,6 +945,112 @@ DatumStreamBlockRead_GetReadyDense(
 	dsr->datump = dsr->datum_beginp;
 }
 
+/*
+ * Fetch a fixed-length pass-by-value item.
+ */
+static inline Datum
+DatumStreamBlockRead_FetchByVal(uint8 * p, int32 datumlen)
+{
+	switch (datumlen)
+	{
+		case 1:
+			return *(uint8 *) p;
+		case 2:
+			Assert(IsAligned(p, 2));
+			return *(uint16 *) p;
+		case 4:
+			Assert(IsAligned(p, 4));
+			return *(uint32 *) p;
+		case 8:
+			Assert(IsAligned(p, 8) || IsAligned(p, 4));
+			return *(Datum *) p;
+		default:
+			Assert(false);
+			return 0;
+	}
+}
+
+/*
+ * Advance over and get up to maxCount items of the current block in one
+ * call, filling the values and nulls arrays.
+ *
+ * Returns the number of items fetched, or 0 when the block is exhausted (in
+ * which case the reader is left exactly as DatumStreamBlockRead_Advance
+ * would have left it).  Afterwards the reader is positioned on the last item
+ * returned, so DatumStreamBlockRead_Nth() gives its position.
+ *
+ * Blocks of a fixed-length pass-by-value type without RLE_TYPE or delta
+ * compression are decoded straight from the data area; everything else goes
+ * through the regular Advance/Get pair item by item.  Pointers returned for
+ * by-reference types point into the block buffer and stay valid until the
+ * next block is read.
+ */
+int
+DatumStreamBlockRead_GetBatch(DatumStreamBlockRead * dsr,
+							  Datum *values,
+							  bool *nulls,
+							  int maxCount)
+{
+	int			remaining;
+	int			count;
+
+	remaining = dsr->logical_row_count - (dsr->nth + 1);
+	if (remaining <= 0)
+		return DatumStreamBlockRead_Advance(dsr);
+	if (maxCount > remaining)
+		maxCount = remaining;
+
+	if (dsr->typeInfo.byval && dsr->typeInfo.datumlen > 0 &&
+		(dsr->datumStreamVersion == DatumStreamVersion_Original ||
+		 (!dsr->rle_block_was_compressed && !dsr->delta_block_was_compressed)))
+	{
+		int32		datumlen = dsr->typeInfo.datumlen;
+		int32		physical_datum_index = dsr->physical_datum_index;
+		uint8	   *p = dsr->datump;
+
+		for (count = 0; count < maxCount; count++)
+		{
+			if (dsr->has_null)
+			{
+				DatumStreamBitMapRead_Next(&dsr->null_bitmap);
+				Assert(DatumStreamBitMapRead_InRange(&dsr->null_bitmap));
+
+				if (DatumStreamBitMapRead_CurrentIsOn(&dsr->null_bitmap))
+				{
+					values[count] = (Datum) 0;
+					nulls[count] = true;
+					continue;
+				}
+			}
+
+			/* The block read pre-positions us on the first item. */
+			if (++physical_datum_index > 0)
+				p += datumlen;
+			Assert(p >= dsr->datum_beginp && p < dsr->datum_afterp);
+
+			values[count] = DatumStreamBlockRead_FetchByVal(p, datumlen);
+			nulls[count] = false;
+		}
+
+		dsr->nth += count;
+		dsr->physical_datum_index = physical_datum_index;
+		dsr->datump = p;
+	}
+	else
+	{
+		for (count = 0; count < maxCount; count++)
+		{
+			int			advanced PG_USED_FOR_ASSERTS_ONLY;
+
+			advanced = DatumStreamBlockRead_Advance(dsr);
+			Assert(advanced == 1);
+			DatumStreamBlockRead_Get(dsr, &values[count], &nulls[count]);
+		}
+	}
+
+	return count;
+}
+
 static int
 errdetail_datumstreamblockwrite(
 								DatumStreamBlockWrite * dsw)
@@ -27,6 +27,7 @@
 #include "access/xact.h"
 #include "cdb/cdbvars.h"
 #include "executor/spi.h"
+#include "portability/instr_time.h"
 #include "postmaster/postmaster.h"
 #include "tcop/tcopprot.h"
 #include "utils/gdd.h"
@@ -187,12 +188,43 @@ doDeadLockCheck(void)
 
 	PG_TRY();
 	{
+		instr_time	start;
+		instr_time	collected;
+		instr_time	reduced;
+		int			nedges;
+		int			ngraphs;
+		double		collect_ms;
+		double		reduce_ms;
+
+		INSTR_TIME_SET_CURRENT(start);
+
 		ctx = GddCtxNew();
 
 		buildWaitGraph(ctx);
 
+		INSTR_TIME_SET_CURRENT(collected);
+		nedges = ctx->topstat.outdeg;
+		ngraphs = ctx->graphs.length;
+
 		GddCtxReduce(ctx);
 
+		INSTR_TIME_SET_CURRENT(reduced);
+
+		/*
+		 * Report how long the round took, a round that does not fit in the
+		 * period delays the resolution of deadlocks, so it is always logged.
+		 */
+		collect_ms = INSTR_TIME_GET_MILLISEC(collected) -
+			INSTR_TIME_GET_MILLISEC(start);
+		reduce_ms = INSTR_TIME_GET_MILLISEC(reduced) -
+			INSTR_TIME_GET_MILLISEC(collected);
+
+		elog((collect_ms + reduce_ms) / 1000.0 > gp_global_deadlock_detector_period ?
+			 LOG : DEBUG1,
+			 "global deadlock detector collected %d wait edges on %d segments in %.3f ms, "
+			 "reduced them in %.3f ms",
+			 nedges, ngraphs, collect_ms, reduce_ms);
+
 		if (!GddCtxEmpty(ctx))
 		{
 			StringInfoData wait_graph_str;
@@ -233,6 +265,9 @@ buildWaitGraph(GddCtx *ctx)
 	SPITupleTable *tuptable;
 	TupleDesc	tupdesc;
 	List		*gxids;
+	TransactionId *gxidArray;
+	int			ngxids;
+	ListCell	*cell;
 	bool		isnull;
 	int			tuple_num;
 	int			i;
@@ -272,9 +307,19 @@ buildWaitGraph(GddCtx *ctx)
 			 */
 			MemoryContextSwitchTo(gddContext);
 
-			/* Get all valid gxids, any other gxids are considered invalid. */
+			/*
+			 * Get all valid gxids, any other gxids are considered invalid.
+			 * They are sorted into an array, as there is a lookup for every
+			 * edge and there can be thousands of both.
+			 */
 			gxids = ListAllGxid();
 
+			gxidArray = palloc(Max(list_length(gxids), 1) * sizeof(TransactionId));
+			ngxids = 0;
+			foreach(cell, gxids)
+				gxidArray[ngxids++] = (TransactionId) lfirst_int(cell);
+			qsort(gxidArray, ngxids, sizeof(TransactionId), xidComparator);
+
 			for (i = 0; i < tuple_num; i++)
 			{
 				TransactionId  waiter_xid;
@@ -335,8 +380,10 @@ buildWaitGraph(GddCtx *ctx)
 				holder_data->sessionid = DatumGetInt32(d);
 
 				/* Skip edges with invalid gxids */
-				if (!list_member_int(gxids, waiter_xid) ||
-					!list_member_int(gxids, holder_xid))
+				if (!bsearch(&waiter_xid, gxidArray, ngxids,
+							 sizeof(TransactionId), xidComparator) ||
+					!bsearch(&holder_xid, gxidArray, ngxids,
+							 sizeof(TransactionId), xidComparator))
 					continue;
 
 				edge = GddCtxAddEdge(ctx, segid, waiter_xid, holder_xid, solidedge);
@@ -13,16 +13,43 @@
 #include "postgres.h"
 
 #include "storage/procarray.h"
+#include "utils/hashutils.h"
 
 #include "gdddetector.h"
 #include "gdddetectorpriv.h"
 
+/*
+ * Maps with more pairs than this are indexed with a hash table.
+ */
+#define GDD_MAP_INDEX_THRESHOLD 8
+
+typedef struct GddMapIndexEntry
+{
+	int			key;
+	int			pos;			/* position of the pair in map->pairs */
+	char		status;			/* hash status */
+} GddMapIndexEntry;
+
+#define SH_PREFIX		gddmap
+#define SH_ELEMENT_TYPE	GddMapIndexEntry
+#define SH_KEY_TYPE		int
+#define SH_KEY			key
+#define SH_HASH_KEY(tb, key)	murmurhash32((uint32) (key))
+#define SH_EQUAL(tb, a, b)		((a) == (b))
+#define SH_SCOPE		static inline
+#define SH_DECLARE
+#define SH_DEFINE
+#include "lib/simplehash.h"
+
 /***************************************************************************/
 
 static GddGraph *gddCtxGetGraph(GddCtx *ctx, int segid);
 static GddStat *gddCtxGetGlobalStat(GddCtx *ctx, int vid);
 static void gddCtxRemoveVid(GddCtx *ctx, int vid);
 static int gddCtxGetMaxVid(GddCtx *ctx);
+static void gddCtxEnqueue(GddCtx *ctx, GddVert *vert);
+static void gddCtxEnqueueUnlinked(GddCtx *ctx, GddEdge *edge);
+static void gddCtxReducePending(GddCtx *ctx);
 
 static GddStat *gddStatNew(int vid);
 static void gddStatInit(GddStat *stat, int vid);
@@ -30,12 +57,11 @@ static void gddStatInit(GddStat *stat, int vid);
 static GddGraph *gddGraphNew(int id);
 static GddVert *gddGraphGetVert(GddGraph *graph, int vid);
 static GddEdge *gddGraphMakeEdge(GddGraph *graph, int from, int to, bool solid);
-static void gddGraphRemoveVid(GddGraph *graph, int vid);
 
 static GddVert *gddVertNew(int id);
 static void gddVertBindStats(GddVert *vert, GddStat *global, GddStat *topstat);
-static bool gddVertUnlinkAll(GddVert *vert);
-static bool gddVertReduce(GddVert *vert);
+static bool gddVertUnlinkAll(GddCtx *ctx, GddVert *vert);
+static bool gddVertReduce(GddCtx *ctx, GddVert *vert);
 static int gddVertGetInDegree(GddVert *vert);
 static int gddVertGetOutDegree(GddVert *vert);
 
@@ -50,6 +76,7 @@ static void gddMapEnsureCapacity(GddMap *map, int capacity);
 static GddPair *gddMapGetPair(GddMap *map, int key);
 static void *gddMapGet(GddMap *map, int key);
 static void gddMapSetUnsafe(GddMap *map, int key, void *ptr);
+static void gddMapIndexInsert(GddMap *map, int pos);
 
 /***************************************************************************/
 
@@ -64,6 +91,7 @@ GddCtxNew(void)
 	gddStatInit(&ctx->topstat, 0);
 	gddMapInit(&ctx->globals);
 	gddMapInit(&ctx->graphs);
+	ctx->pending = NIL;
 
 	return ctx;
 }
@@ -101,40 +129,38 @@ GddCtxAddEdge(GddCtx *ctx, int segid, int from, int to, bool solid)
 }
 
 /*
- * Reduce verts and edges looply until nothing can be deleted.
+ * Reduce verts and edges until nothing can be deleted.
+ *
+ * Instead of looping over all the verts until a pass deletes nothing, every
+ * vert is reduced once, and then only the verts whose reduce conditions are
+ * changed by a deleted edge are reduced again, see gddCtxEnqueueUnlinked().
+ * Deleting edges never invalidates a reduce condition, so the result does
+ * not depend on the order, and the cost is linear in the size of the graphs.
  */
 void
 GddCtxReduce(GddCtx *ctx)
 {
 	GddMapIter	graphiter;
 	GddMapIter	vertiter;
-	bool		dirty = true;
 
 	Assert(ctx != NULL);
 
-	while (dirty)
+	gdd_ctx_foreach_vert(graphiter, vertiter, ctx)
 	{
-		dirty = false;
+		GddVert		*vert = gdd_map_iter_get_ptr(vertiter);
 
-		gdd_ctx_foreach_vert(graphiter, vertiter, ctx)
-		{
-			GddVert		*vert = gdd_map_iter_get_ptr(vertiter);
-
-			if (gddVertReduce(vert))
-				dirty = true;
-
-			/*
-			 * Remove vert from the graph if no edges left.
-			 *
-			 * We want to do this even if gddVertReduce() returns false
-			 * as vert1's last edge might be removed in vert2's reduce call.
-			 * However depending on the order of vert1 and vert2, we can not
-			 * promise all the empty verts are removed, so do not make the
-			 * assumption on this.  See gddCtxGetMaxVid() for example.
-			 */
-			if (!gddVertGetInDegree(vert) && !gddVertGetOutDegree(vert))
-				gdd_map_iter_delete(vertiter);
-		}
+		gddCtxEnqueue(ctx, vert);
+	}
+
+	gddCtxReducePending(ctx);
+
+	/* Remove the verts with no edges left from the graphs */
+	gdd_ctx_foreach_vert(graphiter, vertiter, ctx)
+	{
+		GddVert		*vert = gdd_map_iter_get_ptr(vertiter);
+
+		if (!gddVertGetInDegree(vert) && !gddVertGetOutDegree(vert))
+			gdd_map_iter_delete(vertiter);
 	}
 }
 
@@ -160,10 +186,11 @@ GddCtxBreakDeadLock(GddCtx *ctx)
 
 		/*
 		 * Cancel this vert and reduce again to see if more deadlocks
-		 * are detected.
+		 * are detected, only the neighbours of the cancelled vert need
+		 * to be reduced.
 		 */
 		gddCtxRemoveVid(ctx, maxvid);
-		GddCtxReduce(ctx);
+		gddCtxReducePending(ctx);
 	}
 
 	return vids;
@@ -229,21 +256,28 @@ gddCtxGetGlobalStat(GddCtx *ctx, int vid)
 }
 
 /*
- * Remove verts whose vert id equal to vid on all local graphs.
+ * Remove all the edges of the verts whose vert id equal to vid on all local
+ * graphs.
+ *
+ * The verts themselves are left in the graphs, with no edges.
  */
 static void
 gddCtxRemoveVid(GddCtx *ctx, int vid)
 {
-	GddMapIter	iter;
+	GddStat		*global;
+	ListCell	*cell;
 
 	Assert(ctx != NULL);
 
-	/* Do not use gdd_ctx_foreach_vert() as break is used in the inner loop */
-	gdd_ctx_foreach_graph(iter, ctx)
+	global = gddMapGet(&ctx->globals, vid);
+	if (!global)
+		return;
+
+	foreach(cell, global->verts)
 	{
-		GddGraph	*graph = gdd_map_iter_get_ptr(iter);
+		GddVert		*vert = lfirst(cell);
 
-		gddGraphRemoveVid(graph, vid);
+		gddVertUnlinkAll(ctx, vert);
 	}
 }
 
@@ -253,28 +287,93 @@ gddCtxRemoveVid(GddCtx *ctx, int vid)
 static int
 gddCtxGetMaxVid(GddCtx *ctx)
 {
-	GddMapIter	graphiter;
-	GddMapIter	vertiter;
+	GddMapIter	iter;
 	int			maxvid = 0;
 
 	Assert(ctx != NULL);
 
-	gdd_ctx_foreach_vert(graphiter, vertiter, ctx)
+	gdd_ctx_foreach_global(iter, ctx)
 	{
-		GddVert		*vert = gdd_map_iter_get_ptr(vertiter);
+		GddStat		*global = gdd_map_iter_get_ptr(iter);
 
 		/*
-		 * It's possible for vert to have zero in/out edge,
-		 * which means vert was already deleted in the
-		 * algorithm conception so should be skipped.
+		 * A vert id with zero global in/out degrees has no edges on any
+		 * graph, it was already deleted in the algorithm conception so
+		 * should be skipped.
 		 */
-		if (gddVertGetInDegree(vert) || gddVertGetOutDegree(vert))
-			maxvid = Max(maxvid, vert->id);
+		if (global->indeg || global->outdeg)
+			maxvid = Max(maxvid, global->id);
 	}
 
 	return maxvid;
 }
 
+/*
+ * Add a vert to the pending list, unless it is already there.
+ */
+static void
+gddCtxEnqueue(GddCtx *ctx, GddVert *vert)
+{
+	Assert(ctx != NULL);
+	Assert(vert != NULL);
+
+	if (vert->queued)
+		return;
+
+	vert->queued = true;
+	ctx->pending = lcons(vert, ctx->pending);
+}
+
+/*
+ * Add the verts affected by an unlinked edge to the pending list.
+ *
+ * Deleting an edge can only enable the rules of the verts whose degrees it
+ * decreases to 0: its from vert once it has no local out edges, and all the
+ * local verts of its from/to vert ids once they have no global out/in edges.
+ * Each of these transitions happens only once per vert or vert id.
+ */
+static void
+gddCtxEnqueueUnlinked(GddCtx *ctx, GddEdge *edge)
+{
+	ListCell	*cell;
+
+	Assert(edge != NULL);
+
+	if (gddVertGetOutDegree(edge->from) == 0)
+		gddCtxEnqueue(ctx, edge->from);
+
+	if (edge->from->global->outdeg == 0)
+	{
+		foreach(cell, edge->from->global->verts)
+			gddCtxEnqueue(ctx, lfirst(cell));
+	}
+
+	if (edge->to->global->indeg == 0)
+	{
+		foreach(cell, edge->to->global->verts)
+			gddCtxEnqueue(ctx, lfirst(cell));
+	}
+}
+
+/*
+ * Reduce the pending verts until the pending list is empty.
+ */
+static void
+gddCtxReducePending(GddCtx *ctx)
+{
+	Assert(ctx != NULL);
+
+	while (ctx->pending != NIL)
+	{
+		GddVert		*vert = linitial(ctx->pending);
+
+		ctx->pending = list_delete_first(ctx->pending);
+		vert->queued = false;
+
+		gddVertReduce(ctx, vert);
+	}
+}
+
 /***************************************************************************/
 
 /*
@@ -301,6 +400,7 @@ gddStatInit(GddStat *stat, int vid)
 	stat->id = vid;
 	stat->indeg = 0;
 	stat->outdeg = 0;
+	stat->verts = NIL;
 }
 
 /***************************************************************************/
@@ -365,36 +465,6 @@ gddGraphMakeEdge(GddGraph *graph, int from, int to, bool solid)
 	return edge;
 }
 
-/*
- * Remove the vert whose vert id is vid.
- */
-static void
-gddGraphRemoveVid(GddGraph *graph, int vid)
-{
-	GddMapIter	iter;
-
-	Assert(graph != NULL);
-
-	gdd_graph_foreach_vert(iter, graph)
-	{
-		GddVert		*vert = gdd_map_iter_get_ptr(iter);
-
-		Assert(vert != NULL);
-
-		if (vert->id != vid)
-			continue;
-
-		/* Remove all local in/out edges */
-		gddVertUnlinkAll(vert);
-
-		/* Finally remove vert from graph */
-		gdd_map_iter_delete(iter);
-
-		/* Only one vert could have vert id equals to vid */
-		break;
-	}
-}
-
 /***************************************************************************/
 
 /*
@@ -408,6 +478,9 @@ gddVertNew(int id)
 	vert->id = id;
 	vert->edgesIn = NIL;
 	vert->edgesOut = NIL;
+	vert->queued = false;
+	vert->topstat = NULL;
+	vert->global = NULL;
 	vert->data = NULL;
 
 	return vert;
@@ -415,11 +488,18 @@ gddVertNew(int id)
 
 /*
  * Bind global and vert.
+ *
+ * The vert is also added to the global's list of local verts when it is bound
+ * for the first time.
  */
 static void
 gddVertBindStats(GddVert *vert, GddStat *global, GddStat *topstat)
 {
 	Assert(vert != NULL);
+	Assert(vert->global == NULL || vert->global == global);
+
+	if (vert->global == NULL)
+		global->verts = lappend(global->verts, vert);
 
 	vert->global = global;
 	vert->topstat = topstat;
@@ -429,7 +509,7 @@ gddVertBindStats(GddVert *vert, GddStat *global, GddStat *topstat)
  * Unlink vert's all edges.
  */
 static bool
-gddVertUnlinkAll(GddVert *vert)
+gddVertUnlinkAll(GddCtx *ctx, GddVert *vert)
 {
 	GddListIter	edgeiter;
 	bool		dirty = false;
@@ -441,6 +521,7 @@ gddVertUnlinkAll(GddVert *vert)
 		GddEdge		*edge = gdd_list_iter_get_ptr(edgeiter);
 
 		gddEdgeUnlink(edge, NULL, &edgeiter);
+		gddCtxEnqueueUnlinked(ctx, edge);
 		dirty = true;
 	}
 
@@ -451,6 +532,7 @@ gddVertUnlinkAll(GddVert *vert)
 		GddEdge		*edge = gdd_list_iter_get_ptr(edgeiter);
 
 		gddEdgeUnlink(edge, &edgeiter, NULL);
+		gddCtxEnqueueUnlinked(ctx, edge);
 		dirty = true;
 	}
 
@@ -467,7 +549,7 @@ gddVertUnlinkAll(GddVert *vert)
  * Return true if anything is deleted.
  */
 static bool
-gddVertReduce(GddVert *vert)
+gddVertReduce(GddCtx *ctx, GddVert *vert)
 {
 	GddStat		*global;
 	bool		dirty = false;
@@ -483,7 +565,7 @@ gddVertReduce(GddVert *vert)
 	if (global->indeg == 0 || global->outdeg == 0)
 	{
 		/* Remove all local in/out edges */
-		if (gddVertUnlinkAll(vert))
+		if (gddVertUnlinkAll(ctx, vert))
 			dirty = true;
 
 		return dirty;
@@ -505,6 +587,7 @@ gddVertReduce(GddVert *vert)
 				continue;
 
 			gddEdgeUnlink(edge, NULL, &edgeiter);
+			gddCtxEnqueueUnlinked(ctx, edge);
 			dirty = true;
 		}
 
@@ -667,6 +750,7 @@ gddMapInit(GddMap *map)
 	map->length = 0;
 	map->capacity = 4;
 	map->pairs = palloc(map->capacity * sizeof(GddPair));
+	map->index = NULL;
 }
 
 /*
@@ -699,6 +783,13 @@ gddMapGetPair(GddMap *map, int key)
 
 	Assert(map != NULL);
 
+	if (map->index)
+	{
+		GddMapIndexEntry *entry = gddmap_lookup(map->index, key);
+
+		return entry ? &map->pairs[entry->pos] : NULL;
+	}
+
 	for (i = 0; i < map->length; i++)
 	{
 		GddPair		*pair = &map->pairs[i];
@@ -741,4 +832,65 @@ gddMapSetUnsafe(GddMap *map, int key, void *ptr)
 
 	pair->key = key;
 	pair->ptr = ptr;
+
+	if (map->index)
+		gddMapIndexInsert(map, map->length - 1);
+	else if (map->length > GDD_MAP_INDEX_THRESHOLD)
+	{
+		int			i;
+
+		map->index = gddmap_create(CurrentMemoryContext, map->length * 2, NULL);
+
+		for (i = 0; i < map->length; i++)
+			gddMapIndexInsert(map, i);
+	}
+}
+
+/*
+ * Add the pair at pos to the hash index of map.
+ */
+static void
+gddMapIndexInsert(GddMap *map, int pos)
+{
+	GddMapIndexEntry *entry;
+	bool		found;
+
+	entry = gddmap_insert(map->index, map->pairs[pos].key, &found);
+	Assert(!found);
+
+	entry->pos = pos;
+}
+
+/*
+ * Delete the pair at pos, the last pair is moved to its place.
+ *
+ * Used by gdd_map_iter_delete(), which steps the iter back so the moved pair
+ * is visited next.
+ */
+void
+GddMapDeleteAt(GddMap *map, int pos)
+{
+	int			last;
+
+	Assert(map != NULL);
+	Assert(pos >= 0 && pos < map->length);
+
+	last = --map->length;
+
+	if (map->index)
+	{
+		gddmap_delete(map->index, map->pairs[pos].key);
+
+		if (pos != last)
+		{
+			GddMapIndexEntry *entry;
+
+			entry = gddmap_lookup(map->index, map->pairs[last].key);
+			Assert(entry != NULL);
+
+			entry->pos = pos;
+		}
+	}
+
+	map->pairs[pos] = map->pairs[last];
 }
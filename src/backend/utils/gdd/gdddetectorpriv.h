@@ -70,7 +70,7 @@
  * In-place delete the <k,v> pair at iter.
  */
 #define gdd_map_iter_delete(iter) \
-	(iter).map->pairs[(iter).pos--] = (iter).map->pairs[--((iter).map->length)]
+	GddMapDeleteAt((iter).map, (iter).pos--)
 
 /*
  * Return true if iter is not the last item.
@@ -146,6 +146,9 @@ struct GddPair
 
 /*
  * A simple int->ptr map, implemented with array.
+ *
+ * Once the map grows beyond a few pairs the keys are looked up with a hash
+ * index, as a graph can have thousands of verts on a busy cluster.
  */
 struct GddMap
 {
@@ -153,6 +156,8 @@ struct GddMap
 	int			capacity;		/* capacity of the <k,v> array */
 
 	GddPair		*pairs;			/* array of <k,v> pairs */
+
+	struct gddmap_hash *index;	/* key -> position in pairs, or NULL */
 };
 
 /*
@@ -209,6 +214,8 @@ struct GddVert
 	List		*edgesIn;		/* List<Edge>, directed edges to vert */
 	List		*edgesOut;		/* List<Edge>, directed edges from vert */
 
+	bool		queued;			/* is it in ctx->pending? */
+
 	/*
 	 * The data set and used only by the caller, GDD does not touch or access
 	 * it.
@@ -235,6 +242,8 @@ struct GddStat
 
 	int			indeg;			/* in degree */
 	int			outdeg;			/* out degree */
+
+	List		*verts;			/* List<Vert>, the local verts with this vert id */
 };
 
 /*
@@ -245,8 +254,12 @@ struct GddCtx
 	GddStat		topstat;		/* overall in/out degrees of all verts on all graphs */
 	GddMap		globals;		/* Map<vid, Stat>, global in/out degrees */
 	GddMap		graphs;			/* Map<segid, Graph>, the local graphs */
+
+	List		*pending;		/* List<Vert>, verts to be reduced */
 };
 
 /***************************************************************************/
 
+extern void GddMapDeleteAt(GddMap *map, int pos);
+
 #endif   /* GDDDETECTORPRIV_H */
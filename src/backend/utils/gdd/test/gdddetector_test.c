@@ -557,6 +557,124 @@ test_reduce_large_graph_no_deadlock2(void **state)
 	assert_true(is_empty);
 }
 
+/*
+ * Test case #6: test_break_large_graph_deadlock_with_waiters
+ *
+ * - 10 segments
+ * - 1100 transactions (gxids are from 1 to 1100)
+ * - Wait relations:
+ *   - The i-th transaction waits for the (i+1)-th transaction on segment
+ *     i % 10, and txn 1000 waits for txn 1 on segment 9, all on solid edges,
+ *     so txns 1 to 1000 form a single cycle.
+ *   - The (1000+i)-th transaction waits for txn i on segment i % 10 with a
+ *     solid edge, these waiters are not part of the cycle.
+ *   - After cancelling the youngest txn of the cycle, txn 1000, nothing is
+ *     left.
+ */
+static void
+test_break_large_graph_deadlock_with_waiters(void **state)
+{
+	const int	num_cycle = 1000;
+	const int	num_waiters = 100;
+	const int	num_relations = num_cycle + num_waiters;
+	TestWaitRelation *wait_relations = palloc(num_relations * sizeof(TestWaitRelation));
+	int			i;
+
+	for (i = 0; i < num_relations; i++)
+	{
+		TestWaitRelation *r = &wait_relations[i];
+		TransactionId gxid1 = i + 1;
+		TransactionId gxid2;
+
+		if (gxid1 <= num_cycle)
+			gxid2 = (gxid1 < num_cycle) ? gxid1 + 1 : 1;
+		else
+			gxid2 = gxid1 - num_cycle;
+
+		r->seg_id = gxid2 % 10;
+		r->waiter_xid = gxid1;
+		r->holder_xid = gxid2;
+		r->solid_edge = true;
+		r->waiter_pid = gxid1;
+		r->holder_pid = gxid2;
+		r->lock_methodid = DEFAULT_LOCKMETHOD;
+		r->lock_mode = ShareLock;
+		r->lock_tagtype = LOCKTAG_TRANSACTION;
+		r->waiter_sessionid = gxid1 * 10;
+		r->holder_sessionid = gxid2 * 10;
+	}
+
+	GddCtx *ctx;
+
+	oldContext = MemoryContextSwitchTo(gddContext);
+
+	ctx = GddCtxNew();
+
+	loadTestWaitRelations(ctx, wait_relations, num_relations);
+
+	GddCtxReduce(ctx);
+
+	int edges_in_cycle = ctx->topstat.outdeg;
+
+	List *vids = GddCtxBreakDeadLock(ctx);
+
+	int num_vids = list_length(vids);
+	int cancelled = linitial_int(vids);
+	bool is_empty = GddCtxEmpty(ctx);
+
+	MemoryContextSwitchTo(oldContext);
+	MemoryContextReset(gddContext);
+	pfree(wait_relations);
+
+	assert_int_equal(edges_in_cycle, num_cycle);
+	assert_int_equal(num_vids, 1);
+	assert_int_equal(cancelled, num_cycle);
+	assert_true(is_empty);
+}
+
+/*
+ * Test case #7: test_map_index
+ *
+ * A map large enough to be indexed must still find all of its keys after
+ * pairs are deleted during an iteration.
+ */
+static void
+test_map_index(void **state)
+{
+	GddMap		map;
+	GddMapIter	iter;
+	int			i;
+
+	oldContext = MemoryContextSwitchTo(gddContext);
+
+	gddMapInit(&map);
+
+	for (i = 1; i <= 100; i++)
+		gddMapSetUnsafe(&map, i, (void *) (intptr_t) (i * 10));
+
+	assert_true(map.index != NULL);
+
+	/* delete the even keys */
+	gdd_map_foreach_safe(iter, &map)
+	{
+		if ((intptr_t) gdd_map_iter_get_ptr(iter) % 20 == 0)
+			gdd_map_iter_delete(iter);
+	}
+
+	assert_int_equal(map.length, 50);
+
+	for (i = 1; i <= 100; i++)
+	{
+		if (i % 2 == 0)
+			assert_true(gddMapGet(&map, i) == NULL);
+		else
+			assert_int_equal((intptr_t) gddMapGet(&map, i), i * 10);
+	}
+
+	MemoryContextSwitchTo(oldContext);
+	MemoryContextReset(gddContext);
+}
+
 int
 main(int argc, char *argv[])
 {
@@ -567,7 +685,9 @@ main(int argc, char *argv[])
 		unit_test(test_reduce_large_graph_pair_deadlocks),
 		unit_test(test_reduce_large_graph_no_deadlock1),
 		unit_test(test_reduce_large_graph_single_deadlock),
-		unit_test(test_reduce_large_graph_no_deadlock2)
+		unit_test(test_reduce_large_graph_no_deadlock2),
+		unit_test(test_break_large_graph_deadlock_with_waiters),
+		unit_test(test_map_index)
 	};
 
 	MemoryContextInit();
@@ -152,7 +152,7 @@ int			max_parallel_maintenance_workers = 2;
  */
 int			NBuffers = 4096;
 int			MaxConnections = 90;
-int			max_worker_processes = 8 + MaxPMAuxProc;
+int			max_worker_processes = 8 + MinPMAuxProc;
 int			max_parallel_workers = 8;
 int			MaxBackends = 0;
 
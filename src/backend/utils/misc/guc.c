@@ -2866,7 +2866,7 @@ static struct config_int ConfigureNamesInt[] =
 			NULL,
 		},
 		&max_worker_processes,
-		8 + MaxPMAuxProc, 1, MAX_BACKENDS,
+		8 + MinPMAuxProc, 1, MAX_BACKENDS,
 		check_max_worker_processes, NULL, NULL
 	},
 
@@ -11793,10 +11793,14 @@ check_max_worker_processes(int *newval, void **extra, GucSource source)
 		*newval + max_wal_senders > MAX_BACKENDS)
 		return false;
 
-	if (*newval < MaxPMAuxProc)
+	/*
+	 * gp_interconnect_proxy_workers may not be known yet, the postmaster
+	 * checks the reservation for the extra ic-proxy workers at startup.
+	 */
+	if (*newval < MinPMAuxProc)
 	{
 		elog(ERROR, "max_worker_processes less than %d, must reserve %d "
-			 "for auxiliary processes like FTS", MaxPMAuxProc, MaxPMAuxProc);
+			 "for auxiliary processes like FTS", MinPMAuxProc, MinPMAuxProc);
 		return false;
 	}
 
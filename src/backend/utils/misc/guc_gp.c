@@ -40,6 +40,7 @@
 #include "parser/scansup.h"
 #include "postmaster/syslogger.h"
 #include "postmaster/fts.h"
+#include "postmaster/postmaster.h"
 #include "replication/walsender.h"
 #include "storage/proc.h"
 #include "tcop/idle_resource_cleaner.h"
@@ -80,6 +81,7 @@ static bool check_verify_gpfdists_cert(bool *newval, void **extra, GucSource sou
 static bool check_dispatch_log_stats(bool *newval, void **extra, GucSource source);
 static bool check_gp_hashagg_default_nbatches(int *newval, void **extra, GucSource source);
 static bool check_gp_workfile_compression(bool *newval, void **extra, GucSource source);
+static bool check_gp_interconnect_compression(bool *newval, void **extra, GucSource source);
 
 /* Helper function for guc setter */
 bool gpvars_check_gp_resqueue_priority_default_value(char **newval,
@@ -141,6 +143,7 @@ bool		gp_appendonly_verify_block_checksums = true;
 bool		gp_appendonly_verify_write_block = false;
 bool		gp_appendonly_compaction = true;
 int			gp_appendonly_compaction_threshold = 0;
+int			gp_appendonly_compress_workers = 0;
 bool		gp_heap_require_relhasoids_match = true;
 bool		gp_local_distributed_cache_stats = false;
 bool		debug_xlog_record_read = false;
@@ -494,6 +497,7 @@ static const struct config_enum_entry gp_autostats_modes[] = {
 static const struct config_enum_entry gp_interconnect_fc_methods[] = {
 	{"loss", INTERCONNECT_FC_METHOD_LOSS},
 	{"capacity", INTERCONNECT_FC_METHOD_CAPACITY},
+	{"delay", INTERCONNECT_FC_METHOD_DELAY},
 	{NULL, 0}
 };
 
@@ -619,6 +623,38 @@ struct config_bool ConfigureNamesBool_gp[] =
 		true,
 		NULL, NULL, NULL
 	},
+	{
+		{"gp_dispatch_slice_plans", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Dispatch to each gang only the plan of its own slice."),
+			gettext_noop("Shrinks the messages sent to the QEs of plans with "
+						 "many slices. Has no effect unless execute_pruned_plan is on.")
+		},
+		&gp_dispatch_slice_plans,
+		true,
+		NULL, NULL, NULL
+	},
+	{
+		{"gp_enable_dtx_read_only_vote", PGC_USERSET, GP_ARRAY_TUNING,
+			gettext_noop("Commit the segments that wrote nothing in one phase at prepare time."),
+			gettext_noop("Only the segments whose QE assigned a transaction ID "
+						 "or wrote WAL take part in the two-phase commit of a "
+						 "distributed transaction.")
+		},
+		&gp_enable_dtx_read_only_vote,
+		false,
+		NULL, NULL, NULL
+	},
+	{
+		{"gp_pipeline_utility_dispatch", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Collect the results of a utility statement in a transaction block only before the next dispatch."),
+			gettext_noop("The QD works on the next statement while the segments "
+						 "run the previous one; an error of the segments is "
+						 "raised by the next statement that dispatches, or by the commit.")
+		},
+		&gp_pipeline_utility_dispatch,
+		false,
+		NULL, NULL, NULL
+	},
 	{
 		{"gp_enable_predicate_propagation", PGC_USERSET, QUERY_TUNING_OTHER,
 			gettext_noop("When two expressions are equivalent (such as with "
@@ -989,6 +1025,41 @@ struct config_bool ConfigureNamesBool_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_interconnect_compression", PGC_USERSET, QUERY_TUNING_OTHER,
+			gettext_noop("Compresses large tuples sent through motions."),
+			gettext_noop("Tuples are compressed with zstd at level 1, and are sent "
+						 "uncompressed when that does not make them smaller.")
+		},
+		&gp_interconnect_compression,
+		false,
+		check_gp_interconnect_compression, NULL, NULL
+	},
+
+	{
+		{"gp_interconnect_tuple_batching", PGC_USERSET, QUERY_TUNING_OTHER,
+			gettext_noop("Sends narrow tuples through motions in batches."),
+			gettext_noop("Tuples sent to the same receiver are packed several to a "
+						 "chunk, saving per-tuple chunk overhead on both ends.")
+		},
+		&gp_interconnect_tuple_batching,
+		false,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"gp_interconnect_local_shm", PGC_USERSET, QUERY_TUNING_OTHER,
+			gettext_noop("Uses shared memory queues for TCP interconnect routes within a segment."),
+			gettext_noop("When a motion sender and receiver run in the same segment, "
+						 "packets go through a shared memory queue instead of a "
+						 "loopback socket.  Only applies when gp_interconnect_type "
+						 "is tcp.")
+		},
+		&gp_interconnect_local_shm,
+		false,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"gp_interconnect_log_stats", PGC_USERSET, QUERY_TUNING_OTHER,
 			gettext_noop("Emit statistics from the UDP-IC at the end of every statement."),
@@ -2847,6 +2918,19 @@ struct config_int ConfigureNamesInt_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_client_send_buffer_size", PGC_USERSET, RESOURCES_MEM,
+			gettext_noop("Sets the size of the buffer for the rows sent to the client."),
+			gettext_noop("The rows are sent when the buffer is full, a larger buffer "
+						 "sends large result sets with fewer system calls.  Only used "
+						 "on the coordinator."),
+			GUC_UNIT_KB
+		},
+		&gp_client_send_buffer_size,
+		64, 8, 65536,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"gp_max_local_distributed_cache", PGC_POSTMASTER, RESOURCES_MEM,
 			gettext_noop("Sets the number of local-distributed transactions to cache for optimizing visibility processing by backends."),
@@ -2983,6 +3067,18 @@ struct config_int ConfigureNamesInt_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_appendonly_compress_workers", PGC_USERSET, APPENDONLY_TABLES,
+			gettext_noop("Sets the number of helper threads used to compress each append-optimized block."),
+			gettext_noop("Only zstd compression uses helper threads, and only with a blocksize of 1MB "
+						 "or more: zstd's minimum job size, 512kB, is well above the default 32kB "
+						 "block. 0 compresses in the backend process itself.")
+		},
+		&gp_appendonly_compress_workers,
+		0, 0, 16,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"gp_workfile_max_entries", PGC_POSTMASTER, RESOURCES,
 			gettext_noop("Sets the maximum number of entries that can be stored in the workfile directory"),
@@ -3243,6 +3339,19 @@ struct config_int ConfigureNamesInt_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_interconnect_flush_deadline", PGC_USERSET, GP_ARRAY_TUNING,
+			gettext_noop("Sets the maximum time a tuple waits in a motion sender's buffers."),
+			gettext_noop("Buffered tuples are sent once they wait this long, and "
+						 "routes that see less than a tuple in this time send every "
+						 "tuple right away.  0 disables the deadline."),
+			GUC_UNIT_MS
+		},
+		&gp_interconnect_flush_deadline,
+		0, 0, 60000,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"gp_udp_bufsize_k", PGC_BACKEND, GP_ARRAY_TUNING,
 			gettext_noop("Sets recv buf size of UDP interconnect, for testing."),
@@ -3353,6 +3462,17 @@ struct config_int ConfigureNamesInt_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_qe_pool_size", PGC_SUSET, GP_ARRAY_TUNING,
+			gettext_noop("Sets the maximum number of idle reader QEs cached by all the sessions of a database and role."),
+			gettext_noop("-1 means no limit. Use ALTER DATABASE or ALTER ROLE to set it per database or role."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&gp_qe_pool_size,
+		-1, -1, INT_MAX,
+		NULL, NULL, NULL
+	},
+
 
 	{
 		{"gp_debug_linger", PGC_USERSET, DEVELOPER_OPTIONS,
@@ -3410,6 +3530,21 @@ struct config_int ConfigureNamesInt_gp[] =
 		NULL, NULL, NULL
 	},
 
+#ifdef ENABLE_IC_PROXY
+	{
+		{"gp_interconnect_proxy_workers", PGC_POSTMASTER, GP_ARRAY_TUNING,
+			gettext_noop("Sets the number of ic-proxy worker processes on each segment."),
+			gettext_noop("Worker N listens on the port in gp_interconnect_proxy_addresses plus N, "
+						 "so the ports of the segments on the same host must be at least "
+						 "this many apart.  Each worker takes one of max_worker_processes."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&gp_interconnect_proxy_workers,
+		1, 1, IC_PROXY_MAX_WORKERS,
+		NULL, NULL, NULL
+	},
+#endif  /* ENABLE_IC_PROXY */
+
 	{
 		{"gp_snapshotadd_timeout", PGC_USERSET, GP_ARRAY_TUNING,
 			gettext_noop("Timeout (in seconds) on setup of new connection snapshot"),
@@ -4440,7 +4575,7 @@ struct config_enum ConfigureNamesEnum_gp[] =
 	{
 		{"gp_interconnect_fc_method", PGC_USERSET, GP_ARRAY_TUNING,
 			gettext_noop("Sets the flow control method used for UDP interconnect."),
-			gettext_noop("Valid values are \"capacity\" and \"loss\".")
+			gettext_noop("Valid values are \"capacity\", \"loss\" and \"delay\".")
 		},
 		&Gp_interconnect_fc_method,
 		INTERCONNECT_FC_METHOD_LOSS, gp_interconnect_fc_methods,
@@ -4871,6 +5006,19 @@ check_gp_workfile_compression(bool *newval, void **extra, GucSource source)
 	return true;
 }
 
+static bool
+check_gp_interconnect_compression(bool *newval, void **extra, GucSource source)
+{
+#ifndef USE_ZSTD
+	if (*newval)
+	{
+		GUC_check_errmsg("interconnect compression is not supported by this build");
+		return false;
+	}
+#endif
+	return true;
+}
+
 void
 DispatchSyncPGVariable(struct config_generic * gconfig)
 {
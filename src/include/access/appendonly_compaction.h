@@ -18,6 +18,7 @@
 #include "utils/rel.h"
 #include "access/memtup.h"
 #include "executor/tuptable.h"
+#include "utils/tuplesort.h"
 
 #define APPENDONLY_COMPACTION_SEGNO_INVALID (-1)
 
@@ -34,6 +35,15 @@ extern bool AppendOnlyCompaction_ShouldCompact(
 								   bool isFull,
 								   Snapshot appendOnlyMetaDataSnapshot);
 extern void AppendOnlyThrowAwayTuple(Relation rel, TupleTableSlot *slot);
+extern BlockNumber AppendOnlyCompaction_PagesPerDelayPoint(int64 segeof,
+														 int64 varblockcount);
+extern void AppendOnlyCompaction_DelayPoint(BlockNumber pages,
+											int64 droppedTupleCount);
 extern void AppendOnlyTruncateToEOF(Relation aorel);
+extern Relation AppendOnlyCompaction_OpenClusterIndex(Relation aorel);
+extern void AppendOnlyCompaction_SortTuple(Tuplesortstate *sortstate,
+										   TupleTableSlot *slot);
+extern bool AppendOnlyCompaction_FetchSortedTuple(Tuplesortstate *sortstate,
+												  TupleTableSlot *slot);
 
 #endif
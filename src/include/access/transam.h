@@ -155,6 +155,13 @@ typedef struct VariableCacheData
 	TransactionId latestCompletedGxid;	/* newest distributed XID that has
 										   committed or aborted */
 
+	/*
+	 * Number of distributed transactions that ended, protected by
+	 * ProcArrayLock too.  While it stays the same, a distributed snapshot
+	 * taken earlier is still valid, see CreateDistributedSnapshot().
+	 */
+	uint64		gxactCompletionCount;
+
 	/*
 	 * The two variables are protected by shmGxidGenLock.  Note nextGxid won't
 	 * be accurate after crash recovery.  When crash recovery happens, we bump
@@ -118,6 +118,13 @@ typedef struct AOCSScanDescData
 	int64		nextTupleId;
 	int64		targetTupleId;
 
+	/*
+	 * Only used by `analyze` when the relation has a block directory. The
+	 * sample rows are then fetched by row number, instead of scanning the
+	 * table up to them. See aocsam_handler.c.
+	 */
+	struct AOCSAnalyzeSamplerData *sampler;
+
 	/*
 	 * Part of the struct to be used only inside aocsam.c
 	 */
@@ -159,6 +166,12 @@ typedef struct AOCSScanDescData
 		AttrNumber			num_proj_atts;
 
 		struct DatumStreamRead **ds;
+
+		/*
+		 * Values decoded ahead from the current block of each projected
+		 * column, indexed like proj_atts. See aocs_getnext().
+		 */
+		struct AOCSColumnBatch *batch;
 	} columnScanInfo;
 
 	struct AOCSFileSegInfo **seginfo;
@@ -49,6 +49,17 @@ typedef struct MinipageEntry
 	int64 rowCount;
 } MinipageEntry;
 
+/*
+ * The rows covered by one minipage of a segment file, in row number order.
+ * Used by ANALYZE to sample rows through the block directory.
+ */
+typedef struct MinipageRowRange
+{
+	int			segno;
+	int64		firstRowNum;	/* first row number covered by the minipage */
+	int64		rowCount;		/* number of rows covered by its entries */
+} MinipageRowRange;
+
 /*
  * Define a varlena type for a minipage.
  */
@@ -168,6 +179,15 @@ extern bool AppendOnlyBlockDirectory_GetEntry(
 	AOTupleId 						*aoTupleId,
 	int                             columnGroupNo,
 	AppendOnlyBlockDirectoryEntry	*directoryEntry);
+extern MinipageRowRange *AppendOnlyBlockDirectory_GetMinipageRowRanges(
+	AppendOnlyBlockDirectory		*blockDirectory,
+	int								columnGroupNo,
+	int								*nranges);
+extern MinipagePerColumnGroup *AppendOnlyBlockDirectory_LoadMinipage(
+	AppendOnlyBlockDirectory		*blockDirectory,
+	int								segno,
+	int								columnGroupNo,
+	int64							firstRowNum);
 extern void AppendOnlyBlockDirectory_Init_forInsert(
 	AppendOnlyBlockDirectory *blockDirectory,
 	Snapshot appendOnlyMetaDataSnapshot,
@@ -17,6 +17,7 @@
 #define CDBDISP_H
 
 #include "cdb/cdbtm.h"
+#include "portability/instr_time.h"
 #include "utils/resowner.h"
 
 #define CDB_MOTION_LOST_CONTACT_STRING "Interconnect error master lost contact with segment."
@@ -37,6 +38,22 @@ typedef enum DispatchWaitMode
 	DISPATCH_WAIT_CANCEL			/* send query cancel */
 } DispatchWaitMode;
 
+/*
+ * What a plan dispatch sent and where its time went, filled in by
+ * cdbdisp_dispatchX() and shown by EXPLAIN (ANALYZE, DISPATCH).
+ */
+typedef struct CdbDispatchStats
+{
+	int			numGangs;		/* gangs dispatched to */
+	int			numQEs;			/* QEs dispatched to */
+	int			numPlans;		/* serialized plans built */
+	int64		planBytes;		/* size of those plans, compressed */
+	int64		bytesSent;		/* size of the messages sent to all QEs */
+	instr_time	gangTime;		/* allocating the gangs */
+	instr_time	buildTime;		/* serializing the plans and messages */
+	instr_time	sendTime;		/* sending the messages to the QEs */
+} CdbDispatchStats;
+
 typedef struct CdbDispatcherState
 {
 	List *allocatedGangs;
@@ -49,6 +66,7 @@ typedef struct CdbDispatcherState
 	bool isGangDestroying;
 #endif
 	bool destroyIdleReaderGang;
+	CdbDispatchStats stats;
 } CdbDispatcherState;
 
 typedef struct DispatcherInternalFuncs
@@ -59,6 +77,8 @@ typedef struct DispatcherInternalFuncs
 	void (*checkResults)(struct CdbDispatcherState *ds, DispatchWaitMode waitMode);
 	void (*dispatchToGang)(struct CdbDispatcherState *ds, struct Gang *gp, int sliceIndex);
 	void (*waitDispatchFinish)(struct CdbDispatcherState *ds);
+	void (*destroyDispatchParams)(void *dispatchParams);
+	void (*setQueryText)(struct CdbDispatcherState *ds, char *queryText, int queryTextLen);
 
 }DispatcherInternalFuncs;
 
@@ -159,6 +179,15 @@ CdbDispatchHandleError(struct CdbDispatcherState *ds);
 void
 cdbdisp_cancelDispatch(CdbDispatcherState *ds);
 
+/*
+ * Pipelined utility dispatch (gp_pipeline_utility_dispatch): a dispatcher
+ * state can be left with its QEs still running, to be finished before the
+ * next dispatcher state is made, or before the commit.  Only one at a time.
+ */
+void cdbdisp_deferDispatcherState(CdbDispatcherState *ds);
+void cdbdisp_finishDeferredDispatch(void);
+void cdbdisp_cancelDeferredDispatch(void);
+
 /*
  * Allocate memory and initialize CdbDispatcherState.
  *
@@ -180,6 +209,16 @@ cdbdisp_makeDispatchParams(CdbDispatcherState *ds,
 						   char *queryText,
 						   int queryTextLen);
 
+/*
+ * Replace the command text that the following cdbdisp_dispatchToGang() calls
+ * send, e.g. to give every gang the plan of its own slice.  The text must stay
+ * valid until the dispatcher state is destroyed.
+ */
+void
+cdbdisp_setDispatchQueryText(CdbDispatcherState *ds,
+							 char *queryText,
+							 int queryTextLen);
+
 bool cdbdisp_checkForCancel(CdbDispatcherState * ds);
 int cdbdisp_getWaitSocketFd(CdbDispatcherState *ds);
 
@@ -49,7 +49,8 @@ typedef struct DistributedSnapshotWithLocalMapping
 
 	/*
 	 * Cache to perform quick check for localXid, populated after reverse
-	 * mapping distributed xid to local xid.
+	 * mapping distributed xid to local xid. inProgressMappedLocalXids is
+	 * kept sorted, so it can be binary searched.
 	 */
 	TransactionId minCachedLocalXid;
 	TransactionId maxCachedLocalXid;
@@ -7,6 +7,7 @@
 #ifndef CDBFTS_H
 #define CDBFTS_H
 
+#include "port/atomics.h"
 #include "storage/lwlock.h"
 #include "cdb/cdbconn.h"
 #include "utils/guc.h"
@@ -30,6 +31,26 @@
 #define FTS_STATUS_RESET(status, flag) ((status) &= ~(flag))
 #define FTS_STATUS_SET_UP(status) FTS_STATUS_RESET((status), FTS_STATUS_DOWN)
 
+/*
+ * Probe statistics, exposed by gp_get_fts_probe_stats().
+ *
+ * FTS_LATENCY_HIST_BUCKETS - probe latency buckets, the first one holds
+ *                            latencies below 1ms and each following one
+ *                            doubles that.
+ * FTS_PROBE_OUTCOMES       - probes that succeeded at the first attempt,
+ *                            succeeded after retries, and failed.
+ */
+#define FTS_LATENCY_HIST_BUCKETS (12)
+
+typedef enum FtsProbeOutcome
+{
+	FTS_PROBE_OUTCOME_SUCCEEDED,
+	FTS_PROBE_OUTCOME_RETRIED,
+	FTS_PROBE_OUTCOME_FAILED,
+
+	FTS_PROBE_OUTCOMES
+} FtsProbeOutcome;
+
 typedef struct FtsProbeInfo
 {
 	volatile uint8		status_version;
@@ -37,6 +58,9 @@ typedef struct FtsProbeInfo
 	volatile slock_t	lock;
 	volatile int32		start_count;
 	volatile int32		done_count;
+
+	pg_atomic_uint64	latency_hist[FTS_LATENCY_HIST_BUCKETS];
+	pg_atomic_uint64	outcomes[FTS_PROBE_OUTCOMES];
 } FtsProbeInfo;
 
 typedef struct FtsControlBlock
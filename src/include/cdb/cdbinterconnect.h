@@ -31,6 +31,9 @@ struct CdbProcess;                          /* #include "nodes/execnodes.h" */
 struct ExecSlice;                           /* #include "nodes/execnodes.h" */
 struct SliceTable;                          /* #include "nodes/execnodes.h" */
 struct EState;                              /* #include "nodes/execnodes.h" */
+struct WaitEventSet;                        /* #include "storage/latch.h" */
+struct dsm_segment;                         /* #include "storage/dsm.h" */
+struct shm_mq_handle;                       /* #include "storage/shm_mq.h" */
 /* TODO: move "src/backend/cdb/motion/ic_proxy_backend.h" into public include folder*/
 struct ICProxyBackendContext;
 
@@ -214,6 +217,8 @@ struct MotionConn
 
 	uint64 rtt;
 	uint64 dev;
+	/* smallest RTT sample seen, used by delay based flow control */
+	uint64 baseRtt;
 	uint64 deadlockCheckBeginTime;
 
 
@@ -306,6 +311,14 @@ struct MotionConn
 	 * all the remap information.
 	 */
 	TupleRemapper	*remapper;
+
+	/*
+	 * TCP only: when both ends run in the same segment, packets travel
+	 * through this shared memory queue instead of the socket.  The socket is
+	 * still used for registration, stop messages and teardown.
+	 */
+	struct dsm_segment *shmSeg;
+	struct shm_mq_handle *shmMqh;
 };
 
 /*
@@ -331,6 +344,15 @@ typedef struct ChunkTransportStateEntry
 	/* highest file descriptor in the readSet. */
 	int			highReadSock;
 
+	/*
+	 * TCP only: wait event set over the sockets in readSet, plus the process
+	 * latch and the dispatcher socket it was built with.  Built lazily by the
+	 * receiver and rebuilt when it goes stale, since a WaitEventSet can't
+	 * have events removed.
+	 */
+	struct WaitEventSet *readWaitSet;
+	int			readWaitSetDispatchFd;
+
     int         scanStart;
 
 	/* slice table entries */
@@ -353,6 +375,13 @@ typedef struct ChunkTransportStateEntry
 	uint64 stat_max_resent;
 	uint64 stat_count_dropped;
 
+	/*
+	 * Send side copy accounting: tuples sent, and tuple bytes memcpy'd in
+	 * user space on their way to the kernel.
+	 */
+	uint64 stat_tuples_sent;
+	uint64 stat_bytes_copied;
+
 }	ChunkTransportStateEntry;
 
 /* ChunkTransportState array initial size */
@@ -414,6 +443,25 @@ typedef struct MotionNodeEntry
 	 */
 	SerTupInfo      ser_tup_info;
 
+	/*
+	 * Route-based array of TC_BATCH chunks, collecting small outgoing tuples
+	 * until they are sent together; the last entry is for broadcasts.  NULL
+	 * until the first batched send.
+	 */
+	TupleChunkListItem *send_batches;
+	int             num_send_batches;
+
+	/*
+	 * Route-based send timing for gp_interconnect_flush_deadline, laid out
+	 * like send_batches; NULL until the first send with a deadline set.
+	 * send_oldest_pending is a lower bound of the send_pending_since values
+	 * that are set, 0 if none is.
+	 */
+	TimestampTz    *send_last_time;
+	TimestampTz    *send_pending_since;
+	TimestampTz     send_oldest_pending;
+	int             num_send_routes;
+
 	/*
 	 * If preserve_order is false, this is used to hold completed tuples that
 	 * have not yet been consumed.  If preserve_order is true, this is NULL.
@@ -523,6 +571,7 @@ typedef struct ChunkTransportState
 
 	/* Function pointers to our send/receive functions */
 	bool (*SendChunk)(struct ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, MotionConn *conn, TupleChunkListItem tcItem, int16 motionId);
+	bool (*SendFlush)(struct ChunkTransportState *transportStates, ChunkTransportStateEntry *pEntry, MotionConn *conn, int16 motionId);
 	TupleChunkListItem (*RecvTupleChunkFrom)(struct ChunkTransportState *transportStates, int16 motNodeID, int16 srcRoute);
 	TupleChunkListItem (*RecvTupleChunkFromAny)(struct ChunkTransportState *transportStates, int16 motNodeID, int16 *srcRoute);
 	void (*doSendStopMessage)(struct ChunkTransportState *transportStates, int16 motNodeID);
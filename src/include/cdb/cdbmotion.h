@@ -134,4 +134,14 @@ extern void UpdateMotionExpectedReceivers(MotionLayerState *mlStates,
  */
 extern TupleChunkListItem get_eos_tuplechunklist(void);
 
+/*
+ * Flushing of tuples that have been buffered for gp_interconnect_flush_deadline,
+ * driven by the MOTION_FLUSH_TIMEOUT timer and serviced in ProcessInterrupts().
+ */
+extern volatile bool MotionFlushPending;
+
+extern void MotionFlushTimeoutHandler(void);
+extern void HandleMotionFlushInterrupt(void);
+extern void DisarmMotionFlush(ChunkTransportState *transportStates);
+
 #endif   /* CDBMOTION_H */
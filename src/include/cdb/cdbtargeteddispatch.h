@@ -22,6 +22,7 @@
 #ifndef CDBTARGETEDDISPATCH_H
 #define CDBTARGETEDDISPATCH_H
 
+#include "nodes/params.h"
 #include "nodes/pathnodes.h"
 #include "nodes/plannodes.h"
 
@@ -32,4 +33,7 @@ extern void DirectDispatchUpdateContentIdsForInsert(PlannerInfo *root, Plan *pla
 
 extern void MergeDirectDispatchCalculationInfo(DirectDispatchInfo *to, DirectDispatchInfo *from);
 
+extern bool GetContentIdsFromParams(DirectDispatchInfo *dd, ParamListInfo params,
+									List **contentIds);
+
 #endif   /* CDBTARGETEDDISPATCH_H */
@@ -234,6 +234,9 @@ typedef struct TMGXACTLOCAL
 
 	Bitmapset					*dtxSegmentsMap;
 	List						*dtxSegments;
+
+	/* Segments whose writer QE assigned an xid or wrote WAL in this transaction */
+	Bitmapset					*dtxWriteSegmentsMap;
 	List						*waitGxids;
 }	TMGXACTLOCAL;
 
@@ -344,6 +347,7 @@ extern void markCurrentGxactWriterGangLost(void);
 extern bool currentGxactWriterGangLost(void);
 
 extern void addToGxactDtxSegments(struct Gang* gp);
+extern void markGxactSegmentWrote(int segindex);
 extern bool CurrentDtxIsRollingback(void);
 
 extern pid_t DtxRecoveryPID(void);
@@ -181,6 +181,15 @@ void cdbcomponent_recycleIdleQE(struct SegmentDatabaseDescriptor *segdbDesc, boo
 bool cdbcomponent_qesExist(void);
 bool cdbcomponent_activeQEsExist(void);
 
+/*
+ * The idle QEs cached by all the sessions of a database and role, and the
+ * hit rate of the freelists, are accounted in shared memory.  See
+ * gp_qe_pool_size and the gp_stat_qe_pool view.
+ */
+void cdbcomponent_reportGangSetup(int64 elapsed_us);
+extern Size QEPoolShmemSize(void);
+extern void QEPoolShmemInit(void);
+
 List *cdbcomponent_getCdbComponentsList(void);
 
 extern void writeGpSegConfigToFTSFiles(void);
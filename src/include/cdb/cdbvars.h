@@ -101,6 +101,14 @@ extern int qdPostmasterPort;
 /*How many gangs to keep around from stmt to stmt.*/
 extern int			gp_cached_gang_threshold;
 
+/*
+ * gp_qe_pool_size
+ *
+ * Maximum number of idle reader QEs that all the sessions of the same
+ * database and role may cache on the coordinator, -1 for no limit.
+ */
+extern int			gp_qe_pool_size;
+
 /*
  * gp_reject_percent_threshold
  *
@@ -289,10 +297,18 @@ extern int Gp_interconnect_type;
 
 extern char *gp_interconnect_proxy_addresses;
 
+/*
+ * Number of ic-proxy worker processes on each segment.  Every worker runs its
+ * own event loop and proxy network, logical connections are spread over them
+ * by their keys.
+ */
+extern int	gp_interconnect_proxy_workers;
+
 typedef enum GpVars_Interconnect_Method
 {
 	INTERCONNECT_FC_METHOD_CAPACITY = 0,
 	INTERCONNECT_FC_METHOD_LOSS = 2,
+	INTERCONNECT_FC_METHOD_DELAY = 3,
 } GpVars_Interconnect_Method;
 
 extern int Gp_interconnect_fc_method;
@@ -346,6 +362,38 @@ extern bool gp_interconnect_aggressive_retry; /* fast-track app-level retry */
  */
 extern bool gp_interconnect_full_crc;
 
+/*
+ * Parameter gp_interconnect_compression
+ *
+ * Compress large tuples with zstd before they are sent through a motion.
+ */
+extern bool gp_interconnect_compression;
+
+/*
+ * Parameter gp_interconnect_tuple_batching
+ *
+ * Send narrow tuples through a motion several to a chunk.
+ */
+extern bool gp_interconnect_tuple_batching;
+
+/*
+ * Parameter gp_interconnect_flush_deadline
+ *
+ * Longest time, in milliseconds, a tuple may wait in a motion sender's
+ * buffers for more tuples to the same receiver.  Routes that see less than a
+ * tuple per deadline are flushed after every tuple, and a timer flushes the
+ * others while the sender is busy with its own input.  0 disables it.
+ */
+extern int	gp_interconnect_flush_deadline;
+
+/*
+ * Parameter gp_interconnect_local_shm
+ *
+ * Send TCP interconnect data between processes of the same segment through
+ * a shared memory queue rather than the loopback socket.
+ */
+extern bool gp_interconnect_local_shm;
+
 /*
  * Parameter gp_interconnect_log_stats
  *
@@ -407,6 +455,34 @@ extern bool gp_enable_fast_sri;
 /* Enable single-mirror pair dispatch. */
 extern bool gp_enable_direct_dispatch;
 
+/*
+ * Send each gang only the part of the plan that its slice executes, rather
+ * than the whole plan to every QE.  Only takes effect when the QEs prune the
+ * plan themselves (execute_pruned_plan).
+ */
+extern bool gp_dispatch_slice_plans;
+
+/*
+ * Let the segments of a distributed transaction whose QE assigned no xid and
+ * wrote no WAL commit right away at prepare time, so that only the segments
+ * that wrote take part in the two-phase commit.
+ */
+extern bool gp_enable_dtx_read_only_vote;
+
+/*
+ * In a transaction block, leave the utility statements running on the
+ * segments and collect their results only before the next dispatch, so that
+ * the QD goes on with the next statement meanwhile.
+ */
+extern bool gp_pipeline_utility_dispatch;
+
+/*
+ * Size in kB of the buffer that the rows of a result set are collected in
+ * before they are sent to the client, a large buffer sends a large result
+ * with fewer system calls.
+ */
+extern int gp_client_send_buffer_size;
+
 /* Name of pseudo-function to access any table as if it was randomly distributed. */
 #define GP_DIST_RANDOM_NAME "GP_DIST_RANDOM"
 
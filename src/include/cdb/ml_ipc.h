@@ -44,6 +44,8 @@ typedef struct RegisterMessage
 	int32       srcPid;
 	int32       srcSessionId;
 	int32       srcCommandCount;
+	uint32      srcShmHandle;		/* dsm_handle of a shm_mq, or
+									 * DSM_HANDLE_INVALID */
 } RegisterMessage;
 
 /* 2 bytes to store the size of the entire packet.	a packet is composed of
@@ -142,6 +144,21 @@ extern bool SendTupleChunkToAMS(MotionLayerState *mlStates,
 								int16 targetRoute, 
 								TupleChunkListItem tcItem);
 
+/* The FlushTupleChunksToAMS() function sends out whatever the transport has
+ * buffered for a route, without waiting for its packet to fill up.  For
+ * BROADCAST_SEGIDX every connection is flushed.
+ *
+ * Returns false if none of the motion's connections is active any longer.
+ *
+ * PARAMETERS:
+ *	 - motNodeID:	motion node Id whose connections to flush.
+ *	 - targetRoute: route to flush.
+ */
+extern bool FlushTupleChunksToAMS(MotionLayerState *mlStates,
+								  ChunkTransportState *transportStates,
+								  int16 motNodeID,
+								  int16 targetRoute);
+
 /* The SendEosToAMS() function is used to send an "End Of Stream" message to
  * all connected receivers (generally this is a broadcast)
  *
@@ -312,6 +329,7 @@ extern void markUDPConnInactiveIFC(MotionConn *conn);
 extern void CleanupMotionTCP(void);
 extern void CleanupMotionUDPIFC(void);
 extern void WaitInterconnectQuitUDPIFC(void);
+extern void WakeupMainThreadUDPIFC(void);
 extern void SetupTCPInterconnect(EState *estate);
 extern void SetupUDPIFCInterconnect(EState *estate);
 extern void TeardownTCPInterconnect(ChunkTransportState *transportStates,
@@ -321,6 +339,9 @@ extern void TeardownUDPIFCInterconnect(ChunkTransportState *transportStates,
 
 extern uint32 getActiveMotionConns(void);
 
+extern Size InterconnectUDPStatsShmemSize(void);
+extern void InterconnectUDPStatsShmemInit(void);
+
 extern char *format_sockaddr(struct sockaddr_storage *sa, char *buf, size_t len);
 
 #endif   /* ML_IPC_H */
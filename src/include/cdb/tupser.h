@@ -60,6 +60,13 @@ typedef struct SerTupInfo
 
 	/* true if tupdesc contains record types */
 	bool		has_record_types;
+
+	/*
+	 * Tuple bytes before and after compression, counting only the tuples
+	 * that were sent or received compressed.
+	 */
+	uint64		stat_uncompressed_bytes;
+	uint64		stat_compressed_bytes;
 }	SerTupInfo;
 
 /*
@@ -81,12 +88,23 @@ extern void SerializeRecordCacheIntoChunks(SerTupInfo *pSerInfo,
 										   TupleChunkList tcList,
 										   MotionConn *conn);
 
+/*
+ * SerializeTuple() results, other than the length written to the direct
+ * transport buffer, or 0 when the tuple was put in the chunk list.
+ */
+#define SERIALIZED_INTO_BATCH	(-1)	/* appended to the batch chunk */
+#define SERIALIZE_FLUSH_BATCH	(-2)	/* send the batch chunk, then retry */
+
 /* Convert a tuple into chunks directly in a set of transport buffers */
-extern int SerializeTuple(TupleTableSlot *tuple, SerTupInfo *pSerInfo, struct directTransportBuffer *b, TupleChunkList tcList, int16 targetRoute);
+extern int SerializeTuple(TupleTableSlot *tuple, SerTupInfo *pSerInfo, struct directTransportBuffer *b, TupleChunkList tcList, int16 targetRoute,
+						  TupleChunkListItem batch, int max_batch_length);
 
 /* Convert a sequence of chunks containing serialized tuple data into a
  * MinimalTuple.
  */
 extern MinimalTuple CvtChunksToTup(TupleChunkList tclist, SerTupInfo *pSerInfo, TupleRemapper *remapper);
 
+/* Get the next MinimalTuple out of a TC_BATCH chunk */
+extern MinimalTuple CvtBatchChunkToTup(TupleChunkListItem tcItem, int *offset);
+
 #endif   /* TUPSER_H */
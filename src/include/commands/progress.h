@@ -33,6 +33,9 @@
 #define PROGRESS_VACUUM_PHASE_INDEX_CLEANUP		4
 #define PROGRESS_VACUUM_PHASE_TRUNCATE			5
 #define PROGRESS_VACUUM_PHASE_FINAL_CLEANUP		6
+#define PROGRESS_VACUUM_PHASE_AO_PRE_CLEANUP	7	/* GPDB */
+#define PROGRESS_VACUUM_PHASE_AO_COMPACT		8	/* GPDB */
+#define PROGRESS_VACUUM_PHASE_AO_POST_CLEANUP	9	/* GPDB */
 
 /* Progress parameters for cluster */
 #define PROGRESS_CLUSTER_COMMAND				0
@@ -63,6 +63,7 @@ extern void TouchSocketFiles(void);
 extern void RemoveSocketFiles(void);
 extern void pq_init(void);
 extern void pq_comm_close_fatal(void);                                  /* GPDB only */
+extern void pq_setsendbuffersize(int size);                            /* GPDB only */
 extern int	pq_getbytes(char *s, size_t len);
 extern int	pq_getstring(StringInfo s);
 extern void pq_startmsgread(void);
@@ -36,6 +36,22 @@ typedef struct DirectDispatchInfo
 	bool		isDirectDispatch;
 	List	   *contentIds;
 
+	/*
+	 * If the distribution key values are parameters, e.g. in the generic
+	 * plan of a prepared statement, the segments can only be computed once
+	 * the values are known, when the executor sets up the slice table (see
+	 * GetContentIdsFromParams()).  Then isDirectDispatch is false, and
+	 * 'paramKeyValues' has one List per distribution key column, of the
+	 * Consts and PARAM_EXTERN Params that the column can be equal to.  An
+	 * array of the column's type, as in "= ANY ($1)", stands for all of its
+	 * elements.  The other fields are the column types, and the hash
+	 * functions and number of segments to hash the values with.
+	 */
+	List	   *paramKeyValues;
+	List	   *paramKeyTypes;
+	List	   *paramKeyHashFuncs;
+	int			paramKeyNumSegments;
+
 	/* only used while planning, in createplan.c */
 	bool		haveProcessedAnyCalculations;
 } DirectDispatchInfo;
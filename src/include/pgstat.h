@@ -932,7 +932,8 @@ typedef enum
 	/* GPDB additions */
 	,
 	WAIT_EVENT_DTX_RECOVERY,
-	WAIT_EVENT_INTERCONNECT
+	WAIT_EVENT_INTERCONNECT,
+	WAIT_EVENT_DISPATCH
 } WaitEventIPC;
 
 /* ----------
@@ -1376,6 +1377,7 @@ extern const char *pgstat_get_backend_desc(BackendType backendType);
 extern void pgstat_progress_start_command(ProgressCommandType cmdtype,
 										  Oid relid);
 extern void pgstat_progress_update_param(int index, int64 val);
+extern void pgstat_progress_incr_param(int index, int64 incr);
 extern void pgstat_progress_update_multi_param(int nparam, const int *index,
 											   const int64 *val);
 extern void pgstat_progress_end_command(void);
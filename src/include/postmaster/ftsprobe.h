@@ -14,6 +14,7 @@
 #ifndef FTSPROBE_H
 #define FTSPROBE_H
 #include "access/xlogdefs.h"
+#include "datatype/timestamp.h"
 
 typedef struct
 {
@@ -78,6 +79,7 @@ typedef struct
 	short poll_revents;
 	int16 fd_index;               /* index into PollFds array */
 	pg_time_t startTime;          /* probe start timestamp */
+	TimestampTz probeStartTime;   /* same, for the probe latency histogram */
 	pg_time_t retryStartTime;     /* time at which next retry attempt can start */
 	int16 probe_errno;            /* saved errno from the latest system call */
 	struct pg_conn *conn;         /* libpq connection object */
@@ -90,7 +92,9 @@ typedef struct
 {
 	int num_pairs; /* number of primary-mirror pairs FTS wants to probe */
 	fts_segment_info *perSegInfos;
+	bool unhealthy; /* a probe of this cycle was retried or failed */
 } fts_context;
 
-extern bool FtsWalRepMessageSegments(CdbComponentDatabases *context);
+extern bool FtsWalRepMessageSegments(CdbComponentDatabases *context,
+									 bool *unhealthy);
 #endif
@@ -74,11 +74,21 @@ extern void ShmemBackendArrayAllocation(void);
 
 extern void load_auxiliary_libraries(void);
 extern bool amAuxiliaryBgWorker(void);
+extern int	NumPMAuxProc(void);
+
+/*
+ * Upper bound of gp_interconnect_proxy_workers.  PMAuxProcList has a slot
+ * for each possible ic-proxy worker, but only the gp_interconnect_proxy_workers
+ * that run are reserved out of max_worker_processes, see NumPMAuxProc().
+ */
+#define IC_PROXY_MAX_WORKERS 4
 
 #ifdef ENABLE_IC_PROXY
-# define IC_PROXY_NUM_BGWORKER 1
+# define IC_PROXY_NUM_BGWORKER IC_PROXY_MAX_WORKERS
+# define IC_PROXY_MIN_BGWORKER 1
 #else  /* ENABLE_IC_PROXY */
 # define IC_PROXY_NUM_BGWORKER 0
+# define IC_PROXY_MIN_BGWORKER 0
 #endif  /* ENABLE_IC_PROXY */
 
 /*
@@ -93,5 +103,7 @@ extern bool amAuxiliaryBgWorker(void);
  */
 #define MAX_BACKENDS	0x3FFFF
 #define MaxPMAuxProc	(4 + IC_PROXY_NUM_BGWORKER)
+/* aux bgworkers reserved with a single ic-proxy worker */
+#define MinPMAuxProc	(4 + IC_PROXY_MIN_BGWORKER)
 
 #endif							/* _POSTMASTER_H */
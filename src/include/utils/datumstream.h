@@ -242,6 +242,32 @@ datumstreamread_nth(DatumStreamRead * acc)
 	}
 }
 
+/*
+ * Advance and get up to maxCount datums of the current block at once.  Returns
+ * the number fetched, 0 when the block is exhausted.  Large objects are handed
+ * out one at a time, since they are reassembled into a single buffer.
+ */
+inline static int
+datumstreamread_get_batch(DatumStreamRead * acc, Datum *values, bool *nulls,
+						  int maxCount)
+{
+	if (acc->largeObjectState == DatumStreamLargeObjectState_None)
+	{
+		/*
+		 * Small objects are handled by the DatumStreamBlockRead module.
+		 */
+		return DatumStreamBlockRead_GetBatch(&acc->blockRead, values, nulls,
+											 maxCount);
+	}
+	else
+	{
+		if (datumstreamread_advancelarge(acc) == 0)
+			return 0;
+		datumstreamread_getlarge(acc, &values[0], &nulls[0]);
+		return 1;
+	}
+}
+
 /* ------------------------------------------------------------------------------ */
 
 extern int datumstreamwrite_put(
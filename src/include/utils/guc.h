@@ -306,6 +306,12 @@ extern bool gp_appendonly_compaction;
  * 10% of the tuples are hidden.
  */
 extern int  gp_appendonly_compaction_threshold;
+/*
+ * Number of helper threads the compressor may use to compress a single
+ * append-optimized block, if it supports that. 0 compresses in the
+ * backend itself.
+ */
+extern int  gp_appendonly_compress_workers;
 extern bool gp_heap_require_relhasoids_match;
 extern bool	debug_xlog_record_read;
 extern bool Debug_cancel_print;
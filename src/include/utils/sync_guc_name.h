@@ -11,6 +11,7 @@
 		"force_parallel_mode",
 		"gin_fuzzy_search_limit",
 		"gin_pending_list_limit",
+		"gp_appendonly_compress_workers",
 		"gp_blockdirectory_entry_min_range",
 		"gp_blockdirectory_minipage_size",
 		"gp_debug_linger",
@@ -24,10 +25,13 @@
 		"gp_ignore_error_table",
 		"gp_indexcheck_insert",
 		"gp_initial_bad_row_limit",
+		"gp_interconnect_compression",
 		"gp_interconnect_debug_retry_interval",
 		"gp_interconnect_default_rtt",
 		"gp_interconnect_fc_method",
+		"gp_interconnect_flush_deadline",
 		"gp_interconnect_full_crc",
+		"gp_interconnect_local_shm",
 		"gp_interconnect_log_stats",
 		"gp_interconnect_min_retries_before_timeout",
 		"gp_interconnect_min_rto",
@@ -39,6 +43,7 @@
 		"gp_interconnect_timer_checking_period",
 		"gp_interconnect_timer_period",
 		"gp_interconnect_transmit_timeout",
+		"gp_interconnect_tuple_batching",
 		"gp_interconnect_type",
 		"gp_log_interconnect",
 		"gp_log_resgroup_memory",
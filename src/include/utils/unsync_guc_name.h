@@ -159,6 +159,7 @@
 		"gp_autostats_mode_in_functions",
 		"gp_autostats_on_change_threshold",
 		"gp_cached_segworkers_threshold",
+		"gp_client_send_buffer_size",
 		"gp_command_count",
 		"gp_connection_send_timeout",
 		"gp_contentid",
@@ -168,6 +169,7 @@
 		"gp_dbid",
 		"gp_debug_pgproc",
 		"gp_debug_resqueue_priority",
+		"gp_dispatch_slice_plans",
 		"gp_distinct_grouping_sets_threshold",
 		"gp_dtx_recovery_interval",
 		"gp_dtx_recovery_prepared_period",
@@ -176,6 +178,7 @@
 		"gp_enable_agg_distinct",
 		"gp_enable_agg_distinct_pruning",
 		"gp_enable_direct_dispatch",
+		"gp_enable_dtx_read_only_vote",
 		"gp_enable_explain_allstat",
 		"gp_enable_fast_sri",
 		"gp_enable_global_deadlock_detector",
@@ -208,6 +211,7 @@
 		"gp_heap_require_relhasoids_match",
 		"gp_instrument_shmem_size",
 		"gp_interconnect_cache_future_packets",
+		"gp_interconnect_proxy_workers",
 		"gp_is_writer",
 		"gp_local_distributed_cache_stats",
 		"gp_log_dynamic_partition_pruning",
@@ -219,8 +223,10 @@
 		"gp_max_local_distributed_cache",
 		"gp_max_plan_size",
 		"gp_motion_cost_per_row",
+		"gp_pipeline_utility_dispatch",
 		"gp_qd_hostname",
 		"gp_qd_port",
+		"gp_qe_pool_size",
 		"gp_recursive_cte",
 		"gp_recursive_cte_prototype",
 		"gp_reject_internal_tcp_connection",
@@ -186,6 +186,8 @@ pqParseInput3(PGconn *conn)
 		{
 			if (pqGetc(&conn->wrote_xlog, conn))
 				return;
+			if (pqGetc(&conn->assigned_xid, conn))
+				return;
 		}
 #endif
 		else if (conn->asyncStatus != PGASYNC_BUSY)
@@ -512,6 +512,7 @@ struct pg_conn
 	PGresult   *next_result;	/* next result (used in single-row mode) */
 
 	char		wrote_xlog;
+	char		assigned_xid;	/* the QE has an xid of its own */
 
 	/* Assorted state for SASL, SSL, GSS, etc */
 	void	   *sasl_state;
@@ -0,0 +1,110 @@
+/*
+ * binary_results.c
+ *
+ * This file tests the binary output of printtup.  Some types are written
+ * straight into the DataRow message, without their send functions, when
+ * the client asks for binary results.  Every column of the query below is
+ * followed by the output of its send function, which comes back as a bytea,
+ * and the two must have the same bytes.
+ *
+ * The table printtup_binary is created by the printtup_binary test.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "libpq-fe.h"
+
+
+static const char *types[] = {
+	"bool", "oid", "date", "float4", "float8", "timestamp", "timestamptz"
+};
+
+#define NTYPES (sizeof(types) / sizeof(types[0]))
+
+static void
+exit_nicely(PGconn *conn)
+{
+	PQfinish(conn);
+	exit(1);
+}
+
+int
+main(int argc, char **argv)
+{
+	const char *conninfo;
+	PGconn	   *conn;
+	PGresult   *res;
+	int			ntuples;
+	int			i;
+	int			j;
+
+	if (argc > 1)
+		conninfo = argv[1];
+	else
+		conninfo = "dbname = postgres";
+
+	/* Make a connection to the database */
+	conn = PQconnectdb(conninfo);
+
+	/* Check to see that the backend connection was successfully made */
+	if (PQstatus(conn) != CONNECTION_OK)
+	{
+		fprintf(stderr, "Connection to database failed: %s",
+				PQerrorMessage(conn));
+		exit_nicely(conn);
+	}
+
+	res = PQexecParams(conn,
+					   "SELECT b, boolsend(b), o, oidsend(o), d, date_send(d), "
+					   "f4, float4send(f4), f8, float8send(f8), "
+					   "ts, timestamp_send(ts), tz, timestamptz_send(tz) "
+					   "FROM printtup_binary ORDER BY id",
+					   0,		/* no params */
+					   NULL,
+					   NULL,
+					   NULL,
+					   NULL,
+					   1);		/* ask for binary results */
+
+	if (PQresultStatus(res) != PGRES_TUPLES_OK)
+	{
+		fprintf(stderr, "SELECT failed: %s", PQerrorMessage(conn));
+		PQclear(res);
+		exit_nicely(conn);
+	}
+
+	ntuples = PQntuples(res);
+
+	for (j = 0; j < NTYPES; j++)
+	{
+		int			col = j * 2;
+		int			nvalues = 0;
+		int			nmismatches = 0;
+
+		for (i = 0; i < ntuples; i++)
+		{
+			if (PQgetisnull(res, i, col) != PQgetisnull(res, i, col + 1))
+			{
+				nmismatches++;
+				continue;
+			}
+			if (PQgetisnull(res, i, col))
+				continue;
+
+			nvalues++;
+			if (PQgetlength(res, i, col) != PQgetlength(res, i, col + 1) ||
+				memcmp(PQgetvalue(res, i, col), PQgetvalue(res, i, col + 1),
+					   PQgetlength(res, i, col)) != 0)
+				nmismatches++;
+		}
+
+		printf("%s: %d values, %d mismatches\n", types[j], nvalues, nmismatches);
+	}
+
+	PQclear(res);
+
+	PQfinish(conn);
+
+	return 0;
+}
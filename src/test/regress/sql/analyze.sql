@@ -448,6 +448,17 @@ create index aocs_analyze_test_idx on aocs_analyze_test (i);
 analyze aocs_analyze_test;
 select relname, reltuples from pg_class where relname like 'aocs_analyze_test%' order by relname;
 
+-- AOCS tables with a block directory sample rows by row number. Check that
+-- deleted rows and dropped columns are accounted for.
+create table aocs_analyze_sample_test (a int4, b int4, c text) with (appendonly=true, orientation=column);
+insert into aocs_analyze_sample_test select g, g, 'c' || g from generate_series(1, 100000) g;
+create index aocs_analyze_sample_test_idx on aocs_analyze_sample_test (a);
+delete from aocs_analyze_sample_test where a % 2 = 0;
+alter table aocs_analyze_sample_test drop column b;
+analyze aocs_analyze_sample_test;
+select reltuples between 45000 and 55000 from pg_class where relname = 'aocs_analyze_sample_test';
+select attname, null_frac from pg_stats where tablename = 'aocs_analyze_sample_test' order by attname;
+
 reset default_statistics_target;
 
 -- Test column name called totalrows
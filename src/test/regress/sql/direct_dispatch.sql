@@ -334,6 +334,34 @@ insert into t_sql_value_function1 values(2, now());
 explain (costs off) insert into t_sql_value_function2 values(now());
 insert into t_sql_value_function2 values(now());
 
+-- direct dispatch computed from the parameters of a generic plan
+set test_print_direct_dispatch_info=off;
+create table dd_param_test (key int, value text) distributed by (key);
+insert into dd_param_test values (1, 'one'), (2, 'two'), (3, 'three');
+set test_print_direct_dispatch_info=on;
+set plan_cache_mode = force_generic_plan;
+
+prepare dd_param_eq(int) as select * from dd_param_test where key = $1;
+execute dd_param_eq(1);
+execute dd_param_eq(null);
+
+prepare dd_param_in(int, int) as select * from dd_param_test where key in ($1, $2) order by key;
+execute dd_param_in(1, 2);
+execute dd_param_in(2, 2);
+
+prepare dd_param_any(int[]) as select * from dd_param_test where key = any($1) order by key;
+execute dd_param_any(array[1, 2]);
+execute dd_param_any(array[]::int[]);
+
+prepare dd_param_update(int) as update dd_param_test set value = value || '!' where key = $1;
+execute dd_param_update(2);
+
+reset plan_cache_mode;
+deallocate dd_param_eq;
+deallocate dd_param_in;
+deallocate dd_param_any;
+deallocate dd_param_update;
+
 -- cleanup
 set test_print_direct_dispatch_info=off;
 
@@ -351,5 +379,6 @@ drop table if exists MPP_22019_b;
 
 drop table if exists t_sql_value_function1;
 drop table if exists t_sql_value_function2;
+drop table if exists dd_param_test;
 
 commit;
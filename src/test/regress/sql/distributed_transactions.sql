@@ -602,3 +602,22 @@ end;
 reset test_print_direct_dispatch_info;
 reset optimizer;
 select count(gp_segment_id) from distxact1_4 group by gp_segment_id; -- sanity check: tuples should be in > 1 segments
+
+-- With read-only votes, the segments that wrote nothing are committed in one
+-- phase, and only the others take part in the two-phase commit.
+set optimizer = off;
+truncate distxact1_4;
+set gp_enable_dtx_read_only_vote = on;
+set test_print_direct_dispatch_info = true;
+insert into distxact1_4 values (2),(1);
+-- only one segment wrote, so it is one-phase commit for all
+insert into distxact1_4 values (1),(1);
+begin;
+savepoint sp1;
+insert into distxact1_4 values (2),(1);
+release sp1;
+end;
+reset test_print_direct_dispatch_info;
+reset gp_enable_dtx_read_only_vote;
+reset optimizer;
+select gp_segment_id, count(*) from distxact1_4 group by gp_segment_id order by 1;
@@ -68,3 +68,28 @@ select count(*) = 12 from dtm_retry_table;
 
 -- Reset all faults.
 select gp_inject_fault_infinite('all', 'reset', dbid) from gp_segment_configuration;
+
+--
+-- READ-ONLY VOTE
+--
+-- A segment that only wrote to an unlogged table has an xid but no WAL.
+-- It must still take part in the two-phase commit, so that its change is
+-- rolled back when another segment fails to prepare.
+create table dtm_vote_logged (a int, b int) distributed by (a);
+create unlogged table dtm_vote_unlogged (a int, b int) distributed by (a);
+insert into dtm_vote_logged select i, 0 from generate_series(1,30) i;
+insert into dtm_vote_unlogged select i, 0 from generate_series(1,30) i;
+set gp_enable_dtx_read_only_vote = on;
+select gp_inject_fault('start_prepare', 'error', dbid)
+from gp_segment_configuration where role = 'p' and status = 'u' and content = 0;
+begin;
+update dtm_vote_unlogged set b = 1 where gp_segment_id = 2;
+update dtm_vote_logged set b = 1 where gp_segment_id = 0;
+end;
+select count(*) from dtm_vote_unlogged where b = 1;
+select count(*) from dtm_vote_logged where b = 1;
+reset gp_enable_dtx_read_only_vote;
+select gp_inject_fault('start_prepare', 'reset', dbid)
+from gp_segment_configuration where role = 'p' and status = 'u' and content = 0;
+drop table dtm_vote_logged;
+drop table dtm_vote_unlogged;
@@ -37,6 +37,13 @@ relation = 'gp_configuration_history'::regclass;
 select count(*) = 2 as in_sync from gp_segment_configuration
 where content = 0 and mode = 's';
 
+-- The failed probes of content 0 primary are counted, as are the successful
+-- ones, whose latencies go to the histogram.
+select count(*) = 2 as outcomes_counted from gp_stat_fts_probe
+where metric = 'outcome' and bucket in ('succeeded', 'failed') and count > 0;
+select sum(count) > 0 as latency_recorded from gp_stat_fts_probe
+where metric = 'latency';
+
 alter system set gp_fts_probe_retries to 0;
 select pg_reload_conf();
 
@@ -51,5 +51,26 @@ explain analyze select count(*) from test_gang_reuse_t1 a
   join test_gang_reuse_t1 b using (c2)
 ;
 
+
+-- the sessions of each database and role account the QEs they take from
+-- their freelists and the gangs they allocate
+select count(*) from test_gang_reuse_t1 a
+  join test_gang_reuse_t1 b using (c2)
+;
+select hits > 0 as hits, misses > 0 as misses, gangs > 0 as gangs,
+  hit_ratio between 0 and 1 as hit_ratio
+  from gp_stat_qe_pool
+  where datname = current_database() and usename = current_user;
+
+-- without room in the pool the idle readers are destroyed after the query
+set gp_qe_pool_size to 0;
+select count(*) from test_gang_reuse_t1 a
+  join test_gang_reuse_t1 b using (c2)
+;
+select evictions > 0 as evictions
+  from gp_stat_qe_pool
+  where datname = current_database() and usename = current_user;
+reset gp_qe_pool_size;
+
 reset optimizer_force_multistage_agg;
 reset optimizer;
@@ -184,3 +184,21 @@ explain (slicetable, costs off) SELECT * FROM explaintest;
 
 -- same in JSON format
 explain (slicetable, costs off, format json) SELECT * FROM explaintest;
+
+--
+-- Test GPDB-specific EXPLAIN (DISPATCH) option. Every gang gets the plan
+-- of its own slice, unless gp_dispatch_slice_plans is off.
+--
+explain (dispatch) SELECT * FROM explaintest;
+
+select regexp_replace(l, '[0-9]+kB', '#kB', 'g') from get_explain_output(
+  '(analyze, dispatch, timing off) SELECT count(*) FROM explaintest a JOIN explaintest b ON a.id = b.id + 1') l
+where l like 'Dispatch%';
+SELECT count(*) FROM explaintest a JOIN explaintest b ON a.id = b.id + 1;
+
+set gp_dispatch_slice_plans = off;
+select regexp_replace(l, '[0-9]+kB', '#kB', 'g') from get_explain_output(
+  '(analyze, dispatch, timing off) SELECT count(*) FROM explaintest a JOIN explaintest b ON a.id = b.id + 1') l
+where l like 'Dispatch%';
+SELECT count(*) FROM explaintest a JOIN explaintest b ON a.id = b.id + 1;
+reset gp_dispatch_slice_plans;
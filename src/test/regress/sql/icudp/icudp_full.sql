@@ -34,6 +34,19 @@ SELECT ROUND(foo.rval * foo.rval)::INT % 30 AS rval2, COUNT(*) AS count, SUM(len
   GROUP BY rval2
   ORDER BY rval2;
 
+-- Delay based flow control must recover from the injected packet loss too
+SET gp_interconnect_fc_method = "delay";
+SELECT ROUND(foo.rval * foo.rval)::INT % 30 AS rval2, COUNT(*) AS count, SUM(length(foo.tval)) AS sum_len_tval
+  FROM (SELECT 5001 AS jkey, rval, tval FROM small_table ORDER BY dkey LIMIT 3000) foo
+    JOIN small_table USING(jkey)
+  GROUP BY rval2
+  ORDER BY rval2;
+RESET gp_interconnect_fc_method;
+
+-- The lost packets show up in the retransmit histogram
+SELECT count(*) > 0 AS has_rtt FROM gp_stat_interconnect_udp WHERE metric = 'rtt' AND count > 0;
+SELECT count(*) > 0 AS has_retransmits FROM gp_stat_interconnect_udp WHERE metric = 'retransmits' AND bucket <> '0' AND count > 0;
+
 drop table if exists csq_t1;
 drop table if exists csq_t2;
 
@@ -0,0 +1,55 @@
+--
+-- Tuples sent through motions compressed, see gp_interconnect_compression.
+--
+-- The setting is rejected by servers built without zstd, so this test is not
+-- in a schedule; the GNUmakefile adds it when configured --with-zstd.
+--
+set gp_interconnect_compression = on;
+
+create table motion_compression (id int, t text) distributed by (id);
+
+-- Small tuples are still sent uncompressed, the large ones compressed, in one
+-- chunk or in many.
+insert into motion_compression values (1, 'foo');
+insert into motion_compression values (2, repeat('1234567890', 1000));
+insert into motion_compression values (3, repeat('1234567890', 100000));
+insert into motion_compression
+  select 4, string_agg(md5(i::text), '' order by i) from generate_series(1, 2000) i;
+
+create table motion_compression_ao with (appendonly=true) as
+  select * from motion_compression distributed by (id);
+
+-- Runs query 'sql', and prints the length and the md5 of the text column.
+-- They are computed here on the coordinator, so that the whole values have
+-- to come through the motion.
+create function motion_compression_result(sql text)
+returns table (id int, len int, hash text) as $$
+declare
+  rec record;
+begin
+  for rec in execute sql
+  loop
+    id = rec.id;
+    len = length(rec.t);
+    hash = md5(rec.t);
+    return next;
+  end loop;
+end;
+$$ language plpgsql;
+
+-- Gather motion.
+select * from motion_compression_result($$
+  select id, t from motion_compression
+$$) order by id;
+
+-- The Seq Scan of an AO table passes MemTuples to the motion.
+select * from motion_compression_result($$
+  select id, t from motion_compression_ao
+$$) order by id;
+
+-- Redistribute motion, on the large column.
+select * from motion_compression_result($$
+  select a.id, b.t from motion_compression a join motion_compression_ao b on a.t = b.t
+$$) order by id;
+
+reset gp_interconnect_compression;
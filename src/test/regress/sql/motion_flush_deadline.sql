@@ -0,0 +1,40 @@
+-- Tuples that a motion sender has buffered go out once they have waited for
+-- gp_interconnect_flush_deadline, even if the sender does not get to send
+-- another tuple. All rows are on one segment. Its sender sends the first row
+-- right away, as the route was quiet, buffers the second and then loops in
+-- the fault injector until the fault is reset. The second FETCH can only get
+-- its row from the deadline flush.
+create table motion_flush_deadline (k int, a int) distributed by (k);
+insert into motion_flush_deadline select 1, i from generate_series(1, 10) i;
+
+set gp_interconnect_flush_deadline = 100;
+-- Only so that a lost row fails the test rather than hang it.
+set statement_timeout = '60s';
+
+select gp_inject_fault('motion_sender_tuple_sent', 'infinite_loop', '', '', '', 2, 2, 0, dbid)
+from gp_segment_configuration where role = 'p' and content > -1;
+begin;
+declare c cursor for select a from motion_flush_deadline;
+fetch 1 from c;
+fetch 1 from c;
+select gp_inject_fault('motion_sender_tuple_sent', 'reset', dbid)
+from gp_segment_configuration where role = 'p' and content > -1;
+close c;
+end;
+
+-- Same with the tuples batched.
+set gp_interconnect_tuple_batching = on;
+select gp_inject_fault('motion_sender_tuple_sent', 'infinite_loop', '', '', '', 2, 2, 0, dbid)
+from gp_segment_configuration where role = 'p' and content > -1;
+begin;
+declare c cursor for select a from motion_flush_deadline;
+fetch 1 from c;
+fetch 1 from c;
+select gp_inject_fault('motion_sender_tuple_sent', 'reset', dbid)
+from gp_segment_configuration where role = 'p' and content > -1;
+close c;
+end;
+reset gp_interconnect_tuple_batching;
+
+reset statement_timeout;
+reset gp_interconnect_flush_deadline;
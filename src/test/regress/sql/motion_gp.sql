@@ -98,3 +98,42 @@ $$) order by id;
 CREATE TABLE motion_noatts ();
 INSERT INTO motion_noatts SELECT;
 SELECT * FROM motion_noatts;
+
+-- Narrow tuples are sent several to a chunk. Check that with and without
+-- batching, including a merging receive where batched and unbatched tuples
+-- from the same sender have to stay in order.
+create table motion_batch (a int, b int, c text) distributed by (a);
+insert into motion_batch
+  select i, i % 7, repeat(case when i % 10 = 0 then 'x' else 'y' end,
+                          case when i % 10 = 0 then 1000 else 1 end)
+  from generate_series(1, 10000) i;
+select b, count(*), sum(a) from motion_batch group by b order by b;
+select a, length(c) from motion_batch where a between 95 and 105 order by a;
+set gp_interconnect_tuple_batching = on;
+select b, count(*), sum(a) from motion_batch group by b order by b;
+select a, length(c) from motion_batch where a between 95 and 105 order by a;
+reset gp_interconnect_tuple_batching;
+
+-- With a flush deadline, routes that see few tuples send them right away and
+-- buffered tuples go out once they wait too long. The results must not change.
+set gp_interconnect_flush_deadline = 1;
+select b, count(*), sum(a) from motion_batch group by b order by b;
+select a, length(c) from motion_batch where a % 1000 = 7 order by a limit 3;
+set gp_interconnect_tuple_batching = on;
+select b, count(*), sum(a) from motion_batch group by b order by b;
+reset gp_interconnect_tuple_batching;
+reset gp_interconnect_flush_deadline;
+
+-- Same-segment routes through shared memory queues. This only changes
+-- anything when gp_interconnect_type is tcp. The redistributes below send
+-- the local share of each segment's rows, large datums included, to itself.
+set gp_interconnect_local_shm = on;
+create table motiondata_shm as select * from motiondata distributed by (extended);
+select * from abbreviate_result($$
+  select id, plain, main, external, extended from motiondata_shm
+$$) order by id;
+select b, count(*), sum(a) from motion_batch group by b order by b;
+set gp_interconnect_tuple_batching = on;
+select b, count(*), sum(a) from motion_batch group by b order by b;
+reset gp_interconnect_tuple_batching;
+reset gp_interconnect_local_shm;
@@ -0,0 +1,25 @@
+--
+-- Binary results of the types that printtup writes straight into the
+-- DataRow message must have the same bytes as their send functions produce.
+-- binary_results compares them, see binary_results.c.
+--
+create table printtup_binary (id int, b bool, o oid, d date, f4 float4,
+  f8 float8, ts timestamp, tz timestamptz) distributed by (id);
+insert into printtup_binary values
+  (1, true, 0, '2000-01-01', 0, 0, '2000-01-01 00:00', '2000-01-01 00:00+00'),
+  (2, false, 4294967295, '1999-12-31', -0.0, -0.0,
+   '1999-12-31 23:59:59.999999', '1999-12-31 23:59:59.999999-08'),
+  (3, null, null, null, null, null, null, null),
+  (4, true, 1259, 'infinity', 'NaN', 'NaN', 'infinity', '-infinity'),
+  (5, false, 12345, '-infinity', 'Infinity', '-Infinity', '-infinity', 'infinity'),
+  (6, true, 42, '4713-01-01 BC', 1e-45, 1e308,
+   '294276-12-31 23:59:59', '1970-01-01 00:00:00.000001+05:30');
+insert into printtup_binary
+  select i, i % 2 = 0, i * 7919, '2000-01-01'::date + i, i / 7.0, i / 7.0,
+         '2000-01-01'::timestamp + i * interval '1 hour 1 second',
+         '2000-01-01 00:00+00'::timestamptz - i * interval '1 day 1 microsecond'
+  from generate_series(7, 1006) i;
+
+\! ./binary_results dbname=regression
+
+drop table printtup_binary;
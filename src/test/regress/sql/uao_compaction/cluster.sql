@@ -0,0 +1,31 @@
+-- Compaction writes the live tuples of a table marked clustered on an
+-- index back in index order.
+CREATE TABLE uao_cluster (a INT, b INT) WITH (appendonly=true) DISTRIBUTED BY (a);
+CREATE INDEX uao_cluster_b ON uao_cluster(b);
+ALTER TABLE uao_cluster CLUSTER ON uao_cluster_b;
+INSERT INTO uao_cluster SELECT i, (i * 7919) % 1000 FROM generate_series(1, 1000) i;
+
+-- Count tuples whose b is smaller than that of the preceding tuple on the
+-- same segment, in physical order.
+CREATE VIEW uao_cluster_disorder AS
+  SELECT count(*) FROM (
+    SELECT b < lag(b) OVER (PARTITION BY gp_segment_id ORDER BY ctid) AS out_of_order
+    FROM uao_cluster) s
+  WHERE out_of_order;
+
+SELECT count > 0 FROM uao_cluster_disorder;
+DELETE FROM uao_cluster WHERE a % 3 = 0;
+VACUUM uao_cluster;
+SELECT count(*) FROM uao_cluster;
+SELECT count FROM uao_cluster_disorder;
+SET enable_seqscan=OFF;
+SELECT count(*) FROM uao_cluster WHERE b < 100;
+RESET enable_seqscan;
+
+-- Without a clustering index, tuples keep their order.
+ALTER TABLE uao_cluster SET WITHOUT CLUSTER;
+INSERT INTO uao_cluster SELECT i, (i * 7919) % 1000 FROM generate_series(1001, 2000) i;
+DELETE FROM uao_cluster WHERE a % 2 = 0;
+VACUUM uao_cluster;
+SELECT count(*) FROM uao_cluster;
+SELECT count > 0 FROM uao_cluster_disorder;